@@ -0,0 +1,189 @@
+#include "audio_pipe.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr auto kConnectPollInterval = std::chrono::milliseconds(10);
+
+// 同じプロセスで複数回録画してもパイプ名が重ならないようにする
+std::atomic<unsigned int> g_pipe_counter{0};
+
+} // namespace
+
+AudioPipe::~AudioPipe() {
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool AudioPipe::Create() {
+    Close();
+    aborted_ = false;
+
+    const std::string name = "\\\\.\\pipe\\midi-video-audio-" + std::to_string(GetCurrentProcessId()) + "-" +
+                             std::to_string(g_pipe_counter++);
+    // PIPE_NOWAIT で作り、ConnectNamedPipe を Abort を確認しながら繰り返す（接続後はブロッキングに戻す）
+    HANDLE handle = CreateNamedPipeA(name.c_str(), PIPE_ACCESS_OUTBOUND, PIPE_TYPE_BYTE | PIPE_NOWAIT, 1,
+                                     1 << 20, 0, 0, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to create audio pipe " << name << " (error " << GetLastError() << ")" << std::endl;
+        return false;
+    }
+    handle_ = handle;
+    path_ = name;
+    return true;
+}
+
+bool AudioPipe::Connect() {
+    if (!handle_) {
+        return false;
+    }
+    while (!ConnectNamedPipe(static_cast<HANDLE>(handle_), nullptr)) {
+        const DWORD error = GetLastError();
+        if (error == ERROR_PIPE_CONNECTED) {
+            break;
+        }
+        if (error != ERROR_PIPE_LISTENING || aborted_) {
+            return false;
+        }
+        std::this_thread::sleep_for(kConnectPollInterval);
+    }
+    DWORD mode = PIPE_READMODE_BYTE | PIPE_WAIT;
+    return SetNamedPipeHandleState(static_cast<HANDLE>(handle_), &mode, nullptr, nullptr) != 0;
+}
+
+bool AudioPipe::Write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        DWORD written = 0;
+        const DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 1u << 30));
+        if (!handle_ || !WriteFile(static_cast<HANDLE>(handle_), bytes, chunk, &written, nullptr)) {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+void AudioPipe::CloseWriter() {
+    if (handle_) {
+        // 読み手が残りを読み終えるまで待ってから閉じる（閉じると未読のデータは捨てられる）
+        FlushFileBuffers(static_cast<HANDLE>(handle_));
+        CloseHandle(static_cast<HANDLE>(handle_));
+        handle_ = nullptr;
+    }
+}
+
+void AudioPipe::Close() {
+    CloseWriter();
+    path_.clear();
+}
+
+#else
+
+bool AudioPipe::Create() {
+    Close();
+    aborted_ = false;
+
+    std::error_code ec;
+    const std::filesystem::path directory = std::filesystem::temp_directory_path(ec);
+    const std::string name = "midi-video-audio-" + std::to_string(getpid()) + "-" + std::to_string(g_pipe_counter++) + ".pcm";
+    const std::string path = ((ec ? std::filesystem::path("/tmp") : directory) / name).string();
+    unlink(path.c_str());
+    if (mkfifo(path.c_str(), 0600) != 0) {
+        std::cerr << "Failed to create audio pipe " << path << " (errno " << errno << ")" << std::endl;
+        return false;
+    }
+    path_ = path;
+    return true;
+}
+
+bool AudioPipe::Connect() {
+    if (path_.empty()) {
+        return false;
+    }
+
+    // 読み手が先に閉じたときに SIGPIPE でプロセスが終わらないよう、このスレッドでは止めておく（write は EPIPE を返す）
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    // 読み手がいない間の O_NONBLOCK での open は ENXIO で失敗するので、Abort を確認しながら繰り返す
+    int fd = -1;
+    while ((fd = open(path_.c_str(), O_WRONLY | O_NONBLOCK)) < 0) {
+        if (errno != ENXIO && errno != EINTR) {
+            std::cerr << "Failed to open audio pipe " << path_ << " (errno " << errno << ")" << std::endl;
+            return false;
+        }
+        if (aborted_) {
+            return false;
+        }
+        std::this_thread::sleep_for(kConnectPollInterval);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    fd_ = fd;
+    return true;
+}
+
+bool AudioPipe::Write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = fd_ >= 0 ? write(fd_, bytes, size) : -1;
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void AudioPipe::CloseWriter() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+void AudioPipe::Close() {
+    CloseWriter();
+    if (!path_.empty()) {
+        unlink(path_.c_str());
+        path_.clear();
+    }
+}
+
+#endif
+
+void AudioPipe::Abort() {
+    aborted_ = true;
+}
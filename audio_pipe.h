@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// FFmpeg の2つ目の入力に音声を流す名前付きパイプ（POSIX は一時ディレクトリの FIFO、Windows は \\.\pipe\）
+// 映像は標準入力のパイプで渡すので、音声は別スレッドからこのパイプに書き込む。
+// FFmpeg が映像と音声を交互に読むため、書き込み側は映像の進み具合に合わせて自然に待たされる。
+class AudioPipe {
+public:
+    AudioPipe() = default;
+    ~AudioPipe();
+
+    AudioPipe(const AudioPipe&) = delete;
+    AudioPipe& operator=(const AudioPipe&) = delete;
+
+    // パイプを作る。FFmpeg には GetPath() を -i で渡す
+    bool Create();
+    const std::string& GetPath() const { return path_; }
+    bool IsCreated() const { return !path_.empty(); }
+
+    // 読み手（FFmpeg）が開くまで待つ（書き込みスレッドから呼ぶ）。Abort されたら false
+    bool Connect();
+    // size バイトをすべて書き込む。読み手が閉じていれば false
+    bool Write(const void* data, size_t size);
+    // 書き込み側を閉じる（読み手には EOF になる）
+    void CloseWriter();
+
+    // Connect の待機を打ち切る（FFmpeg が音声入力を開かずに終了した場合用。別スレッドから呼べる）
+    void Abort();
+    // パイプを削除する（書き込みスレッドが終わってから呼ぶ）
+    void Close();
+
+private:
+    std::string path_;
+    std::atomic<bool> aborted_{false};
+#if defined(_WIN32)
+    void* handle_ = nullptr;   // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
@@ -0,0 +1,216 @@
+#include "background_image_cache.h"
+#include "task_system.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+std::shared_ptr<const DecodedImage> DecodeImageFile(const std::string& path) {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cerr << "Failed to load background image: " << path
+                  << " (" << stbi_failure_reason() << ")" << std::endl;
+        return nullptr;
+    }
+
+    auto image = std::make_shared<DecodedImage>();
+    image->width = width;
+    image->height = height;
+    image->pixels.assign(data, data + static_cast<size_t>(width) * static_cast<size_t>(height) * 4u);
+    stbi_image_free(data);
+    return image;
+}
+
+inline std::uint8_t ToByte(float value) {
+    return static_cast<std::uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+} // namespace
+
+BackgroundImageCache& BackgroundImageCache::Instance() {
+    static BackgroundImageCache instance;
+    return instance;
+}
+
+void BackgroundImageCache::Request(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path.empty() || entries_.count(path)) {
+        return;
+    }
+    Entry entry;
+    auto task = std::make_shared<std::packaged_task<std::shared_ptr<const DecodedImage>()>>(
+        [path]() { return DecodeImageFile(path); });
+    entry.future = task->get_future().share();
+    TaskSystem::Instance().Submit([task]() { (*task)(); });
+    entries_.emplace(path, std::move(entry));
+}
+
+BackgroundImageCache::Entry* BackgroundImageCache::Poll(const std::string& path) {
+    auto it = entries_.find(path);
+    if (it == entries_.end()) {
+        return nullptr;
+    }
+    Entry& entry = it->second;
+    if (!entry.finished &&
+        entry.future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        entry.image = entry.future.get();
+        entry.finished = true;
+    }
+    return &entry;
+}
+
+std::shared_ptr<const DecodedImage> BackgroundImageCache::TryGet(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry* entry = Poll(path);
+    return entry ? entry->image : nullptr;
+}
+
+std::shared_ptr<const DecodedImage> BackgroundImageCache::Wait(const std::string& path) {
+    if (path.empty()) {
+        return nullptr;
+    }
+    Request(path);
+
+    std::shared_future<std::shared_ptr<const DecodedImage>> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        future = entries_.at(path).future;
+    }
+    // Wait outside the lock so other paths can still be polled
+    future.wait();
+    return TryGet(path);
+}
+
+void BackgroundImageCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Pending decodes keep their own packaged_task alive and finish on the task system
+    entries_.clear();
+}
+
+void BackgroundImageCache::ComputePlacement(int image_width, int image_height, int target_width, int target_height,
+                                            BackgroundScaleMode scale_mode, Vec2& position, Vec2& size) {
+    const float iw = static_cast<float>(std::max(1, image_width));
+    const float ih = static_cast<float>(std::max(1, image_height));
+    const float tw = static_cast<float>(target_width);
+    const float th = static_cast<float>(target_height);
+
+    switch (scale_mode) {
+        case BackgroundScaleMode::Stretch:
+            size = Vec2(tw, th);
+            break;
+        case BackgroundScaleMode::Center:
+            size = Vec2(iw, ih);
+            break;
+        case BackgroundScaleMode::Fit: {
+            const float scale = std::min(tw / iw, th / ih);
+            size = Vec2(iw * scale, ih * scale);
+            break;
+        }
+        case BackgroundScaleMode::Fill:
+        default: {
+            const float scale = std::max(tw / iw, th / ih);
+            size = Vec2(iw * scale, ih * scale);
+            break;
+        }
+    }
+    position = Vec2((tw - size.x) * 0.5f, (th - size.y) * 0.5f);
+}
+
+DecodedImage BackgroundImageCache::Compose(const DecodedImage& image, int target_width, int target_height,
+                                           float opacity, BackgroundScaleMode scale_mode) {
+    DecodedImage result;
+    if (target_width <= 0 || target_height <= 0) {
+        return result;
+    }
+    result.width = target_width;
+    result.height = target_height;
+    result.pixels.assign(static_cast<size_t>(target_width) * static_cast<size_t>(target_height) * 4u, 0);
+    for (size_t i = 3; i < result.pixels.size(); i += 4) {
+        result.pixels[i] = 255;
+    }
+    if (!image.IsValid()) {
+        return result;
+    }
+
+    Vec2 position;
+    Vec2 size;
+    ComputePlacement(image.width, image.height, target_width, target_height, scale_mode, position, size);
+
+    const float alpha_scale = std::clamp(opacity, 0.0f, 1.0f) / 255.0f;
+    const float step_x = static_cast<float>(image.width) / size.x;
+    const float step_y = static_cast<float>(image.height) / size.y;
+    // A pixel is covered when its center lies inside the placed rectangle
+    const int x_begin = std::max(0, static_cast<int>(std::ceil(position.x - 0.5f)));
+    const int x_end = std::min(target_width, static_cast<int>(std::ceil(position.x + size.x - 0.5f)));
+    const int y_begin = std::max(0, static_cast<int>(std::ceil(position.y - 0.5f)));
+    const int y_end = std::min(target_height, static_cast<int>(std::ceil(position.y + size.y - 0.5f)));
+
+    for (int y = y_begin; y < y_end; ++y) {
+        const float v = (static_cast<float>(y) + 0.5f - position.y) * step_y - 0.5f;
+        const int y0 = std::clamp(static_cast<int>(std::floor(v)), 0, image.height - 1);
+        const int y1 = std::min(y0 + 1, image.height - 1);
+        const float fy = std::clamp(v - static_cast<float>(y0), 0.0f, 1.0f);
+        const std::uint8_t* row0 = image.pixels.data() + static_cast<size_t>(y0) * image.width * 4u;
+        const std::uint8_t* row1 = image.pixels.data() + static_cast<size_t>(y1) * image.width * 4u;
+        std::uint8_t* out = result.pixels.data() + (static_cast<size_t>(y) * target_width + x_begin) * 4u;
+
+        for (int x = x_begin; x < x_end; ++x, out += 4) {
+            const float u = (static_cast<float>(x) + 0.5f - position.x) * step_x - 0.5f;
+            const int x0 = std::clamp(static_cast<int>(std::floor(u)), 0, image.width - 1);
+            const int x1 = std::min(x0 + 1, image.width - 1);
+            const float fx = std::clamp(u - static_cast<float>(x0), 0.0f, 1.0f);
+
+            float texel[4];
+            for (int c = 0; c < 4; ++c) {
+                const float top = row0[x0 * 4 + c] + (row0[x1 * 4 + c] - row0[x0 * 4 + c]) * fx;
+                const float bottom = row1[x0 * 4 + c] + (row1[x1 * 4 + c] - row1[x0 * 4 + c]) * fx;
+                texel[c] = top + (bottom - top) * fy;
+            }
+            // Composite over black
+            const float alpha = texel[3] * alpha_scale;
+            out[0] = static_cast<std::uint8_t>(texel[0] * alpha + 0.5f);
+            out[1] = static_cast<std::uint8_t>(texel[1] * alpha + 0.5f);
+            out[2] = static_cast<std::uint8_t>(texel[2] * alpha + 0.5f);
+        }
+    }
+    return result;
+}
+
+DecodedImage BackgroundImageCache::RasterizeRadialGradient(int width, int height,
+                                                           const Color& center_color, const Color& edge_color) {
+    DecodedImage result;
+    if (width <= 0 || height <= 0) {
+        return result;
+    }
+    result.width = width;
+    result.height = height;
+    result.pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4u);
+
+    // Same ellipse as the old triangle fan: radius is 70% of each dimension
+    const float center_x = width * 0.5f;
+    const float center_y = height * 0.5f;
+    const float inv_radius_x = 1.0f / (width * 0.7f);
+    const float inv_radius_y = 1.0f / (height * 0.7f);
+
+    std::uint8_t* out = result.pixels.data();
+    for (int y = 0; y < height; ++y) {
+        const float dy = (static_cast<float>(y) + 0.5f - center_y) * inv_radius_y;
+        for (int x = 0; x < width; ++x, out += 4) {
+            const float dx = (static_cast<float>(x) + 0.5f - center_x) * inv_radius_x;
+            const float t = std::min(1.0f, std::sqrt(dx * dx + dy * dy));
+            out[0] = ToByte(center_color.r + (edge_color.r - center_color.r) * t);
+            out[1] = ToByte(center_color.g + (edge_color.g - center_color.g) * t);
+            out[2] = ToByte(center_color.b + (edge_color.b - center_color.b) * t);
+            out[3] = ToByte(center_color.a + (edge_color.a - center_color.a) * t);
+        }
+    }
+    return result;
+}
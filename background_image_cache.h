@@ -0,0 +1,74 @@
+#pragma once
+
+#include "renderer.h"
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// How a background image is fitted to the framebuffer (matches the scale_mode argument of ClearWithImage)
+enum class BackgroundScaleMode : int {
+    Fill = 0,     // Cover the whole framebuffer, cropping the overflowing axis
+    Fit = 1,      // Fit inside the framebuffer, letterboxing the remaining area
+    Stretch = 2,  // Stretch to the framebuffer ignoring the aspect ratio
+    Center = 3    // Draw at native size, centered
+};
+
+// Tightly packed RGBA8 pixels, top row first
+struct DecodedImage {
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> pixels;
+
+    bool IsValid() const { return width > 0 && height > 0 && !pixels.empty(); }
+};
+
+// Decodes background images once on the task system and keeps the result keyed by path.
+// Backends call Request() when a path is first seen and poll TryGet() every frame, so the
+// render thread never blocks on disk I/O or stb decoding.
+class BackgroundImageCache {
+public:
+    // Process-wide cache shared by all backends, so a decode started early (e.g. while the
+    // MIDI file is loading) is reused by whichever renderer draws the background
+    static BackgroundImageCache& Instance();
+
+    // Starts decoding path in the background if it has not been requested yet
+    void Request(const std::string& path);
+
+    // Returns the decoded image once it is ready, nullptr while decoding or if decoding failed
+    std::shared_ptr<const DecodedImage> TryGet(const std::string& path);
+
+    // Blocks until the decode for path has finished; returns the image or nullptr on failure
+    std::shared_ptr<const DecodedImage> Wait(const std::string& path);
+
+    void Clear();
+
+    // Computes the destination rectangle of an image_width x image_height image on the target
+    static void ComputePlacement(int image_width, int image_height, int target_width, int target_height,
+                                 BackgroundScaleMode scale_mode, Vec2& position, Vec2& size);
+
+    // Composites the image over black at target size (bilinear sampling, opacity applied).
+    // Used by backends that upload one framebuffer-sized texture and blit it each frame.
+    static DecodedImage Compose(const DecodedImage& image, int target_width, int target_height,
+                                float opacity, BackgroundScaleMode scale_mode);
+
+    // Rasterizes the elliptical radial gradient used by ClearWithRadialGradient
+    static DecodedImage RasterizeRadialGradient(int width, int height,
+                                                const Color& center_color, const Color& edge_color);
+
+private:
+    struct Entry {
+        std::shared_future<std::shared_ptr<const DecodedImage>> future;
+        std::shared_ptr<const DecodedImage> image;
+        bool finished = false;
+    };
+
+    Entry* Poll(const std::string& path);
+
+    std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
@@ -457,16 +457,19 @@ void DirectX12Renderer::ResetForNewFrame() {
     std::lock_guard<std::mutex> lock(command_mutex_);
     commands_.clear();
     clear_requested_ = false;
+    background_requested_ = false;
 }
 
 void DirectX12Renderer::Clear(const Color& clear_color) {
     clear_color_ = ToFloat4(clear_color);
     clear_requested_ = true;
+    background_requested_ = false;
 }
 
 void DirectX12Renderer::ClearWithRadialGradient(const Color& center_color, const Color& edge_color) {
     clear_color_ = ToFloat4(edge_color);
     clear_requested_ = true;
+    background_requested_ = false;
 
     GPUConstants constants = MakeBaseConstants(Vec2(0.0f, 0.0f),
                                                Vec2(static_cast<float>(framebuffer_width_),
@@ -477,10 +480,26 @@ void DirectX12Renderer::ClearWithRadialGradient(const Color& center_color, const
 }
 
 void DirectX12Renderer::ClearWithImage(const std::string& image_path, float opacity, int scale_mode) {
-    (void)image_path;
-    (void)opacity;
-    (void)scale_mode;
     Clear(Color(0.0f, 0.0f, 0.0f, 1.0f));
+
+    // Stays black until the worker thread has decoded the image
+    BackgroundImageCache& cache = BackgroundImageCache::Instance();
+    cache.Request(image_path);
+    std::shared_ptr<const DecodedImage> decoded = cache.TryGet(image_path);
+    if (!decoded || !offscreen_initialized_) {
+        return;
+    }
+
+    // Compose and upload only when the image, its placement or the framebuffer size changes
+    std::string key = image_path + "|" + std::to_string(opacity) + "|" + std::to_string(scale_mode) + "|" +
+                      std::to_string(framebuffer_width_) + "x" + std::to_string(framebuffer_height_);
+    if (!background_texture_ || background_key_ != key) {
+        UploadBackgroundTexture(BackgroundImageCache::Compose(*decoded, framebuffer_width_, framebuffer_height_,
+                                                              opacity, static_cast<BackgroundScaleMode>(scale_mode)));
+        background_key_ = key;
+    }
+    clear_requested_ = false;
+    background_requested_ = static_cast<bool>(background_texture_);
 }
 
 bool DirectX12Renderer::LoadFont(float font_size) {
@@ -678,6 +697,18 @@ std::vector<std::uint8_t> DirectX12Renderer::ReadFramebufferPBO(int width, int h
     return ReadFramebuffer(width, height);
 }
 
+bool DirectX12Renderer::ReadFramebufferInto(int width, int height, std::uint8_t* destination) {
+    if (width != framebuffer_width_ || height != framebuffer_height_) {
+        return false;
+    }
+
+    return CopyFrame(cpu_buffer_, width, height, destination);
+}
+
+bool DirectX12Renderer::ReadFramebufferPBOInto(int width, int height, std::uint8_t* destination) {
+    return ReadFramebufferInto(width, height, destination);
+}
+
 void DirectX12Renderer::StartAsyncReadback(int width, int height) {
     if (width != framebuffer_width_ || height != framebuffer_height_) {
         async_buffer_.clear();
@@ -748,7 +779,16 @@ void DirectX12Renderer::FlushCommandList() {
     command_list_->RSSetScissorRects(1, &scissor_rect_);
     command_list_->OMSetRenderTargets(1, &rtv_handle_, FALSE, nullptr);
 
-    if (clear_requested_) {
+    if (background_requested_ && background_texture_) {
+        // Copy the cached background instead of clearing
+        command_list_->ResourceBarrier(1, &TransitionBarrier(render_target_.Get(),
+                                                             D3D12_RESOURCE_STATE_RENDER_TARGET,
+                                                             D3D12_RESOURCE_STATE_COPY_DEST));
+        command_list_->CopyResource(render_target_.Get(), background_texture_.Get());
+        command_list_->ResourceBarrier(1, &TransitionBarrier(render_target_.Get(),
+                                                             D3D12_RESOURCE_STATE_COPY_DEST,
+                                                             D3D12_RESOURCE_STATE_RENDER_TARGET));
+    } else if (clear_requested_) {
         command_list_->ClearRenderTargetView(rtv_handle_, clear_color_.data(), 0, nullptr);
     }
 
@@ -797,6 +837,7 @@ void DirectX12Renderer::FlushCommandList() {
     CopyRenderTargetToCpu();
 
     clear_requested_ = false;
+    background_requested_ = false;
 }
 
 void DirectX12Renderer::WaitForGpu() {
@@ -921,6 +962,8 @@ bool DirectX12Renderer::CreateRenderTarget(int width, int height) {
 void DirectX12Renderer::ReleaseRenderTarget() {
     render_target_.Reset();
     readback_buffer_.Reset();
+    background_texture_.Reset();
+    background_key_.clear();
     offscreen_initialized_ = false;
 }
 
@@ -1036,4 +1079,89 @@ void DirectX12Renderer::CreateFontTexture() {
     font_loaded_ = true;
 }
 
+void DirectX12Renderer::UploadBackgroundTexture(const DecodedImage& image) {
+    background_texture_.Reset();
+    if (!image.IsValid()) {
+        return;
+    }
+
+    D3D12_HEAP_PROPERTIES default_heap{};
+    default_heap.Type = D3D12_HEAP_TYPE_DEFAULT;
+
+    // Same format and size as the render target so CopyResource can be used each frame
+    D3D12_RESOURCE_DESC texture_desc{};
+    texture_desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    texture_desc.Width = static_cast<UINT>(image.width);
+    texture_desc.Height = static_cast<UINT>(image.height);
+    texture_desc.DepthOrArraySize = 1;
+    texture_desc.MipLevels = 1;
+    texture_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    texture_desc.SampleDesc.Count = 1;
+    texture_desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    texture_desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+    ThrowIfFailed(device_->CreateCommittedResource(&default_heap, D3D12_HEAP_FLAG_NONE,
+                                                   &texture_desc, D3D12_RESOURCE_STATE_COPY_DEST,
+                                                   nullptr, IID_PPV_ARGS(&background_texture_)),
+                  "Failed to create background texture");
+
+    UINT64 upload_size = 0;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint{};
+    UINT num_rows = 0;
+    UINT64 row_size = 0;
+    device_->GetCopyableFootprints(&texture_desc, 0, 1, 0, &footprint, &num_rows, &row_size, &upload_size);
+
+    D3D12_HEAP_PROPERTIES upload_heap{};
+    upload_heap.Type = D3D12_HEAP_TYPE_UPLOAD;
+
+    D3D12_RESOURCE_DESC upload_desc{};
+    upload_desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    upload_desc.Width = upload_size;
+    upload_desc.Height = 1;
+    upload_desc.DepthOrArraySize = 1;
+    upload_desc.MipLevels = 1;
+    upload_desc.Format = DXGI_FORMAT_UNKNOWN;
+    upload_desc.SampleDesc.Count = 1;
+    upload_desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+    ComPtr<ID3D12Resource> upload_buffer;
+    ThrowIfFailed(device_->CreateCommittedResource(&upload_heap, D3D12_HEAP_FLAG_NONE,
+                                                   &upload_desc, D3D12_RESOURCE_STATE_GENERIC_READ,
+                                                   nullptr, IID_PPV_ARGS(&upload_buffer)),
+                  "Failed to create background upload buffer");
+
+    const size_t source_pitch = static_cast<size_t>(image.width) * 4u;
+    uint8_t* mapped = nullptr;
+    D3D12_RANGE range{0, 0};
+    upload_buffer->Map(0, &range, reinterpret_cast<void**>(&mapped));
+    for (UINT row = 0; row < num_rows; ++row) {
+        std::memcpy(mapped + footprint.Offset + footprint.Footprint.RowPitch * row,
+                    image.pixels.data() + row * source_pitch, source_pitch);
+    }
+    upload_buffer->Unmap(0, nullptr);
+
+    command_allocator_->Reset();
+    command_list_->Reset(command_allocator_.Get(), nullptr);
+
+    D3D12_TEXTURE_COPY_LOCATION dst{};
+    dst.pResource = background_texture_.Get();
+    dst.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dst.SubresourceIndex = 0;
+
+    D3D12_TEXTURE_COPY_LOCATION src{};
+    src.pResource = upload_buffer.Get();
+    src.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    src.PlacedFootprint = footprint;
+
+    command_list_->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+    command_list_->ResourceBarrier(1, &TransitionBarrier(background_texture_.Get(),
+                                                         D3D12_RESOURCE_STATE_COPY_DEST,
+                                                         D3D12_RESOURCE_STATE_COPY_SOURCE));
+    command_list_->Close();
+
+    ID3D12CommandList* lists[] = {command_list_.Get()};
+    command_queue_->ExecuteCommandLists(1, lists);
+    WaitForGpu();
+}
+
 #endif // _WIN32
@@ -4,6 +4,7 @@
 
 #include "renderer.h"
 #include "simple_bitmap_font.h"
+#include "background_image_cache.h"
 
 #include <d3d12.h>
 #include <dxgi1_6.h>
@@ -67,6 +68,8 @@ public:
 
     std::vector<std::uint8_t> ReadFramebuffer(int width, int height) override;
     std::vector<std::uint8_t> ReadFramebufferPBO(int width, int height) override;
+    bool ReadFramebufferInto(int width, int height, std::uint8_t* destination) override;
+    bool ReadFramebufferPBOInto(int width, int height, std::uint8_t* destination) override;
     void StartAsyncReadback(int width, int height) override;
     std::vector<std::uint8_t> GetAsyncReadbackResult(int width, int height) override;
 
@@ -125,6 +128,7 @@ private:
     void WaitForGpu();
     void CopyRenderTargetToCpu();
     void CreateFontTexture();
+    void UploadBackgroundTexture(const DecodedImage& image);
     void PopulateShapeCommand(CommandType type, const GPUConstants& constants);
     void PopulateTextCommand(const GPUConstants& constants);
     GPUConstants MakeBaseConstants(const Vec2& position, const Vec2& size) const;
@@ -145,6 +149,7 @@ private:
     Microsoft::WRL::ComPtr<ID3D12Resource> render_target_;
     Microsoft::WRL::ComPtr<ID3D12Resource> readback_buffer_;
     Microsoft::WRL::ComPtr<ID3D12Resource> font_texture_;
+    Microsoft::WRL::ComPtr<ID3D12Resource> background_texture_;  // Composed at framebuffer size, kept in COPY_SOURCE
 
     int font_texture_width_ = 0;
     int font_texture_height_ = 0;
@@ -169,6 +174,7 @@ private:
     bool frame_bound_ = false;
     bool font_loaded_ = false;
     bool clear_requested_ = false;
+    bool background_requested_ = false;
     float font_scale_ = 1.0f;
 
     std::array<float, 4> clear_color_{};
@@ -176,6 +182,8 @@ private:
     std::vector<std::uint8_t> async_buffer_;
     std::vector<DrawCommand> commands_;
 
+    std::string background_key_;
+
     unsigned int draw_call_count_ = 0;
     std::mutex command_mutex_;
 };
@@ -0,0 +1,313 @@
+#include "distributed_render.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#define GET_PROCESS_ID _getpid
+#else
+#include <unistd.h>
+#define GET_PROCESS_ID getpid
+#endif
+
+namespace {
+
+constexpr const char* kManifestFormat = "spp-distributed-render 1";
+
+} // namespace
+
+int RenderManifest::GetSegmentCount() const {
+    if (total_frames <= start_frame || segment_frames <= 0) {
+        return 0;
+    }
+    return (total_frames - start_frame + segment_frames - 1) / segment_frames;
+}
+
+int RenderManifest::GetSegmentStartFrame(int segment) const {
+    return start_frame + segment * segment_frames;
+}
+
+int RenderManifest::GetSegmentEndFrame(int segment) const {
+    return std::min(total_frames, start_frame + (segment + 1) * segment_frames);
+}
+
+bool RenderManifest::IsCompatibleWith(const RenderManifest& other) const {
+    return width == other.width && height == other.height && fps == other.fps &&
+           video_codec == other.video_codec && start_frame == other.start_frame &&
+           total_frames == other.total_frames && segment_frames == other.segment_frames;
+}
+
+DistributedRenderJob::DistributedRenderJob(std::filesystem::path root)
+    : root_(std::move(root)) {
+    // 担当がタイムアウトで他のワーカーに移った後も、元のワーカーの出力やロックと混ざらないようにする
+    std::random_device random;
+    std::ostringstream token;
+    token << GET_PROCESS_ID() << "-" << std::hex << random();
+    token_ = token.str();
+}
+
+bool DistributedRenderJob::WriteManifest(const RenderManifest& manifest) {
+    std::error_code ec;
+    std::filesystem::create_directories(GetSegmentDirectory(), ec);
+    if (ec) {
+        std::cerr << "Failed to create " << GetSegmentDirectory().string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // 書きかけをワーカーに読まれないよう、一時ファイルに書いてからリネームする
+    const std::filesystem::path manifest_path = root_ / "manifest.txt";
+    const std::filesystem::path temp_path = root_ / "manifest.txt.tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Failed to write " << temp_path.string() << std::endl;
+            return false;
+        }
+        out << "format=" << kManifestFormat << "\n";
+        out << "width=" << manifest.width << "\n";
+        out << "height=" << manifest.height << "\n";
+        out << "fps=" << manifest.fps << "\n";
+        out << "video_codec=" << manifest.video_codec << "\n";
+        out << "start_frame=" << manifest.start_frame << "\n";
+        out << "total_frames=" << manifest.total_frames << "\n";
+        out << "segment_frames=" << manifest.segment_frames << "\n";
+    }
+    std::filesystem::rename(temp_path, manifest_path, ec);
+    if (ec) {
+        std::cerr << "Failed to publish " << manifest_path.string() << ": " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool DistributedRenderJob::ReadManifest(RenderManifest& manifest) const {
+    std::ifstream in(root_ / "manifest.txt");
+    if (!in) {
+        return false;
+    }
+
+    RenderManifest parsed;
+    bool format_ok = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        const size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        const std::string key = line.substr(0, separator);
+        const std::string value = line.substr(separator + 1);
+        try {
+            if (key == "format") {
+                format_ok = (value == kManifestFormat);
+            } else if (key == "width") {
+                parsed.width = std::stoi(value);
+            } else if (key == "height") {
+                parsed.height = std::stoi(value);
+            } else if (key == "fps") {
+                parsed.fps = std::stoi(value);
+            } else if (key == "video_codec") {
+                parsed.video_codec = value;
+            } else if (key == "start_frame") {
+                parsed.start_frame = std::stoi(value);
+            } else if (key == "total_frames") {
+                parsed.total_frames = std::stoi(value);
+            } else if (key == "segment_frames") {
+                parsed.segment_frames = std::stoi(value);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid manifest entry: " << line << std::endl;
+            return false;
+        }
+    }
+
+    if (!format_ok || parsed.GetSegmentCount() == 0) {
+        std::cerr << "Unsupported or incomplete manifest in " << root_.string() << std::endl;
+        return false;
+    }
+    manifest = parsed;
+    return true;
+}
+
+int DistributedRenderJob::ClaimNextSegment(const RenderManifest& manifest) {
+    std::error_code ec;
+    std::filesystem::create_directories(GetSegmentDirectory(), ec);
+
+    const int segment_count = manifest.GetSegmentCount();
+    for (int segment = 0; segment < segment_count; ++segment) {
+        if (IsSegmentPublished(segment) || std::filesystem::exists(GetLockPath(segment), ec)) {
+            continue;
+        }
+
+        // "x" は排他作成（O_EXCL）。同時に作ろうとしたワーカーのうち1つだけが成功する
+        const std::string lock_path = GetLockPath(segment).string();
+        FILE* lock = std::fopen(lock_path.c_str(), "wx");
+        if (!lock) {
+            continue;
+        }
+        std::fprintf(lock, "%s\n", token_.c_str());
+        std::fclose(lock);
+
+        // 確認してから作成するまでの間に別のワーカーが公開し終えていた場合
+        if (IsSegmentPublished(segment)) {
+            RemoveClaimIfOwned(segment);
+            continue;
+        }
+        return segment;
+    }
+    return -1;
+}
+
+void DistributedRenderJob::RefreshClaim(int segment) {
+    std::error_code ec;
+    std::filesystem::last_write_time(GetLockPath(segment), std::filesystem::file_time_type::clock::now(), ec);
+}
+
+bool DistributedRenderJob::PublishSegment(int segment) {
+    std::error_code ec;
+    std::filesystem::rename(GetPartialOutputPath(segment) + ".mp4", GetSegmentPath(segment), ec);
+    if (ec) {
+        std::cerr << "Failed to publish segment " << segment << ": " << ec.message() << std::endl;
+        AbandonSegment(segment);
+        return false;
+    }
+    RemoveClaimIfOwned(segment);
+    return true;
+}
+
+void DistributedRenderJob::AbandonSegment(int segment) {
+    std::error_code ec;
+    std::filesystem::remove(GetPartialOutputPath(segment) + ".mp4", ec);
+    RemoveClaimIfOwned(segment);
+}
+
+bool DistributedRenderJob::IsSegmentPublished(int segment) const {
+    std::error_code ec;
+    return std::filesystem::exists(GetSegmentPath(segment), ec);
+}
+
+int DistributedRenderJob::CountPublishedSegments(const RenderManifest& manifest) const {
+    int published = 0;
+    const int segment_count = manifest.GetSegmentCount();
+    for (int segment = 0; segment < segment_count; ++segment) {
+        if (IsSegmentPublished(segment)) {
+            published++;
+        }
+    }
+    return published;
+}
+
+int DistributedRenderJob::ReleaseStaleClaims(const RenderManifest& manifest, double timeout_seconds) {
+    // 更新時刻は各ノードの時計で書かれるので、ノード間の時計のずれよりタイムアウトを十分長くする
+    const auto now = std::filesystem::file_time_type::clock::now();
+    int released = 0;
+    const int segment_count = manifest.GetSegmentCount();
+    for (int segment = 0; segment < segment_count; ++segment) {
+        std::error_code ec;
+        const auto last_write = std::filesystem::last_write_time(GetLockPath(segment), ec);
+        if (ec) {
+            continue;
+        }
+        const double age = std::chrono::duration<double>(now - last_write).count();
+        if (age >= timeout_seconds && !IsSegmentPublished(segment)) {
+            std::cout << "Segment " << segment << " has not been updated for " << static_cast<int>(age)
+                      << " s, returning it to the queue" << std::endl;
+            std::filesystem::remove(GetClaimOutputPath(segment, ReadClaimToken(segment)) + ".mp4", ec);
+            std::filesystem::remove(GetLockPath(segment), ec);
+            released++;
+        }
+    }
+    return released;
+}
+
+
+std::filesystem::path DistributedRenderJob::GetSegmentPath(int segment) const {
+    return GetSegmentDirectory() / (GetSegmentName(segment) + ".mp4");
+}
+
+bool DistributedRenderJob::Concatenate(const RenderManifest& manifest, const std::string& ffmpeg_path,
+                                       const std::string& output_file, const std::string& audio_path,
+                                       double audio_start_seconds, int audio_bitrate) const {
+    // concat デマルチプレクサのリスト（相対パスはリストファイルの場所から解決される）
+    const std::filesystem::path list_path = root_ / "segments.txt";
+    {
+        std::ofstream list(list_path, std::ios::trunc);
+        if (!list) {
+            std::cerr << "Failed to write " << list_path.string() << std::endl;
+            return false;
+        }
+        const int segment_count = manifest.GetSegmentCount();
+        for (int segment = 0; segment < segment_count; ++segment) {
+            list << "file 'segments/" << GetSegmentName(segment) << ".mp4'\n";
+        }
+    }
+
+    const std::string ffmpeg_cmd = ffmpeg_path.empty() ? "ffmpeg" : ffmpeg_path;
+    std::stringstream cmd;
+    cmd << ffmpeg_cmd << " -y";
+    cmd << " -f concat -safe 0 -i \"" << list_path.string() << "\"";
+    if (!audio_path.empty()) {
+        if (audio_start_seconds > 0.0) {
+            cmd << " -ss " << audio_start_seconds;
+        }
+        cmd << " -i \"" << audio_path << "\"";
+        cmd << " -map 0:v -map 1:a";
+    }
+    cmd << " -c:v copy"; // セグメントは同じ設定でエンコード済みなので再エンコードしない
+    if (!audio_path.empty()) {
+        cmd << " -c:a aac -b:a " << std::max(1, audio_bitrate / 1000) << "k -shortest";
+    }
+    cmd << " \"" << output_file << "\"";
+
+    const std::string command = cmd.str();
+    std::cout << "Joining segments with command: " << command << std::endl;
+    const int result = std::system(command.c_str());
+    if (result != 0) {
+        std::cerr << "FFmpeg failed to join the segments (exit code: " << result << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::filesystem::path DistributedRenderJob::GetSegmentDirectory() const {
+    return root_ / "segments";
+}
+
+std::filesystem::path DistributedRenderJob::GetLockPath(int segment) const {
+    return GetSegmentDirectory() / (GetSegmentName(segment) + ".lock");
+}
+
+std::string DistributedRenderJob::GetClaimOutputPath(int segment, const std::string& token) const {
+    return (GetSegmentDirectory() / (GetSegmentName(segment) + "." + token + ".partial")).string();
+}
+
+std::string DistributedRenderJob::ReadClaimToken(int segment) const {
+    std::ifstream lock(GetLockPath(segment));
+    std::string token;
+    std::getline(lock, token);
+    return token;
+}
+
+void DistributedRenderJob::RemoveClaimIfOwned(int segment) {
+    // タイムアウトで担当が移っていれば、新しい担当者のロックは残す
+    if (ReadClaimToken(segment) == token_) {
+        std::error_code ec;
+        std::filesystem::remove(GetLockPath(segment), ec);
+    }
+}
+
+std::string DistributedRenderJob::GetSegmentName(int segment) const {
+    std::ostringstream name;
+    name << "segment_" << std::setw(5) << std::setfill('0') << segment;
+    return name.str();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// 共有ディレクトリを使った分散レンダリング（--coordinator / --worker）
+//
+//   <root>/manifest.txt                     コーディネーターが書くジョブ定義（セグメント分割と検証用の設定）
+//   <root>/segments/segment_NNNNN.lock      ワーカーが排他作成して担当を宣言する（中身は担当者のトークン。
+//                                           レンダリング中は更新時刻を更新し続ける）
+//   <root>/segments/segment_NNNNN.<token>.partial.mp4  レンダリング中の出力（担当者ごとに別名）
+//   <root>/segments/segment_NNNNN.mp4       完成したセグメント（partial からのリネームで公開）
+//
+// 排他作成（O_EXCL）とリネームしか使わないので、NFS / SMB などの共有ファイルシステムで動き、
+// 1台で複数のワーカープロセスを起動しても試せる。
+struct RenderManifest {
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    std::string video_codec;
+    int start_frame = 0;      // 出力する範囲 [start_frame, total_frames)（--start / --end）
+    int total_frames = 0;     // フレーム番号は全体をレンダリングした場合の動画内の番号
+    int segment_frames = 0;   // 1セグメントのフレーム数（最後のセグメントは短くなる）
+
+    int GetSegmentCount() const;
+    int GetSegmentStartFrame(int segment) const;
+    int GetSegmentEndFrame(int segment) const;  // 終端（含まない）
+
+    // 各ノードで計算した設定がコーディネーターと一致するか（セグメント境界と連結可否がこれで決まる）
+    bool IsCompatibleWith(const RenderManifest& other) const;
+};
+
+class DistributedRenderJob {
+public:
+    explicit DistributedRenderJob(std::filesystem::path root);
+
+    const std::filesystem::path& GetRoot() const { return root_; }
+
+    bool WriteManifest(const RenderManifest& manifest);
+    bool ReadManifest(RenderManifest& manifest) const;
+
+    // 未完成で誰も担当していないセグメントを1つ確保する（なければ -1）
+    int ClaimNextSegment(const RenderManifest& manifest);
+    // 担当が生きていることを示す（ロックファイルの更新時刻を進める）
+    void RefreshClaim(int segment);
+    // partial を完成品としてリネームし、担当を外す
+    bool PublishSegment(int segment);
+    // 失敗時: partial と担当を消して他のワーカーに回す
+    void AbandonSegment(int segment);
+
+    bool IsSegmentPublished(int segment) const;
+    int CountPublishedSegments(const RenderManifest& manifest) const;
+    // timeout_seconds 以上更新のない担当を外す（ワーカーの異常終了対策、コーディネーターが呼ぶ）
+    int ReleaseStaleClaims(const RenderManifest& manifest, double timeout_seconds);
+
+    // VideoOutputSettings::output_path に渡すパス（".mp4" は MidiVideoOutput が付ける）
+    std::string GetPartialOutputPath(int segment) const { return GetClaimOutputPath(segment, token_); }
+    std::filesystem::path GetSegmentPath(int segment) const;
+
+    // 全セグメントを再エンコードなしで連結し、audio_path があれば音声を多重化する
+    // （音声は audio_start_seconds の位置から使う。範囲の先頭から生成した音声なら0）
+    bool Concatenate(const RenderManifest& manifest, const std::string& ffmpeg_path,
+                     const std::string& output_file, const std::string& audio_path,
+                     double audio_start_seconds, int audio_bitrate) const;
+
+private:
+    std::filesystem::path GetSegmentDirectory() const;
+    std::filesystem::path GetLockPath(int segment) const;
+    std::string GetSegmentName(int segment) const;
+    std::string GetClaimOutputPath(int segment, const std::string& token) const;
+    std::string ReadClaimToken(int segment) const;
+    void RemoveClaimIfOwned(int segment);
+
+    std::filesystem::path root_;
+    std::string token_;  // このプロセスの担当を示すトークン（プロセスID + 乱数）
+};
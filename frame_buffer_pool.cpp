@@ -0,0 +1,171 @@
+#include "frame_buffer_pool.h"
+
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+size_t RoundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+FrameBuffer::~FrameBuffer() {
+    Free();
+}
+
+bool FrameBuffer::Allocate(size_t size, bool use_huge_pages) {
+    Free();
+    if (size == 0) {
+        return false;
+    }
+
+#if defined(_WIN32)
+    // ラージページは SeLockMemoryPrivilege が必要なので、使えなければ通常ページに戻す
+    const size_t large_page = GetLargePageMinimum();
+    if (use_huge_pages && large_page > 0) {
+        const size_t rounded = RoundUp(size, large_page);
+        void* memory = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (memory) {
+            mapping_ = memory;
+            mapping_size_ = rounded;
+            backing_ = Backing::HugePages;
+        }
+    }
+    if (!mapping_) {
+        void* memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (!memory) {
+            return false;
+        }
+        mapping_ = memory;
+        mapping_size_ = size;
+        backing_ = Backing::Regular;
+    }
+    data_ = static_cast<uint8_t*>(mapping_);
+#else
+#if defined(MAP_HUGETLB)
+    // 予約済みのラージページ（vm.nr_hugepages）があればそれを使う
+    if (use_huge_pages) {
+        const size_t rounded = RoundUp(size, kHugePageSize);
+        void* memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            mapping_ = memory;
+            mapping_size_ = rounded;
+            data_ = static_cast<uint8_t*>(memory);
+            backing_ = Backing::HugePages;
+        }
+    }
+#endif
+    if (!mapping_) {
+        // 2MB 境界に揃えるため余分に確保し、先頭を揃えた位置から使う
+        const size_t mapped = use_huge_pages ? RoundUp(size, kHugePageSize) + kHugePageSize : size;
+        void* memory = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            return false;
+        }
+        mapping_ = memory;
+        mapping_size_ = mapped;
+        const uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+        data_ = reinterpret_cast<uint8_t*>(RoundUp(address, use_huge_pages ? kHugePageSize : 1));
+        backing_ = Backing::Regular;
+#if defined(MADV_HUGEPAGE)
+        if (use_huge_pages && madvise(data_, RoundUp(size, kHugePageSize), MADV_HUGEPAGE) == 0) {
+            backing_ = Backing::TransparentHugePages;
+        }
+#endif
+    }
+#endif
+
+    size_ = size;
+    // 全ページを先に確定させ、録画中にページフォルトが起きないようにする
+    std::memset(data_, 0, size_);
+    return true;
+}
+
+void FrameBuffer::Free() {
+    if (!mapping_) {
+        return;
+    }
+#if defined(_WIN32)
+    VirtualFree(mapping_, 0, MEM_RELEASE);
+#else
+    munmap(mapping_, mapping_size_);
+#endif
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+    backing_ = Backing::None;
+}
+
+bool FrameBufferPool::Initialize(size_t frame_size, size_t frame_count, bool use_huge_pages) {
+    Clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_size_ = frame_size;
+    for (size_t i = 0; i < frame_count; ++i) {
+        auto buffer = std::make_unique<FrameBuffer>();
+        if (!buffer->Allocate(frame_size, use_huge_pages)) {
+            std::cerr << "Failed to allocate frame buffer " << i << " (" << frame_size << " bytes)" << std::endl;
+            break;
+        }
+        free_buffers_.push_back(buffer.get());
+        buffers_.push_back(std::move(buffer));
+    }
+    return !buffers_.empty();
+}
+
+void FrameBufferPool::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_buffers_.clear();
+    buffers_.clear();
+    frame_size_ = 0;
+}
+
+FrameBuffer* FrameBufferPool::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_buffers_.empty()) {
+        return nullptr;
+    }
+    FrameBuffer* buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+    return buffer;
+}
+
+void FrameBufferPool::Release(FrameBuffer* buffer) {
+    if (!buffer) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_buffers_.push_back(buffer);
+}
+
+const char* FrameBufferPool::DescribeBacking() const {
+    if (buffers_.empty()) {
+        return "none";
+    }
+    switch (buffers_.front()->GetBacking()) {
+        case FrameBuffer::Backing::HugePages:
+            return "huge pages";
+        case FrameBuffer::Backing::TransparentHugePages:
+            return "transparent huge pages";
+        case FrameBuffer::Backing::Regular:
+            return "regular pages";
+        default:
+            return "none";
+    }
+}
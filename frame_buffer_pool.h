@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// 録画用のフレームバッファ（リードバック → FFmpeg パイプ書き込みで使い回す）
+// 4K RGBA で 1 枚 33MB になるので、ラージページで確保して起動時にページを確定させておく。
+// 毎フレームの確保・解放とページフォルト、memcpy 中の TLB ミスを減らすのが目的。
+class FrameBuffer {
+public:
+    enum class Backing {
+        None,
+        HugePages,             // 予約済みのラージページ（MAP_HUGETLB / MEM_LARGE_PAGES）
+        TransparentHugePages,  // 通常ページ + madvise(MADV_HUGEPAGE)
+        Regular
+    };
+
+    FrameBuffer() = default;
+    ~FrameBuffer();
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    // size バイトを確保して全ページに書き込んでおく。use_huge_pages = false なら通常ページ。
+    bool Allocate(size_t size, bool use_huge_pages);
+    void Free();
+
+    uint8_t* GetData() const { return data_; }
+    size_t GetSize() const { return size_; }
+    Backing GetBacking() const { return backing_; }
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    void* mapping_ = nullptr;     // 解放に使う元の確保先（アライメント調整前）
+    size_t mapping_size_ = 0;
+    Backing backing_ = Backing::None;
+};
+
+// 同じサイズのフレームバッファを事前に確保しておくプール
+class FrameBufferPool {
+public:
+    // frame_count 枚を確保する。1 枚も確保できなければ false。
+    bool Initialize(size_t frame_size, size_t frame_count, bool use_huge_pages);
+    void Clear();
+
+    // 空きがなければ nullptr
+    FrameBuffer* Acquire();
+    void Release(FrameBuffer* buffer);
+
+    size_t GetFrameSize() const { return frame_size_; }
+    bool IsInitialized() const { return !buffers_.empty(); }
+    // ログ表示用（先頭のバッファの確保方法）
+    const char* DescribeBacking() const;
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<FrameBuffer>> buffers_;
+    std::vector<FrameBuffer*> free_buffers_;
+    size_t frame_size_ = 0;
+};
@@ -17,13 +17,17 @@
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <deque>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <sstream>
@@ -53,6 +57,7 @@
 #endif
 
 #include "../resources/window_icon_loader.h"
+#include "midi_analysis.h"
 
 namespace {
 
@@ -111,6 +116,7 @@ static void SetWindowIcon(GLFWwindow* window) {
 
 enum class JobStatus {
     Idle,
+    Queued,
     Running,
     Completed,
     Failed
@@ -145,8 +151,120 @@ struct RenderOptions {
 
 constexpr std::size_t kPathBufferSize = 1024;
 constexpr std::size_t kMaxLogLines = 2000;
+constexpr std::size_t kLogChunkSize = 64 * 1024;
 constexpr std::size_t kCommandBufferSize = 2048;
 
+// Fixed-capacity ring of log lines. Line text lives in an append-only arena of fixed-size
+// chunks; a chunk is recycled once every line pointing into it has been evicted, so
+// appending never reallocates or moves existing lines. Not synchronized: ProcessRunner
+// guards it with its log mutex. generation() may be read without the lock and changes
+// whenever lines are added or cleared.
+class LogBuffer {
+public:
+    LogBuffer() : lines_(kMaxLogLines) {}
+
+    void append(const char* text, std::size_t length) {
+        length = std::min(length, kLogChunkSize);
+        if (count_ == lines_.size()) {
+            evict_oldest();
+        }
+
+        if (chunks_.empty() || kLogChunkSize - chunks_.back().used < length) {
+            add_chunk();
+        }
+        LogChunk& chunk = chunks_.back();
+        char* destination = chunk.data.get() + chunk.used;
+        if (length > 0) {
+            std::memcpy(destination, text, length);
+        }
+        chunk.used += length;
+        ++chunk.live_lines;
+
+        LogLine& line = lines_[(head_ + count_) % lines_.size()];
+        line.text = destination;
+        line.length = length;
+        line.chunk_serial = first_chunk_serial_ + chunks_.size() - 1;
+        ++count_;
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    void clear() {
+        while (!chunks_.empty()) {
+            recycle_front_chunk();
+        }
+        head_ = 0;
+        count_ = 0;
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    std::size_t size() const {
+        return count_;
+    }
+
+    std::uint64_t generation() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    // Calls fn(text, length) for lines [first, last), oldest line first
+    template <typename Fn>
+    void visit(std::size_t first, std::size_t last, Fn&& fn) const {
+        last = std::min(last, count_);
+        for (std::size_t i = first; i < last; ++i) {
+            const LogLine& line = lines_[(head_ + i) % lines_.size()];
+            fn(line.text, line.length);
+        }
+    }
+
+private:
+    struct LogLine {
+        const char* text = nullptr;
+        std::size_t length = 0;
+        std::uint64_t chunk_serial = 0;
+    };
+
+    struct LogChunk {
+        std::unique_ptr<char[]> data;
+        std::size_t used = 0;
+        std::size_t live_lines = 0;
+    };
+
+    void add_chunk() {
+        LogChunk chunk;
+        if (!free_chunks_.empty()) {
+            chunk.data = std::move(free_chunks_.back());
+            free_chunks_.pop_back();
+        } else {
+            chunk.data = std::make_unique<char[]>(kLogChunkSize);
+        }
+        chunks_.push_back(std::move(chunk));
+    }
+
+    void recycle_front_chunk() {
+        free_chunks_.push_back(std::move(chunks_.front().data));
+        chunks_.pop_front();
+        ++first_chunk_serial_;
+    }
+
+    void evict_oldest() {
+        const LogLine& line = lines_[head_];
+        --chunks_[line.chunk_serial - first_chunk_serial_].live_lines;
+        head_ = (head_ + 1) % lines_.size();
+        --count_;
+        // Keep the chunk currently being written even when it is empty
+        while (chunks_.size() > 1 && chunks_.front().live_lines == 0) {
+            recycle_front_chunk();
+        }
+    }
+
+    std::vector<LogLine> lines_;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::deque<LogChunk> chunks_;
+    std::vector<std::unique_ptr<char[]>> free_chunks_;
+    std::uint64_t first_chunk_serial_ = 0;
+    std::atomic<std::uint64_t> generation_{0};
+};
+
 class ProcessRunner {
 public:
     ProcessRunner() = default;
@@ -194,23 +312,28 @@ public:
         return std::chrono::steady_clock::now() - start_time_;
     }
 
-    std::vector<std::string> log_snapshot() {
+    // Changes whenever log lines are added or cleared; cheap to poll every UI frame
+    std::uint64_t log_generation() const {
+        return logs_.generation();
+    }
+
+    std::size_t log_line_count() {
         std::lock_guard<std::mutex> lock(mutex_);
-        return logs_;
+        return logs_.size();
     }
 
-    bool consume_scroll_request() {
-        return scroll_to_bottom_.exchange(false);
+    // Calls fn(text, length) for log lines [first, last) while holding the log lock.
+    // The text is only valid during the call.
+    template <typename Fn>
+    void visit_log_lines(std::size_t first, std::size_t last, Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        logs_.visit(first, last, std::forward<Fn>(fn));
     }
 
     void append_line(const std::string& line) {
         std::lock_guard<std::mutex> lock(mutex_);
         if (!line.empty()) {
-            logs_.push_back(line);
-            if (logs_.size() > kMaxLogLines) {
-                logs_.erase(logs_.begin(), logs_.begin() + (logs_.size() - kMaxLogLines));
-            }
-            scroll_to_bottom_ = true;
+            logs_.append(line.data(), line.size());
         }
     }
 
@@ -227,7 +350,6 @@ private:
         std::lock_guard<std::mutex> lock(mutex_);
         logs_.clear();
         partial_line_.clear();
-        scroll_to_bottom_ = true;
     }
 
     void append_chunk(const std::string& chunk) {
@@ -241,16 +363,7 @@ private:
                     break;
                 }
 
-                std::string line = partial_line_.substr(start, pos - start);
-                if (!line.empty()) {
-                    logs_.push_back(std::move(line));
-                } else {
-                    logs_.emplace_back();
-                }
-                if (logs_.size() > kMaxLogLines) {
-                    logs_.erase(logs_.begin(), logs_.begin() + (logs_.size() - kMaxLogLines));
-                }
-                scroll_to_bottom_ = true;
+                logs_.append(partial_line_.data() + start, pos - start);
 
                 if (partial_line_[pos] == '\r' && pos + 1 < partial_line_.size() && partial_line_[pos + 1] == '\n') {
                     start = pos + 2;
@@ -267,12 +380,8 @@ private:
     void flush_partial_line() {
         std::lock_guard<std::mutex> lock(mutex_);
         if (!partial_line_.empty()) {
-            logs_.push_back(partial_line_);
-            if (logs_.size() > kMaxLogLines) {
-                logs_.erase(logs_.begin(), logs_.begin() + (logs_.size() - kMaxLogLines));
-            }
+            logs_.append(partial_line_.data(), partial_line_.size());
             partial_line_.clear();
-            scroll_to_bottom_ = true;
         }
     }
 
@@ -464,10 +573,9 @@ private:
     std::thread worker_;
     std::mutex mutex_;
     std::mutex process_mutex_;
-    std::vector<std::string> logs_;
+    LogBuffer logs_;
     std::string partial_line_;
     std::atomic<JobStatus> status_{JobStatus::Idle};
-    std::atomic<bool> scroll_to_bottom_{true};
     std::chrono::steady_clock::time_point start_time_{};
 #ifdef _WIN32
     HANDLE process_handle_ = nullptr;
@@ -527,6 +635,170 @@ void ProcessRunner::terminate() {
 #endif
 }
 
+// Hardware encoders run on the GPU next to the renderer; everything else (x264, x265, vp9)
+// is a software encoder that needs several CPU cores per job.
+bool is_hardware_codec(const std::string& codec) {
+    static const char* const kHardwareSuffixes[] = {"_nvenc", "_qsv", "_amf", "_vaapi", "_videotoolbox"};
+    for (const char* suffix : kHardwareSuffixes) {
+        if (codec.find(suffix) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A software x264/x265 encode saturates roughly eight hardware threads at 1080p and above
+int default_cpu_encoder_slots() {
+    unsigned int threads = std::thread::hardware_concurrency();
+    return std::max(1, static_cast<int>(threads / 8));
+}
+
+struct SchedulerLimits {
+    int max_jobs = 2;                                        // Renderer processes running at once
+    int max_gpu_jobs = 2;                                    // Jobs sharing the GPU (every job renders on it)
+    int max_cpu_encoder_jobs = default_cpu_encoder_slots();  // Jobs encoding with a software codec
+};
+
+struct RenderJob {
+    int id = 0;
+    std::filesystem::path midi_file;
+    RenderOptions options;
+    std::string command;
+#ifdef _WIN32
+    std::wstring command_w;
+#endif
+    bool software_encoder = false;
+    bool started = false;
+    double estimated_seconds = 0.0;   // 0 when the MIDI analysis was not ready yet
+    std::unique_ptr<ProcessRunner> runner = std::make_unique<ProcessRunner>();
+
+    JobStatus status() const {
+        return started ? runner->status() : JobStatus::Queued;
+    }
+};
+
+// Render jobs in submission order. update() is called once per UI frame and starts queued
+// jobs while the scheduler limits allow it; a software-encoded job waiting for a CPU encoder
+// slot does not hold back hardware-encoded jobs queued behind it.
+class JobQueue {
+public:
+    ~JobQueue() {
+        terminate_all();
+    }
+
+    RenderJob& add(const std::filesystem::path& midi_file, const RenderOptions& options) {
+        auto job = std::make_unique<RenderJob>();
+        job->id = next_id_++;
+        job->midi_file = midi_file;
+        job->options = options;
+        job->software_encoder = !is_hardware_codec(options.video_codec);
+        jobs_.push_back(std::move(job));
+        return *jobs_.back();
+    }
+
+    void update() {
+        int running = 0;
+        int gpu_jobs = 0;
+        int cpu_encoder_jobs = 0;
+        for (const auto& job : jobs_) {
+            if (job->status() == JobStatus::Running) {
+                ++running;
+                ++gpu_jobs;
+                if (job->software_encoder) {
+                    ++cpu_encoder_jobs;
+                }
+            }
+        }
+
+        for (auto& job : jobs_) {
+            if (running >= limits_.max_jobs || gpu_jobs >= limits_.max_gpu_jobs) {
+                break;
+            }
+            if (job->started) {
+                continue;
+            }
+            if (job->software_encoder && cpu_encoder_jobs >= limits_.max_cpu_encoder_jobs) {
+                continue;
+            }
+
+            start(*job);
+            ++running;
+            ++gpu_jobs;
+            if (job->software_encoder) {
+                ++cpu_encoder_jobs;
+            }
+        }
+    }
+
+    void terminate_all() {
+        for (auto& job : jobs_) {
+            job->runner->terminate();
+        }
+        // Queued jobs would otherwise start on the next update()
+        jobs_.erase(std::remove_if(jobs_.begin(), jobs_.end(),
+                                   [](const std::unique_ptr<RenderJob>& job) { return !job->started; }),
+                    jobs_.end());
+    }
+
+    // Running jobs must be stopped first
+    void remove(int id) {
+        jobs_.erase(std::remove_if(jobs_.begin(), jobs_.end(),
+                                   [id](const std::unique_ptr<RenderJob>& job) {
+                                       return job->id == id && job->status() != JobStatus::Running;
+                                   }),
+                    jobs_.end());
+    }
+
+    void clear_finished() {
+        jobs_.erase(std::remove_if(jobs_.begin(), jobs_.end(),
+                                   [](const std::unique_ptr<RenderJob>& job) {
+                                       JobStatus status = job->status();
+                                       return status == JobStatus::Completed || status == JobStatus::Failed;
+                                   }),
+                    jobs_.end());
+    }
+
+    RenderJob* find(int id) {
+        for (auto& job : jobs_) {
+            if (job->id == id) {
+                return job.get();
+            }
+        }
+        return nullptr;
+    }
+
+    int count(JobStatus status) const {
+        return static_cast<int>(std::count_if(jobs_.begin(), jobs_.end(),
+                                              [status](const std::unique_ptr<RenderJob>& job) {
+                                                  return job->status() == status;
+                                              }));
+    }
+
+    const std::vector<std::unique_ptr<RenderJob>>& jobs() const {
+        return jobs_;
+    }
+
+    SchedulerLimits& limits() {
+        return limits_;
+    }
+
+private:
+    void start(RenderJob& job) {
+        job.started = true;
+#ifdef _WIN32
+        job.runner->start(job.command_w);
+#else
+        job.runner->start(job.command);
+#endif
+        job.runner->append_line("Command: " + job.command);
+        job.runner->append_line("Rendering started.");
+    }
+
+    std::vector<std::unique_ptr<RenderJob>> jobs_;
+    SchedulerLimits limits_;
+    int next_id_ = 1;
+};
+
 std::string format_duration(std::chrono::steady_clock::duration duration) {
     auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
     std::ostringstream oss;
@@ -534,6 +806,44 @@ std::string format_duration(std::chrono::steady_clock::duration duration) {
     return oss.str();
 }
 
+std::string format_clock(double seconds) {
+    auto total = static_cast<long long>(std::max(0.0, seconds) + 0.5);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%lld:%02lld:%02lld", total / 3600, (total / 60) % 60, total % 60);
+    return buffer;
+}
+
+RenderEstimateInput estimate_input(const RenderOptions& opts) {
+    RenderEstimateInput input;
+    input.video_width = opts.video_width;
+    input.video_height = opts.video_height;
+    input.video_codec = opts.video_codec;
+    input.renderer_backend = static_cast<int>(opts.renderer_backend);
+    return input;
+}
+
+void draw_midi_analysis(const MidiAnalysis& analysis, const RenderOptions& opts) {
+    if (!analysis.valid) {
+        ImGui::TextColored(ImVec4(0.9F, 0.2F, 0.2F, 1.0F), "%s", analysis.error.c_str());
+        return;
+    }
+
+    ImGui::Text("Duration %s | Tracks %d | Notes %llu | Peak NPS %llu | Peak polyphony %u",
+                format_clock(analysis.duration_seconds).c_str(), analysis.track_count,
+                static_cast<unsigned long long>(analysis.note_count),
+                static_cast<unsigned long long>(analysis.peak_nps), analysis.peak_polyphony);
+
+    RenderEstimate estimate = estimate_render_time(analysis, estimate_input(opts));
+    ImGui::Text("Estimated render time: ~%s (%s-bound, %s at %dx%d)",
+                format_clock(estimate.total_seconds).c_str(), estimate.encoder_bound ? "encoder" : "renderer",
+                opts.video_codec.c_str(), opts.video_width, opts.video_height);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Renderer: ~%s, encoder: ~%s. Analyzed in %.2fs.",
+                          format_clock(estimate.render_seconds).c_str(),
+                          format_clock(estimate.encode_seconds).c_str(), analysis.analysis_seconds);
+    }
+}
+
 std::string quote_argument(const std::string& value) {
     std::string quoted = "\"";
     for (char c : value) {
@@ -946,6 +1256,8 @@ ImVec4 status_color(JobStatus status) {
     switch (status) {
         case JobStatus::Idle:
             return {0.8F, 0.8F, 0.8F, 1.0F};
+        case JobStatus::Queued:
+            return {0.9F, 0.8F, 0.3F, 1.0F};
         case JobStatus::Running:
             return {0.1F, 0.7F, 0.3F, 1.0F};
         case JobStatus::Completed:
@@ -960,6 +1272,8 @@ const char* status_text(JobStatus status) {
     switch (status) {
         case JobStatus::Idle:
             return "Idle";
+        case JobStatus::Queued:
+            return "Queued";
         case JobStatus::Running:
             return "Rendering";
         case JobStatus::Completed:
@@ -971,9 +1285,9 @@ const char* status_text(JobStatus status) {
 }
 
 void on_window_close(GLFWwindow* window) {
-    auto* runner = static_cast<ProcessRunner*>(glfwGetWindowUserPointer(window));
-    if (runner && runner->is_running()) {
-        runner->terminate();
+    auto* queue = static_cast<JobQueue*>(glfwGetWindowUserPointer(window));
+    if (queue) {
+        queue->terminate_all();
     }
 }
 
@@ -1015,8 +1329,10 @@ int main(int argc, char* argv[]) {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    ProcessRunner runner;
-    glfwSetWindowUserPointer(window, &runner);
+    JobQueue queue;
+    glfwSetWindowUserPointer(window, &queue);
+    MidiAnalyzer analyzer;
+    std::string analyzed_midi_path;
     glfwSetWindowCloseCallback(window, on_window_close);
 
     std::filesystem::path exe_path = std::filesystem::absolute(argv[0]);
@@ -1055,10 +1371,15 @@ int main(int argc, char* argv[]) {
 
     std::string validation_message;
     bool log_auto_scroll = true;
+    int selected_job_id = 0;
+    int log_view_job_id = 0;
+    std::uint64_t log_view_generation = 0;
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
 
+        queue.update();
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -1100,6 +1421,22 @@ int main(int argc, char* argv[]) {
                 }
             }
 
+            // Analysis runs on a worker thread; results are cached by file content
+            auto midi_path = buffer_to_path(midi_path_buffer);
+            std::error_code midi_path_error;
+            if (midi_path.string() != analyzed_midi_path &&
+                std::filesystem::is_regular_file(midi_path, midi_path_error)) {
+                analyzer.request(midi_path);
+                analyzed_midi_path = midi_path.string();
+            }
+            if (!midi_path.empty() && midi_path.string() == analyzed_midi_path) {
+                if (auto analysis = analyzer.try_get(midi_path)) {
+                    draw_midi_analysis(*analysis, options);
+                } else {
+                    ImGui::TextDisabled("Analyzing MIDI file...");
+                }
+            }
+
             ImGui::TextUnformatted("Audio file (optional)");
             ImGui::InputText("##audio_path", audio_path_buffer.data(), audio_path_buffer.size());
             ImGui::SameLine();
@@ -1271,22 +1608,7 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        JobStatus status = runner.status();
-        ImGui::Separator();
-        ImGui::TextUnformatted("Status");
-        ImGui::SameLine();
-        ImGui::TextColored(status_color(status), "%s", status_text(status));
-        if (status == JobStatus::Running) {
-            ImGui::SameLine();
-            ImGui::Text("(elapsed %s)", format_duration(runner.elapsed()).c_str());
-        }
-
-        bool can_start = (status != JobStatus::Running);
-        if (!can_start) {
-            ImGui::BeginDisabled();
-        }
-
-        if (ImGui::Button("Start rendering", ImVec2(200, 0))) {
+        if (ImGui::Button("Add to queue", ImVec2(200, 0))) {
             validation_message.clear();
 
             auto renderer_path = buffer_to_path(renderer_path_buffer);
@@ -1307,54 +1629,149 @@ int main(int argc, char* argv[]) {
             } else if (audio_path && !std::filesystem::exists(*audio_path)) {
                 validation_message = "Audio file not found.";
             } else {
-                auto ffmpeg_path = buffer_to_path(ffmpeg_path_buffer);
-                auto output_dir = buffer_to_path(output_dir_buffer);
-                
-                // Set paths in options
-                if (!ffmpeg_path.empty()) {
-                    options.ffmpeg_path = ffmpeg_path.string();
+                // Each job keeps a snapshot of the settings at the time it was added
+                RenderJob& job = queue.add(midi_path, preview_options);
+                if (auto analysis = analyzer.try_get(midi_path)) {
+                    job.estimated_seconds = estimate_render_time(*analysis, estimate_input(job.options)).total_seconds;
                 }
-                if (!output_dir.empty()) {
-                    options.output_directory = output_dir.string();
-                }
-                
-                std::string command = build_command_line(renderer_path, midi_path, audio_path, options);
+                job.command = build_command_line(renderer_path, midi_path, audio_path, job.options);
 #ifdef _WIN32
-                std::wstring command_w = build_command_line_w(renderer_path, midi_path, audio_path, options);
-                runner.start(command_w);
-                runner.append_line("Command: " + command);
-#else
-                runner.start(command);
-                runner.append_line("Command: " + command);
+                job.command_w = build_command_line_w(renderer_path, midi_path, audio_path, job.options);
 #endif
-                runner.append_line("Rendering started.");
+                selected_job_id = job.id;
             }
         }
 
-        if (!can_start) {
-            ImGui::EndDisabled();
+        ImGui::Separator();
+        ImGui::TextUnformatted("Render queue");
+        SchedulerLimits& limits = queue.limits();
+        ImGui::PushItemWidth(120.0f);
+        if (ImGui::InputInt("Parallel jobs", &limits.max_jobs)) {
+            limits.max_jobs = std::max(1, limits.max_jobs);
+        }
+        ImGui::SameLine();
+        if (ImGui::InputInt("GPU slots", &limits.max_gpu_jobs)) {
+            limits.max_gpu_jobs = std::max(1, limits.max_gpu_jobs);
+        }
+        ImGui::SameLine();
+        if (ImGui::InputInt("CPU encoder slots", &limits.max_cpu_encoder_jobs)) {
+            limits.max_cpu_encoder_jobs = std::max(1, limits.max_cpu_encoder_jobs);
+        }
+        ImGui::PopItemWidth();
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Jobs using a software codec (libx264, libx265, libvpx-vp9) also need a CPU encoder slot.");
         }
 
-        if (status == JobStatus::Running) {
-            ImGui::SameLine();
-            if (ImGui::Button("Stop rendering", ImVec2(200, 0))) {
-                runner.terminate();
+        double queued_estimate = 0.0;
+        for (const auto& job : queue.jobs()) {
+            if (job->status() == JobStatus::Queued) {
+                queued_estimate += job->estimated_seconds;
             }
         }
+        ImGui::Text("%d running, %d queued (~%s of estimated work)", queue.count(JobStatus::Running),
+                    queue.count(JobStatus::Queued), format_clock(queued_estimate).c_str());
+        ImGui::SameLine();
+        if (ImGui::Button("Clear finished")) {
+            queue.clear_finished();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Stop all")) {
+            queue.terminate_all();
+        }
+
+        int remove_job_id = 0;
+        constexpr ImGuiTableFlags kJobTableFlags =
+            ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+        if (ImGui::BeginTable("job_table", 6, kJobTableFlags, ImVec2(0.0f, 160.0f))) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("#", ImGuiTableColumnFlags_WidthFixed, 30.0f);
+            ImGui::TableSetupColumn("MIDI file", ImGuiTableColumnFlags_WidthStretch);
+            ImGui::TableSetupColumn("Codec", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+            ImGui::TableSetupColumn("Estimate", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableSetupColumn("Status", ImGuiTableColumnFlags_WidthFixed, 140.0f);
+            ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+            ImGui::TableHeadersRow();
+
+            for (const auto& job : queue.jobs()) {
+                JobStatus status = job->status();
+                ImGui::PushID(job->id);
+                ImGui::TableNextRow();
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", job->id);
+
+                ImGui::TableNextColumn();
+                std::string midi_name = job->midi_file.filename().string();
+                if (ImGui::Selectable(midi_name.c_str(), selected_job_id == job->id)) {
+                    selected_job_id = job->id;
+                }
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(job->options.video_codec.c_str());
+
+                ImGui::TableNextColumn();
+                if (job->estimated_seconds > 0.0) {
+                    ImGui::TextUnformatted(format_clock(job->estimated_seconds).c_str());
+                } else {
+                    ImGui::TextDisabled("-");
+                }
+
+                ImGui::TableNextColumn();
+                ImGui::TextColored(status_color(status), "%s", status_text(status));
+                if (status == JobStatus::Running) {
+                    ImGui::SameLine();
+                    ImGui::Text("%s", format_duration(job->runner->elapsed()).c_str());
+                }
+
+                ImGui::TableNextColumn();
+                if (status == JobStatus::Running) {
+                    if (ImGui::SmallButton("Stop")) {
+                        job->runner->terminate();
+                    }
+                } else if (ImGui::SmallButton("Remove")) {
+                    remove_job_id = job->id;
+                }
+                ImGui::PopID();
+            }
+            ImGui::EndTable();
+        }
+
+        if (remove_job_id != 0) {
+            queue.remove(remove_job_id);
+        }
+
+        RenderJob* selected_job = queue.find(selected_job_id);
 
         ImGui::Separator();
-        ImGui::TextUnformatted("Logs");
+        if (selected_job) {
+            ImGui::Text("Logs - job #%d (%s)", selected_job->id, selected_job->midi_file.filename().string().c_str());
+        } else {
+            ImGui::TextUnformatted("Logs");
+        }
         ImGui::Checkbox("Auto-scroll", &log_auto_scroll);
         ImGui::BeginChild("log_scroller", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
 
-        auto logs = runner.log_snapshot();
-        for (const auto& line : logs) {
-            ImGui::TextUnformatted(line.c_str());
-        }
+        if (selected_job) {
+            ProcessRunner& job_runner = *selected_job->runner;
+            // Only lines inside the visible scroll region are read and laid out
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<int>(job_runner.log_line_count()));
+            while (clipper.Step()) {
+                job_runner.visit_log_lines(static_cast<std::size_t>(clipper.DisplayStart),
+                                           static_cast<std::size_t>(clipper.DisplayEnd),
+                                           [](const char* text, std::size_t length) {
+                                               ImGui::TextUnformatted(text, text + length);
+                                           });
+            }
+            clipper.End();
 
-        if (log_auto_scroll) {
-            if (runner.consume_scroll_request()) {
-                ImGui::SetScrollHereY(1.0F);
+            std::uint64_t generation = job_runner.log_generation();
+            if (selected_job->id != log_view_job_id || generation != log_view_generation) {
+                if (log_auto_scroll) {
+                    ImGui::SetScrollHereY(1.0F);
+                }
+                log_view_job_id = selected_job->id;
+                log_view_generation = generation;
             }
         }
 
@@ -1373,7 +1790,7 @@ int main(int argc, char* argv[]) {
         glfwSwapBuffers(window);
     }
 
-    runner.join();
+    queue.terminate_all();
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
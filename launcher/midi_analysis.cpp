@@ -0,0 +1,242 @@
+#include "midi_analysis.h"
+
+#include "midi_event_decoder.h"
+#include "midi_parser.h"
+#include "midi_track_range.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+struct FileDeleter {
+    void operator()(MidiFile* file) const { midi_free_file(file); }
+};
+
+// 64-bit content hash, eight bytes per step (only used as a cache key). The file is streamed in
+// fixed chunks so hashing never holds more than one chunk; the parser does its own single read.
+bool hash_file(const std::filesystem::path& path, std::uint64_t& hash, std::uint64_t& size) {
+    constexpr std::size_t kChunkSize = 1 << 20;  // Multiple of 8, so words never straddle chunks
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::streamsize file_size = file.tellg();
+    if (file_size < 0) {
+        return false;
+    }
+    file.seekg(0);
+    size = static_cast<std::uint64_t>(file_size);
+    hash = 0xcbf29ce484222325ull ^ size;
+
+    std::vector<std::uint8_t> chunk(kChunkSize);
+    std::uint64_t remaining = size;
+    while (remaining > 0) {
+        const std::size_t length = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, kChunkSize));
+        if (!file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(length))) {
+            return false;
+        }
+        remaining -= length;
+
+        std::size_t offset = 0;
+        for (; offset + 8 <= length; offset += 8) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, chunk.data() + offset, sizeof(word));
+            hash = (hash ^ word) * 0x100000001b3ull;
+            hash ^= hash >> 29;
+        }
+        for (; offset < length; ++offset) {
+            hash = (hash ^ chunk[offset]) * 0x100000001b3ull;
+        }
+    }
+    return true;
+}
+
+// Same pass as MidiVideoOutput::BuildTempoMapAndStats: tempo map, event counts and last note tick
+void analyze_midi(const MidiFile* midi_file, MidiAnalysis& analysis) {
+    std::vector<TempoChange> tempo_changes;
+    tempo_changes.push_back({0, MidiTempoMap::kDefaultTempo});
+    std::uint64_t last_event_tick = 0;
+
+    for (int track_index = 0; track_index < midi_file->header.numberOfTracks; ++track_index) {
+        for (const MidiTrackEvent& event :
+             ReadTrackEvents<MidiEventKind::Notes | MidiEventKind::Tempo>(midi_file->tracks[track_index])) {
+            if (event.kind == MidiEventKind::Tempo) {
+                tempo_changes.push_back({event.tick, event.tempo});
+                continue;
+            }
+
+            analysis.event_count++;
+            if (event.IsNoteOn()) {
+                analysis.note_count++;
+            }
+            last_event_tick = std::max(last_event_tick, event.tick);
+        }
+    }
+
+    MidiTempoMap tempo_map;
+    tempo_map.Build(std::move(tempo_changes), midi_file->header.timeDivision);
+
+    analysis.track_count = midi_file->header.numberOfTracks;
+    if (analysis.event_count == 0) {
+        return;
+    }
+    analysis.duration_seconds = tempo_map.TickToSeconds(last_event_tick) + 2.0;
+
+    // The renderer's overlay statistics give the same NPS / polyphony figures it will display
+    constexpr int kStatsFps = 60;
+    MidiDecodeSource source;
+    source.midi_file = midi_file;
+    source.tempo_map = &tempo_map;
+    MidiNoteStatsTimeline timeline;
+    timeline.Build({source}, kStatsFps, analysis.duration_seconds);
+
+    const auto frame_count = static_cast<std::int64_t>(analysis.duration_seconds * kStatsFps);
+    for (std::int64_t frame = 0; frame <= frame_count; ++frame) {
+        double time_seconds = static_cast<double>(frame) / kStatsFps;
+        analysis.peak_nps = std::max(analysis.peak_nps, timeline.GetNotesPerSecond(time_seconds));
+        analysis.peak_polyphony = std::max(analysis.peak_polyphony, timeline.GetPolyphony(time_seconds));
+    }
+}
+
+} // namespace
+
+RenderEstimate estimate_render_time(const MidiAnalysis& analysis, const RenderEstimateInput& input) {
+    // Rough throughput figures measured on a mid-range desktop (8-core CPU, RTX 3060 class GPU)
+    // with the fastest encoder presets the renderer selects (x264/x265 ultrafast, NVENC p1)
+    constexpr double kRenderMegapixelsPerSecond = 1500.0;  // Clear, draw and readback
+    constexpr double kFrameOverheadSeconds = 0.001;
+    constexpr double kNotesPerSecond = 20000000.0;         // Decode + keyboard/blip updates
+    const double backend_factor[] = {1.0, 1.1, 1.1};       // OpenGL has async PBO readback
+
+    double encode_megapixels_per_second = 1000.0;          // Hardware encoders
+    if (input.video_codec == "libx264") {
+        encode_megapixels_per_second = 600.0;
+    } else if (input.video_codec == "libx265") {
+        encode_megapixels_per_second = 200.0;
+    } else if (input.video_codec == "libvpx-vp9") {
+        encode_megapixels_per_second = 60.0;
+    }
+
+    RenderEstimate estimate;
+    if (!analysis.valid) {
+        return estimate;
+    }
+
+    const double frames = analysis.duration_seconds * std::max(1, input.fps);
+    const double megapixels = static_cast<double>(std::max(1, input.video_width)) *
+                              static_cast<double>(std::max(1, input.video_height)) / 1000000.0;
+    const int backend = std::clamp(input.renderer_backend, 0, 2);
+
+    estimate.render_seconds = (frames * (megapixels / kRenderMegapixelsPerSecond + kFrameOverheadSeconds) +
+                               static_cast<double>(analysis.event_count) / kNotesPerSecond) *
+                              backend_factor[backend];
+    estimate.encode_seconds = frames * megapixels / encode_megapixels_per_second;
+    estimate.encoder_bound = estimate.encode_seconds > estimate.render_seconds;
+    estimate.total_seconds = std::max(estimate.render_seconds, estimate.encode_seconds);
+    return estimate;
+}
+
+MidiAnalyzer::~MidiAnalyzer() {
+    std::vector<std::shared_future<std::shared_ptr<const MidiAnalysis>>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : entries_) {
+            pending.push_back(entry.second.future);
+        }
+        pending.insert(pending.end(), retired_.begin(), retired_.end());
+    }
+    // Workers write results_by_hash_, so they must finish before the members go away
+    for (auto& future : pending) {
+        future.wait();
+    }
+}
+
+void MidiAnalyzer::request(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::uintmax_t file_size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return;
+    }
+    std::filesystem::file_time_type write_time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end() && it->second.file_size == file_size && it->second.write_time == write_time) {
+        return;
+    }
+
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                  [](const std::shared_future<std::shared_ptr<const MidiAnalysis>>& future) {
+                                      return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                                  }),
+                   retired_.end());
+    if (it != entries_.end()) {
+        retired_.push_back(std::move(it->second.future));
+    }
+
+    Entry entry;
+    entry.file_size = file_size;
+    entry.write_time = write_time;
+    entry.future = std::async(std::launch::async, &MidiAnalyzer::analyze, this, path).share();
+    entries_[path] = std::move(entry);
+}
+
+std::shared_ptr<const MidiAnalysis> MidiAnalyzer::try_get(const std::filesystem::path& path) {
+    std::shared_future<std::shared_ptr<const MidiAnalysis>> future;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(path);
+        if (it == entries_.end()) {
+            return nullptr;
+        }
+        future = it->second.future;
+    }
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return nullptr;
+    }
+    return future.get();
+}
+
+std::shared_ptr<const MidiAnalysis> MidiAnalyzer::analyze(const std::filesystem::path& path) {
+    auto start = std::chrono::steady_clock::now();
+    auto analysis = std::make_shared<MidiAnalysis>();
+
+    if (!hash_file(path, analysis->file_hash, analysis->file_size)) {
+        analysis->error = "Failed to read file.";
+        return analysis;
+    }
+    const ContentKey key{analysis->file_size, analysis->file_hash};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto cached = results_by_hash_.find(key);
+        if (cached != results_by_hash_.end()) {
+            return cached->second;
+        }
+    }
+
+    MidiFile* midi_file_raw = nullptr;
+    MidiParseResult result = midi_load_file(path.string().c_str(), &midi_file_raw);
+    if (result != MIDI_PARSE_SUCCESS) {
+        analysis->error = "Failed to parse MIDI file (error " + std::to_string(static_cast<int>(result)) + ").";
+        return analysis;
+    }
+    std::unique_ptr<MidiFile, FileDeleter> midi_file(midi_file_raw);
+
+    analyze_midi(midi_file.get(), *analysis);
+    analysis->valid = true;
+    analysis->analysis_seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    results_by_hash_[key] = analysis;
+    return analysis;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Workload summary of a MIDI file, gathered with the renderer's own ingest path
+// (midi-parser + MidiTempoMap + MidiNoteStatsTimeline)
+struct MidiAnalysis {
+    bool valid = false;
+    std::string error;
+    std::uint64_t file_hash = 0;
+    std::uint64_t file_size = 0;
+    int track_count = 0;
+    double duration_seconds = 0.0;   // Includes the renderer's 2 second tail
+    std::uint64_t note_count = 0;
+    std::uint64_t event_count = 0;
+    std::uint64_t peak_nps = 0;      // Highest notes-per-second over a 1 second sliding window
+    std::uint32_t peak_polyphony = 0;
+    double analysis_seconds = 0.0;
+};
+
+// Settings the render time estimate depends on
+struct RenderEstimateInput {
+    int video_width = 1920;
+    int video_height = 1080;
+    int fps = 60;
+    std::string video_codec = "libx264";
+    int renderer_backend = 0;        // RenderOptions::RendererBackend value
+};
+
+struct RenderEstimate {
+    double render_seconds = 0.0;     // Renderer process alone (drawing, readback, note processing)
+    double encode_seconds = 0.0;     // Encoder alone
+    double total_seconds = 0.0;      // Both run as a pipeline, so the slower one dominates
+    bool encoder_bound = false;
+};
+
+// Rough wall-clock estimate for rendering an analyzed file with the given settings
+RenderEstimate estimate_render_time(const MidiAnalysis& analysis, const RenderEstimateInput& input);
+
+// Analyzes MIDI files on worker threads so the launcher UI never blocks on parsing.
+// Results are cached by file size and a streamed content hash, so the same file selected again
+// (or copied to another path) is not parsed twice; a path is re-hashed only when its size or
+// modification time changes. The file itself is read once, by the parser.
+class MidiAnalyzer {
+public:
+    MidiAnalyzer() = default;
+    ~MidiAnalyzer();
+
+    MidiAnalyzer(const MidiAnalyzer&) = delete;
+    MidiAnalyzer& operator=(const MidiAnalyzer&) = delete;
+
+    // Starts analyzing path in the background unless an up-to-date request already exists
+    void request(const std::filesystem::path& path);
+
+    // Returns the analysis once it is ready, nullptr while it is still running
+    std::shared_ptr<const MidiAnalysis> try_get(const std::filesystem::path& path);
+
+private:
+    struct Entry {
+        std::uintmax_t file_size = 0;
+        std::filesystem::file_time_type write_time{};
+        std::shared_future<std::shared_ptr<const MidiAnalysis>> future;
+    };
+
+    // File size and content hash
+    using ContentKey = std::pair<std::uint64_t, std::uint64_t>;
+
+    std::shared_ptr<const MidiAnalysis> analyze(const std::filesystem::path& path);
+
+    std::mutex mutex_;
+    std::map<std::filesystem::path, Entry> entries_;
+    // Superseded analyses still running; destroying their futures would block on the worker
+    std::vector<std::shared_future<std::shared_ptr<const MidiAnalysis>>> retired_;
+    std::map<ContentKey, std::shared_ptr<const MidiAnalysis>> results_by_hash_;
+};
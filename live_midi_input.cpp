@@ -0,0 +1,227 @@
+#include "live_midi_input.h"
+
+#include "midi_parser.h"
+#include "thread_affinity.h"
+
+#include <cstring>
+#include <iostream>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr int kPollIntervalMs = 100;  // 停止要求を確認する間隔
+constexpr size_t kReadBufferSize = 4096;
+
+} // namespace
+
+LiveMidiInput::~LiveMidiInput() {
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool LiveMidiInput::Open(const std::string& source) {
+    std::cerr << "Live MIDI input (" << source << ") is only available on Linux and macOS" << std::endl;
+    return false;
+}
+
+void LiveMidiInput::Close() {}
+void LiveMidiInput::ReceiveLoop() {}
+bool LiveMidiInput::WaitForInput(int) { return false; }
+bool LiveMidiInput::ReopenFifo() { return false; }
+void LiveMidiInput::CloseDescriptor() {}
+
+#else
+
+bool LiveMidiInput::Open(const std::string& source) {
+    Close();
+
+    if (source == "-") {
+        kind_ = SourceKind::Descriptor;
+        fd_ = STDIN_FILENO;
+        owns_fd_ = false;
+    } else if (source.rfind("fd:", 0) == 0) {
+        char* end = nullptr;
+        const long fd = std::strtol(source.c_str() + 3, &end, 10);
+        if (end == source.c_str() + 3 || *end != '\0' || fd < 0 || fcntl(static_cast<int>(fd), F_GETFD) == -1) {
+            std::cerr << "Invalid live MIDI file descriptor: " << source << std::endl;
+            return false;
+        }
+        kind_ = SourceKind::Descriptor;
+        fd_ = static_cast<int>(fd);
+        owns_fd_ = false;
+    } else if (source.rfind("unix:", 0) == 0) {
+        path_ = source.substr(5);
+        sockaddr_un address{};
+        if (path_.empty() || path_.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Invalid live MIDI socket path: " << source << std::endl;
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+
+        // 前回の実行で残ったソケットファイルだけは消してから待ち受ける
+        struct stat info {};
+        if (stat(path_.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+            unlink(path_.c_str());
+        }
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd_, 1) != 0) {
+            std::cerr << "Failed to listen on " << path_ << ": " << std::strerror(errno) << std::endl;
+            if (listen_fd_ >= 0) {
+                close(listen_fd_);
+                listen_fd_ = -1;
+            }
+            return false;
+        }
+        kind_ = SourceKind::Socket;
+    } else {
+        path_ = source;
+        struct stat info {};
+        if (stat(path_.c_str(), &info) != 0) {
+            std::cerr << "Live MIDI input not found: " << path_ << std::endl;
+            return false;
+        }
+        kind_ = S_ISFIFO(info.st_mode) ? SourceKind::Fifo : SourceKind::Descriptor;
+        // FIFO は書き込み側がいなくても開けるように非ブロッキングで開く（読み込みは poll で待つ）
+        fd_ = open(path_.c_str(), O_RDONLY | (kind_ == SourceKind::Fifo ? O_NONBLOCK : 0));
+        if (fd_ < 0) {
+            std::cerr << "Failed to open " << path_ << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        owns_fd_ = true;
+    }
+
+    stop_requested_.store(false);
+    received_event_count_.store(0);
+    thread_ = std::thread(&LiveMidiInput::ReceiveLoop, this);
+    return true;
+}
+
+void LiveMidiInput::Close() {
+    stop_requested_.store(true);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    CloseDescriptor();
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(path_.c_str());
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+}
+
+void LiveMidiInput::ReceiveLoop() {
+    EnterBackgroundThread("midi-live-input");
+
+    MidiStreamDecoder decoder;
+    midi_stream_decoder_init(&decoder);
+    std::vector<LiveMidiEvent> received;
+    uint8_t buffer[kReadBufferSize];
+
+    while (!stop_requested_.load()) {
+        if (kind_ == SourceKind::Socket && fd_ < 0) {
+            if (!WaitForInput(listen_fd_)) {
+                continue;
+            }
+            fd_ = accept(listen_fd_, nullptr, nullptr);
+            owns_fd_ = true;
+            if (fd_ >= 0) {
+                std::cout << "Live MIDI client connected on " << path_ << std::endl;
+            }
+            continue;
+        }
+
+        if (!WaitForInput(fd_)) {
+            continue;
+        }
+        const ssize_t size = read(fd_, buffer, sizeof(buffer));
+        // 1回の read で届いたバイトは同時に届いたものとして扱う
+        const auto arrival_time = std::chrono::steady_clock::now();
+
+        if (size < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (size <= 0) {
+            // 送信側が閉じた。受信途中のメッセージとランニングステータスは次の接続に持ち越さない
+            midi_stream_decoder_init(&decoder);
+            if (kind_ == SourceKind::Socket) {
+                std::cout << "Live MIDI client disconnected, waiting for the next one" << std::endl;
+                CloseDescriptor();
+                continue;
+            }
+            if (kind_ == SourceKind::Fifo && ReopenFifo()) {
+                continue;
+            }
+            std::cout << "Live MIDI input ended" << std::endl;
+            break;
+        }
+
+        received.clear();
+        MidiEvent event;
+        for (ssize_t i = 0; i < size; ++i) {
+            if (!midi_stream_decoder_push(&decoder, buffer[i], &event)) {
+                continue;
+            }
+            // ファイル入力と同じくノートだけを鍵盤に送る
+            if (event.eventType != MIDI_EVENT_NOTE_ON && event.eventType != MIDI_EVENT_NOTE_OFF) {
+                continue;
+            }
+            LiveMidiEvent live_event;
+            live_event.arrival_time = arrival_time;
+            live_event.event_type = static_cast<uint8_t>(event.eventType);
+            live_event.channel = event.channel;
+            live_event.data1 = event.data1;
+            live_event.data2 = event.data2;
+            received.push_back(live_event);
+        }
+        if (!received.empty()) {
+            received_event_count_.fetch_add(received.size(), std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.insert(pending_.end(), received.begin(), received.end());
+        }
+    }
+}
+
+bool LiveMidiInput::WaitForInput(int fd) {
+    pollfd entry{};
+    entry.fd = fd;
+    entry.events = POLLIN;
+    return poll(&entry, 1, kPollIntervalMs) > 0;
+}
+
+bool LiveMidiInput::ReopenFifo() {
+    // 書き込み側が閉じると read が 0 を返し続けるので、開き直して次の書き込み側を待つ
+    CloseDescriptor();
+    fd_ = open(path_.c_str(), O_RDONLY | O_NONBLOCK);
+    owns_fd_ = fd_ >= 0;
+    return fd_ >= 0;
+}
+
+void LiveMidiInput::CloseDescriptor() {
+    if (fd_ >= 0 && owns_fd_) {
+        close(fd_);
+    }
+    fd_ = -1;
+    owns_fd_ = false;
+}
+
+#endif
+
+void LiveMidiInput::Drain(std::vector<LiveMidiEvent>& events) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events.insert(events.end(), pending_.begin(), pending_.end());
+    pending_.clear();
+}
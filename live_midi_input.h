@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// ライブ入力で受信したノートイベント
+struct LiveMidiEvent {
+    std::chrono::steady_clock::time_point arrival_time;  // 受信時刻（read が返った時点）
+    uint8_t event_type{0};  // MIDI_EVENT_NOTE_ON / MIDI_EVENT_NOTE_OFF
+    uint8_t channel{0};
+    uint8_t data1{0};       // ノート番号
+    uint8_t data2{0};       // ベロシティ
+};
+
+// 生のMIDIバイト列（ランニングステータス付き）をファイルディスクリプタから読むライブ入力（--live-midi）
+//
+//   "-"            標準入力（DAW ブリッジやテスト用ジェネレーターをパイプでつなぐ）
+//   "fd:<n>"       親プロセスから渡されたファイルディスクリプタ
+//   "unix:<path>"  Unix ドメインソケットで待ち受け、接続ごとに読む（切断されたら次の接続を待つ）
+//   それ以外        FIFO などのパス（FIFO は書き込み側が閉じても開き直して待つ）
+//
+// 受信スレッドが read ごとに時刻を記録し、midi_stream_decoder で1バイトずつデコードする。
+// 描画ループは毎フレーム Drain で取り出すので、受信から描画までの遅れは1フレーム未満になる。
+// Linux / macOS のみ（Windows では Open が false を返す）。
+class LiveMidiInput {
+public:
+    LiveMidiInput() = default;
+    ~LiveMidiInput();
+
+    LiveMidiInput(const LiveMidiInput&) = delete;
+    LiveMidiInput& operator=(const LiveMidiInput&) = delete;
+
+    // 入力を開いて受信スレッドを開始する。失敗時はエラーを出力して false
+    bool Open(const std::string& source);
+    void Close();
+    bool IsOpen() const { return thread_.joinable(); }
+
+    // 前回から受信したノートイベントを到着順に events の末尾へ移す
+    void Drain(std::vector<LiveMidiEvent>& events);
+    uint64_t GetReceivedEventCount() const { return received_event_count_.load(std::memory_order_relaxed); }
+
+private:
+    enum class SourceKind {
+        Descriptor,  // 標準入力・渡されたディスクリプタ・通常ファイル（EOF で終了）
+        Fifo,        // EOF で開き直す
+        Socket       // EOF で次の接続を待つ
+    };
+
+    void ReceiveLoop();
+    bool WaitForInput(int fd);  // 読めるようになるか停止要求まで待つ
+    bool ReopenFifo();
+    void CloseDescriptor();
+
+    std::string path_;
+    SourceKind kind_ = SourceKind::Descriptor;
+    int fd_ = -1;
+    bool owns_fd_ = false;
+    int listen_fd_ = -1;
+
+    std::thread thread_;
+    std::atomic<bool> stop_requested_{false};
+    std::atomic<uint64_t> received_event_count_{0};
+
+    std::mutex mutex_;
+    std::vector<LiveMidiEvent> pending_;
+};
@@ -24,6 +24,7 @@
 #include <cstring>
 #include <cctype>
 #include <cmath>
+#include <algorithm>
 #include <filesystem>
 #include <sstream>
 #include <iomanip>
@@ -34,6 +35,8 @@
 #include <cstddef>
 #include <atomic>
 #include <csignal>
+#include <chrono>
+#include <thread>
 #include <exception>
 
 #if defined(_MSC_VER)
@@ -47,6 +50,11 @@
 #include "vulkan_renderer.h"
 #include "piano_keyboard.h"
 #include "midi_video_output.h"
+#include "task_system.h"
+#include "thread_affinity.h"
+#include "distributed_render.h"
+#include "live_midi_input.h"
+#include "background_image_cache.h"
 
 #include "resources/window_icon_loader.h"
 
@@ -111,6 +119,39 @@ static void SetWindowIcon(GLFWwindow* window) {
     }
 }
 
+// Frame timing of the --realtime window, collected per one-second window and for the whole run
+struct RealtimeFrameStats {
+    int frames = 0;
+    int dropped_frames = 0;     // Display refreshes that passed without a new frame
+    double seconds = 0.0;
+    double frame_ms_total = 0.0;
+    double frame_ms_max = 0.0;
+    double latency_ms_total = 0.0;
+    double latency_ms_max = 0.0;
+    int live_frames = 0;        // Frames that showed newly received --live-midi notes
+    double live_latency_ms_total = 0.0;
+    double live_latency_ms_max = 0.0;
+
+    void Add(double frame_ms, double latency_ms, int dropped) {
+        frames++;
+        dropped_frames += dropped;
+        frame_ms_total += frame_ms;
+        frame_ms_max = std::max(frame_ms_max, frame_ms);
+        latency_ms_total += latency_ms;
+        latency_ms_max = std::max(latency_ms_max, latency_ms);
+    }
+    // From the arrival of the oldest live note in a frame to that frame's completed swap
+    void AddLiveLatency(double latency_ms) {
+        live_frames++;
+        live_latency_ms_total += latency_ms;
+        live_latency_ms_max = std::max(live_latency_ms_max, latency_ms);
+    }
+    double GetFps() const { return seconds > 0.0 ? frames / seconds : 0.0; }
+    double GetAverageFrameMs() const { return frames > 0 ? frame_ms_total / frames : 0.0; }
+    double GetAverageLatencyMs() const { return frames > 0 ? latency_ms_total / frames : 0.0; }
+    double GetAverageLiveLatencyMs() const { return live_frames > 0 ? live_latency_ms_total / live_frames : 0.0; }
+};
+
 static std::string FormatTime(double seconds) {
     if (seconds < 0.0) {
         seconds = 0.0;
@@ -149,7 +190,7 @@ OpenGLRenderer* g_opengl_renderer = nullptr;
 #ifdef _WIN32
 DirectX12Renderer* g_directx_renderer = nullptr;
 #endif
-std::unique_ptr<PianoKeyboard> g_piano_keyboard;
+std::vector<std::unique_ptr<PianoKeyboard>> g_piano_keyboards;
 std::unique_ptr<MidiVideoOutput> g_midi_video_output;
 std::atomic<bool> g_should_exit{false};
 
@@ -257,21 +298,124 @@ static int ParseBitrateOption(const std::string& input) {
     return static_cast<int>(std::llround(result));
 }
 
+// A --start / --end position. Musical positions are resolved against the primary MIDI file once
+// it is loaded.
+struct TimelinePosition {
+    enum class Unit {
+        None,
+        Seconds,
+        Tick,
+        Bar
+    };
+
+    Unit unit = Unit::None;
+    double seconds = 0.0;
+    uint64_t tick = 0;
+    int bar = 0;
+};
+
+// Accepts seconds ("95.5"), [h:]m:ss ("1:35.5"), "tick:<n>" or "bar:<n>" (bars count from 1)
+static TimelinePosition ParseTimelinePosition(const std::string& input) {
+    TimelinePosition position;
+    size_t consumed = 0;
+    if (input.rfind("tick:", 0) == 0) {
+        const std::string value = input.substr(5);
+        position.unit = TimelinePosition::Unit::Tick;
+        position.tick = std::stoull(value, &consumed);
+        if (consumed != value.size() || value.find('-') != std::string::npos) {
+            throw std::invalid_argument("Tick must be a non-negative integer");
+        }
+        return position;
+    }
+    if (input.rfind("bar:", 0) == 0) {
+        const std::string value = input.substr(4);
+        position.unit = TimelinePosition::Unit::Bar;
+        position.bar = std::stoi(value, &consumed);
+        if (consumed != value.size() || position.bar < 1) {
+            throw std::invalid_argument("Bar must be an integer starting at 1");
+        }
+        return position;
+    }
+
+    // Each ':' shifts the fields parsed so far up by one unit (seconds -> minutes -> hours)
+    double seconds = 0.0;
+    size_t field_start = 0;
+    int fields = 0;
+    while (true) {
+        const size_t separator = input.find(':', field_start);
+        const std::string field = input.substr(field_start, separator == std::string::npos ? std::string::npos
+                                                                                            : separator - field_start);
+        const double value = std::stod(field, &consumed);
+        if (consumed != field.size() || value < 0.0) {
+            throw std::invalid_argument("Time must be seconds or [h:]m:ss");
+        }
+        seconds = seconds * 60.0 + value;
+        fields++;
+        if (separator == std::string::npos) {
+            break;
+        }
+        field_start = separator + 1;
+    }
+    if (fields > 3) {
+        throw std::invalid_argument("Time must be seconds or [h:]m:ss");
+    }
+    position.unit = TimelinePosition::Unit::Seconds;
+    position.seconds = seconds;
+    return position;
+}
+
+static double ResolveTimelinePosition(const TimelinePosition& position, const MidiVideoOutput& midi_output) {
+    switch (position.unit) {
+        case TimelinePosition::Unit::Tick:
+            return midi_output.GetTickTime(position.tick);
+        case TimelinePosition::Unit::Bar:
+            return midi_output.GetBarStartTime(position.bar);
+        default:
+            return position.seconds;
+    }
+}
+
 // Command line options struct
 struct CommandLineOptions {
-    std::string midi_file;
+    std::string midi_file;  // Primary MIDI file (used for output naming)
+    std::vector<MidiInputSource> midi_inputs;  // All MIDI files to merge, in command-line order
     std::string video_codec = "libx264";  // Default to H.264
     bool debug_mode = false;  // Debug information overlay
+    bool note_stats = false;  // Notes played / NPS / polyphony overlay
     std::string audio_file;
+    bool synth_audio = false;  // Synthesize the soundtrack from the MIDI notes
+    int synth_voices = 131072;  // Voice limit for the built-in synthesizer
+    std::string background_image;  // Background image drawn behind the keyboard
+    float background_opacity = 1.0f;
+    BackgroundScaleMode background_scale = BackgroundScaleMode::Fill;
     bool show_preview = false;
+    bool realtime = false;  // Play live in a window instead of writing a video file
+    std::string live_midi_source;  // Raw MIDI byte stream drawn as it arrives (--live-midi)
     int video_width = DEFAULT_VIDEO_WIDTH;
     int video_height = DEFAULT_VIDEO_HEIGHT;
+    float render_scale = 1.0f;  // Internal render resolution relative to the video resolution
     bool use_cbr = true;
     int video_bitrate = 240000000;
     VideoOutputSettings::ColorMode color_mode = VideoOutputSettings::ColorMode::Channel;
+    BlipMode blip_mode = BlipMode::Stacked;
+    int temporal_samples = 1;  // Sub-frames rendered and averaged per output frame
+    int keyboard_count = 1;  // Keyboards stacked vertically in the frame
+    VideoOutputSettings::KeyboardSplit keyboard_split = VideoOutputSettings::KeyboardSplit::Channel;
     std::string ffmpeg_path;  // Custom FFmpeg executable path
     std::string output_directory;  // Custom output directory
     std::string renderer = "opengl"; // Rendering backend: opengl, vulkan, or dx12 (Windows only)
+    double decode_ahead_seconds = 2.0; // How far the MIDI decoder thread runs ahead of the playhead
+    unsigned int thread_count = 0;  // Task system threads including the main thread (0 = hardware threads)
+    CpuList render_cpus;      // CPUs for the main render/readback thread (empty = unpinned)
+    CpuList background_cpus;  // CPUs for pool workers and the MIDI decoder (empty = whatever is left)
+    CpuList encoder_cpus;     // CPUs FFmpeg is launched on (empty = unpinned)
+    bool huge_pages = true;   // Back the capture frame buffers with huge pages
+    std::string coordinator_directory;  // Shared directory this process coordinates a distributed render in
+    std::string worker_directory;       // Shared directory this process renders segments for
+    double segment_seconds = 30.0;      // Length of one distributed render segment
+    double segment_timeout = 300.0;     // Seconds without progress before a claimed segment is handed out again
+    TimelinePosition range_start;       // Render only from here (--start)
+    TimelinePosition range_end;         // ... up to here (--end)
 };
 
 // Parse command line arguments
@@ -279,21 +423,48 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
     CommandLineOptions options;
     
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " [options] <midi_file>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " [options] <midi_file> [<midi_file> ...]" << std::endl;
         std::cerr << "   or: " << argv[0] << " <midi_file> [options]" << std::endl;
         std::cerr << "Options:" << std::endl;
         std::cerr << "  --video-codec, -vc <codec>  Video codec for FFmpeg (default: libx264)" << std::endl;
         std::cerr << "  --debug, -d                 Show debug information overlay in video" << std::endl;
+        std::cerr << "  --note-stats                Show notes played / NPS / polyphony overlay in video" << std::endl;
         std::cerr << "  --audio-file, -af <path>    External audio file to mux with the render" << std::endl;
+        std::cerr << "  --synth-audio               Synthesize the soundtrack from the MIDI notes (ignored with --audio-file)" << std::endl;
+        std::cerr << "  --synth-voices <n>          Voice limit for --synth-audio (default: 131072)" << std::endl;
+        std::cerr << "  --background <image>        Draw an image (PNG/JPEG/BMP/...) behind the keyboard" << std::endl;
+        std::cerr << "  --background-opacity <0-1>  Background image opacity (default: 1.0)" << std::endl;
+        std::cerr << "  --background-scale <mode>   Background image scaling: fill, fit, stretch, center (default: fill)" << std::endl;
         std::cerr << "  --resolution, -r <WxH>      Set video resolution (default: 1920x1080)" << std::endl;
+        std::cerr << "  --render-scale <factor>     Render at factor x the video resolution and resample (0.25-2, default: 1)" << std::endl;
         std::cerr << "  --bitrate, -br <value>     Set video bitrate (accepts suffixes like 20M, 5000k, 25mbps)" << std::endl;
         std::cerr << "  --cbr                       Force constant bitrate encoding" << std::endl;
         std::cerr << "  --vbr, --no-cbr             Use variable bitrate encoding" << std::endl;
         std::cerr << "  --show-preview, -sp         Display a 1280x720 preview window" << std::endl;
+        std::cerr << "  --realtime                  Play live in a window from the system clock (no video file)" << std::endl;
+        std::cerr << "  --live-midi <source>        Visualize raw MIDI bytes from -, fd:<n>, unix:<path> or a FIFO (implies --realtime, MIDI file optional)" << std::endl;
         std::cerr << "  --color-mode, -cm <mode>    Blip color mode: channel, track, both" << std::endl;
+        std::cerr << "  --blip-mode <mode>          Blip style: stacked, heat (one decaying bar per key, for very dense MIDIs)" << std::endl;
+        std::cerr << "  --keyboards <n>             Stack n keyboards and route notes to them (1-16, default: 1)" << std::endl;
+        std::cerr << "  --split-by <mode>           Note routing for --keyboards: channel (default), track" << std::endl;
+        std::cerr << "  --temporal-samples <n>      Sub-frames averaged per output frame for smoother motion (1-16, default: 1)" << std::endl;
         std::cerr << "  --ffmpeg-path, -fp <path>   Path to FFmpeg executable (default: system PATH)" << std::endl;
         std::cerr << "  --output-directory, -o <path> Output directory for video files (default: executable dir)" << std::endl;
         std::cerr << "  --renderer, -rdr <backend>  Rendering backend: opengl (default), dx12 (Windows), vulkan" << std::endl;
+        std::cerr << "  --decode-ahead <seconds>    Seconds of MIDI events decoded ahead of the playhead (default: 2)" << std::endl;
+        std::cerr << "  --threads <n>               Threads in the shared task pool: MIDI loading, synthesis, frame readback (default: all cores)" << std::endl;
+        std::cerr << "  --render-cpu <list>         Pin the render/readback thread to these CPUs, e.g. 0 or 0-1" << std::endl;
+        std::cerr << "  --cpu-affinity <list>       CPUs for task pool workers and the MIDI decoder (default: CPUs not given to render/encoder)" << std::endl;
+        std::cerr << "  --encoder-cpus <list>       Launch FFmpeg restricted to these CPUs (Linux/macOS), e.g. 4-15" << std::endl;
+        std::cerr << "  --no-huge-pages             Allocate capture frame buffers from regular pages (for A/B timing)" << std::endl;
+        std::cerr << "  --start <pos>               Render from this position: seconds, [h:]m:ss, tick:<n> or bar:<n>" << std::endl;
+        std::cerr << "  --end <pos>                 Stop rendering at this position (same formats as --start)" << std::endl;
+        std::cerr << "  --coordinator <dir>         Split the render into segments in a shared directory and join the workers' output" << std::endl;
+        std::cerr << "  --worker <dir>              Render segments claimed from a coordinator's directory (use the coordinator's options)" << std::endl;
+        std::cerr << "  --segment-seconds <s>       Segment length for --coordinator (default: 30)" << std::endl;
+        std::cerr << "  --segment-timeout <s>       Hand a segment to another worker after this long without progress (default: 300)" << std::endl;
+        std::cerr << "  --offset <seconds>          Start time of the preceding MIDI file when merging several files" << std::endl;
+        std::cerr << "  --color-offset <n>          Palette offset for the preceding MIDI file when merging" << std::endl;
         std::cerr << std::endl;
         std::cerr << "Supported codecs:" << std::endl;
         std::cerr << "  Software encoders:" << std::endl;
@@ -316,6 +487,7 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
         std::cerr << "  " << argv[0] << " song.mid -r 2560x1440" << std::endl;
         std::cerr << "  " << argv[0] << " song.mid --bitrate 40M --vbr" << std::endl;
         std::cerr << "  " << argv[0] << " -d song.mid --video-codec hevc_nvenc" << std::endl;
+        std::cerr << "  " << argv[0] << " melody.mid bass.mid --offset 4 --color-offset 8" << std::endl;
         exit(-1);
     }
     
@@ -375,6 +547,96 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
                     std::cerr << "Error: " << arg << " requires a file path" << std::endl;
                     exit(-1);
                 }
+            } else if (arg == "--synth-audio") {
+                options.synth_audio = true;
+            } else if (arg == "--synth-voices") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        int voices = std::stoi(value);
+                        if (voices <= 0) {
+                            throw std::invalid_argument("Voice limit must be positive");
+                        }
+                        options.synth_voices = voices;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid voice limit '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--background") {
+                if (i + 1 < argc) {
+                    options.background_image = argv[i + 1];
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a file path" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--render-scale") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        float scale = std::stof(value);
+                        if (scale < 0.25f || scale > 2.0f) {
+                            throw std::out_of_range("Render scale must be between 0.25 and 2");
+                        }
+                        options.render_scale = scale;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid render scale '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--background-opacity") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        float opacity = std::stof(value);
+                        if (opacity < 0.0f || opacity > 1.0f) {
+                            throw std::out_of_range("Opacity must be between 0 and 1");
+                        }
+                        options.background_opacity = opacity;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid background opacity '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--background-scale") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    std::string lowercase;
+                    lowercase.reserve(value.size());
+                    for (char ch : value) {
+                        lowercase.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+                    }
+
+                    if (lowercase == "fill") {
+                        options.background_scale = BackgroundScaleMode::Fill;
+                    } else if (lowercase == "fit") {
+                        options.background_scale = BackgroundScaleMode::Fit;
+                    } else if (lowercase == "stretch") {
+                        options.background_scale = BackgroundScaleMode::Stretch;
+                    } else if (lowercase == "center") {
+                        options.background_scale = BackgroundScaleMode::Center;
+                    } else {
+                        std::cerr << "Error: Invalid background scale '" << value << "'. Supported values are fill, fit, stretch, center." << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
             } else if (arg == "--bitrate" || arg == "-br") {
                 if (i + 1 < argc) {
                     std::string value = argv[i + 1];
@@ -393,10 +655,25 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
                 options.use_cbr = true;
             } else if (arg == "--vbr" || arg == "--no-cbr") {
                 options.use_cbr = false;
+            } else if (arg == "--no-huge-pages") {
+                options.huge_pages = false;
             } else if (arg == "--debug" || arg == "-d") {
                 options.debug_mode = true;
+            } else if (arg == "--note-stats") {
+                options.note_stats = true;
             } else if (arg == "--show-preview" || arg == "-sp") {
                 options.show_preview = true;
+            } else if (arg == "--realtime") {
+                options.realtime = true;
+            } else if (arg == "--live-midi") {
+                if (i + 1 < argc) {
+                    options.live_midi_source = argv[i + 1];
+                    options.realtime = true;
+                    i++;
+                } else {
+                    std::cerr << "Error: --live-midi requires -, fd:<n>, unix:<path> or a FIFO path" << std::endl;
+                    exit(-1);
+                }
             } else if (arg == "--color-mode" || arg == "-cm") {
                 if (i + 1 < argc) {
                     std::string value = argv[i + 1];
@@ -421,6 +698,86 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
                     std::cerr << "Error: " << arg << " requires a value" << std::endl;
                     exit(-1);
                 }
+            } else if (arg == "--blip-mode") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    std::string lowercase;
+                    lowercase.reserve(value.size());
+                    for (char ch : value) {
+                        lowercase.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+                    }
+
+                    if (lowercase == "stacked") {
+                        options.blip_mode = BlipMode::Stacked;
+                    } else if (lowercase == "heat") {
+                        options.blip_mode = BlipMode::Heat;
+                    } else {
+                        std::cerr << "Error: Invalid blip mode '" << value << "'. Supported values are stacked, heat." << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--keyboards") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        int count = std::stoi(value);
+                        if (count < 1 || count > 16) {
+                            throw std::invalid_argument("Keyboard count must be between 1 and 16");
+                        }
+                        options.keyboard_count = count;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid keyboard count '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--split-by") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    std::string lowercase;
+                    lowercase.reserve(value.size());
+                    for (char ch : value) {
+                        lowercase.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+                    }
+
+                    if (lowercase == "channel") {
+                        options.keyboard_split = VideoOutputSettings::KeyboardSplit::Channel;
+                    } else if (lowercase == "track") {
+                        options.keyboard_split = VideoOutputSettings::KeyboardSplit::Track;
+                    } else {
+                        std::cerr << "Error: Invalid split mode '" << value << "'. Supported values are channel, track." << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--temporal-samples") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        int samples = std::stoi(value);
+                        if (samples < 1 || samples > 16) {
+                            throw std::invalid_argument("Sample count must be between 1 and 16");
+                        }
+                        options.temporal_samples = samples;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid temporal sample count '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
             } else if (arg == "--ffmpeg-path" || arg == "-fp") {
                 if (i + 1 < argc) {
                     options.ffmpeg_path = argv[i + 1];
@@ -445,23 +802,171 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
                     std::cerr << "Error: " << arg << " requires a value (opengl or dx12)" << std::endl;
                     exit(-1);
                 }
+            } else if (arg == "--decode-ahead") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        double seconds = std::stod(value);
+                        if (seconds <= 0.0) {
+                            throw std::invalid_argument("Decode-ahead window must be positive");
+                        }
+                        options.decode_ahead_seconds = seconds;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid decode-ahead value '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value in seconds" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--coordinator" || arg == "--worker") {
+                if (i + 1 < argc) {
+                    (arg == "--coordinator" ? options.coordinator_directory : options.worker_directory) = argv[i + 1];
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a shared directory" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--start" || arg == "--end") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        (arg == "--start" ? options.range_start : options.range_end) = ParseTimelinePosition(value);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid " << arg << " position '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a time, tick:<n> or bar:<n>" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--segment-seconds" || arg == "--segment-timeout") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        double seconds = std::stod(value);
+                        if (seconds <= 0.0) {
+                            throw std::invalid_argument("Value must be positive");
+                        }
+                        (arg == "--segment-seconds" ? options.segment_seconds : options.segment_timeout) = seconds;
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid " << arg << " value '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a value in seconds" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--threads") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    try {
+                        int threads = std::stoi(value);
+                        if (threads <= 0) {
+                            throw std::invalid_argument("Thread count must be positive");
+                        }
+                        options.thread_count = static_cast<unsigned int>(threads);
+                    } catch (const std::exception& e) {
+                        std::cerr << "Error: Invalid thread count '" << value << "': " << e.what() << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a thread count" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--render-cpu" || arg == "--cpu-affinity" || arg == "--encoder-cpus") {
+                if (i + 1 < argc) {
+                    std::string value = argv[i + 1];
+                    CpuList& cpus = (arg == "--render-cpu") ? options.render_cpus
+                                  : (arg == "--cpu-affinity") ? options.background_cpus
+                                  : options.encoder_cpus;
+                    std::string error;
+                    if (!ParseCpuList(value, cpus, error)) {
+                        std::cerr << "Error: Invalid CPU list '" << value << "' for " << arg << ": " << error << std::endl;
+                        exit(-1);
+                    }
+                    i++;
+                } else {
+                    std::cerr << "Error: " << arg << " requires a CPU list (e.g. 0-3,8)" << std::endl;
+                    exit(-1);
+                }
+            } else if (arg == "--offset" || arg == "--color-offset") {
+                if (options.midi_inputs.empty()) {
+                    std::cerr << "Error: " << arg << " must follow the MIDI file it applies to" << std::endl;
+                    exit(-1);
+                }
+                if (i + 1 >= argc) {
+                    std::cerr << "Error: " << arg << " requires a value" << std::endl;
+                    exit(-1);
+                }
+                std::string value = argv[i + 1];
+                try {
+                    if (arg == "--offset") {
+                        double seconds = std::stod(value);
+                        if (seconds < 0.0) {
+                            throw std::invalid_argument("Offset must not be negative");
+                        }
+                        options.midi_inputs.back().time_offset_seconds = seconds;
+                    } else {
+                        int offset = std::stoi(value);
+                        if (offset < 0) {
+                            throw std::invalid_argument("Color offset must not be negative");
+                        }
+                        options.midi_inputs.back().color_offset = offset;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid value for " << arg << " '" << value << "': " << e.what() << std::endl;
+                    exit(-1);
+                }
+                i++;
             } else if (arg == "--help" || arg == "-h") {
                 // Show help and exit
-                std::cerr << "Usage: " << argv[0] << " [options] <midi_file>" << std::endl;
+                std::cerr << "Usage: " << argv[0] << " [options] <midi_file> [<midi_file> ...]" << std::endl;
                 std::cerr << "   or: " << argv[0] << " <midi_file> [options]" << std::endl;
                 std::cerr << "Options:" << std::endl;
                 std::cerr << "  --video-codec, -vc <codec>  Video codec for FFmpeg (default: libx264)" << std::endl;
                 std::cerr << "  --debug, -d                 Show debug information overlay in video" << std::endl;
+                std::cerr << "  --note-stats                Show notes played / NPS / polyphony overlay in video" << std::endl;
                 std::cerr << "  --audio-file, -af <path>    External audio file to mux with the render" << std::endl;
+                std::cerr << "  --synth-audio               Synthesize the soundtrack from the MIDI notes (ignored with --audio-file)" << std::endl;
+                std::cerr << "  --synth-voices <n>          Voice limit for --synth-audio (default: 131072)" << std::endl;
+                std::cerr << "  --background <image>        Draw an image (PNG/JPEG/BMP/...) behind the keyboard" << std::endl;
+                std::cerr << "  --background-opacity <0-1>  Background image opacity (default: 1.0)" << std::endl;
+                std::cerr << "  --background-scale <mode>   Background image scaling: fill, fit, stretch, center (default: fill)" << std::endl;
                 std::cerr << "  --resolution, -r <WxH>      Set video resolution (default: 1920x1080)" << std::endl;
+                std::cerr << "  --render-scale <factor>     Render at factor x the video resolution and resample (0.25-2, default: 1)" << std::endl;
                 std::cerr << "  --bitrate, -br <value>     Set video bitrate (accepts suffixes like 20M, 5000k, 25mbps)" << std::endl;
                 std::cerr << "  --cbr                       Force constant bitrate encoding" << std::endl;
                 std::cerr << "  --vbr, --no-cbr             Use variable bitrate encoding" << std::endl;
                 std::cerr << "  --show-preview, -sp         Display a 1280x720 preview window" << std::endl;
+                std::cerr << "  --realtime                  Play live in a window from the system clock (no video file)" << std::endl;
+                std::cerr << "  --live-midi <source>        Visualize raw MIDI bytes from -, fd:<n>, unix:<path> or a FIFO (implies --realtime, MIDI file optional)" << std::endl;
                 std::cerr << "  --color-mode, -cm <mode>    Blip color mode: channel, track, both" << std::endl;
+                std::cerr << "  --blip-mode <mode>          Blip style: stacked, heat (one decaying bar per key, for very dense MIDIs)" << std::endl;
+                std::cerr << "  --keyboards <n>             Stack n keyboards and route notes to them (1-16, default: 1)" << std::endl;
+                std::cerr << "  --split-by <mode>           Note routing for --keyboards: channel (default), track" << std::endl;
+                std::cerr << "  --temporal-samples <n>      Sub-frames averaged per output frame for smoother motion (1-16, default: 1)" << std::endl;
                 std::cerr << "  --ffmpeg-path, -fp <path>   Path to FFmpeg executable (default: system PATH)" << std::endl;
                 std::cerr << "  --output-directory, -o <path> Output directory for video files (default: executable dir)" << std::endl;
                 std::cerr << "  --renderer, -rdr <backend>  Rendering backend: opengl (default), dx12 (Windows), vulkan" << std::endl;
+                std::cerr << "  --decode-ahead <seconds>    Seconds of MIDI events decoded ahead of the playhead (default: 2)" << std::endl;
+                std::cerr << "  --threads <n>               Threads in the shared task pool: MIDI loading, synthesis, frame readback (default: all cores)" << std::endl;
+                std::cerr << "  --render-cpu <list>         Pin the render/readback thread to these CPUs, e.g. 0 or 0-1" << std::endl;
+                std::cerr << "  --cpu-affinity <list>       CPUs for task pool workers and the MIDI decoder (default: CPUs not given to render/encoder)" << std::endl;
+                std::cerr << "  --encoder-cpus <list>       Launch FFmpeg restricted to these CPUs (Linux/macOS), e.g. 4-15" << std::endl;
+                std::cerr << "  --no-huge-pages             Allocate capture frame buffers from regular pages (for A/B timing)" << std::endl;
+                std::cerr << "  --start <pos>               Render from this position: seconds, [h:]m:ss, tick:<n> or bar:<n>" << std::endl;
+                std::cerr << "  --end <pos>                 Stop rendering at this position (same formats as --start)" << std::endl;
+                std::cerr << "  --coordinator <dir>         Split the render into segments in a shared directory and join the workers' output" << std::endl;
+                std::cerr << "  --worker <dir>              Render segments claimed from a coordinator's directory (use the coordinator's options)" << std::endl;
+                std::cerr << "  --segment-seconds <s>       Segment length for --coordinator (default: 30)" << std::endl;
+                std::cerr << "  --segment-timeout <s>       Hand a segment to another worker after this long without progress (default: 300)" << std::endl;
+                std::cerr << "  --offset <seconds>          Start time of the preceding MIDI file when merging several files" << std::endl;
+                std::cerr << "  --color-offset <n>          Palette offset for the preceding MIDI file when merging" << std::endl;
                 std::cerr << "  --help, -h                  Show this help message" << std::endl;
                 exit(0);
             } else {
@@ -469,21 +974,37 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
                 exit(-1);
             }
         } else {
-            // This argument doesn't start with '-', so it should be the MIDI file path
+            // This argument doesn't start with '-', so it should be a MIDI file path.
+            // Several files are merged onto one keyboard; the first one names the output.
             if (!midi_file_found) {
                 options.midi_file = arg;
                 midi_file_found = true;
-            } else {
-                std::cerr << "Error: Multiple MIDI files specified. Only one MIDI file is allowed." << std::endl;
-                std::cerr << "First file: " << options.midi_file << std::endl;
-                std::cerr << "Second file: " << arg << std::endl;
-                exit(-1);
             }
+            MidiInputSource input;
+            input.path = arg;
+            options.midi_inputs.push_back(input);
         }
     }
     
+    if (!options.coordinator_directory.empty() && !options.worker_directory.empty()) {
+        std::cerr << "Error: --coordinator and --worker cannot be combined; start workers as separate processes" << std::endl;
+        exit(-1);
+    }
+    if (options.realtime && (!options.coordinator_directory.empty() || !options.worker_directory.empty())) {
+        std::cerr << "Error: --realtime plays in a window and cannot be combined with distributed rendering" << std::endl;
+        exit(-1);
+    }
+
+    // Live input can drive the keyboard on its own; the MIDI file is then optional
+    const bool live_only = !options.live_midi_source.empty() && options.midi_inputs.empty();
+    if (live_only && (options.range_start.unit != TimelinePosition::Unit::None ||
+                      options.range_end.unit != TimelinePosition::Unit::None)) {
+        std::cerr << "Error: --start / --end need a MIDI file" << std::endl;
+        exit(-1);
+    }
+
     // Check if MIDI file was provided
-    if (!midi_file_found || options.midi_file.empty()) {
+    if (!live_only && (!midi_file_found || options.midi_file.empty())) {
         std::cerr << "Error: No MIDI file specified." << std::endl;
         std::cerr << "Usage: " << argv[0] << " [options] <midi_file>" << std::endl;
         exit(-1);
@@ -492,10 +1013,156 @@ CommandLineOptions ParseCommandLineArguments(int argc, char* argv[]) {
     return options;
 }
 
+// Converts --start / --end into the video frame range [start_frame, end_frame); end_frame is -1
+// when rendering to the end of the piece. Reports and returns false when the range is empty.
+static bool ResolveFrameRange(const CommandLineOptions& options, const MidiVideoOutput& midi_output,
+                              int& start_frame, int& end_frame) {
+    const int total_frames = midi_output.GetTotalFrameCount();
+    start_frame = 0;
+    end_frame = -1;
+    if (options.range_start.unit != TimelinePosition::Unit::None) {
+        const double start_time = ResolveTimelinePosition(options.range_start, midi_output);
+        start_frame = std::min(total_frames, midi_output.GetFrameAtTime(start_time));
+    }
+    if (options.range_end.unit != TimelinePosition::Unit::None) {
+        const double end_time = ResolveTimelinePosition(options.range_end, midi_output);
+        end_frame = std::min(total_frames, midi_output.GetFrameAtTime(end_time));
+    }
+    if (start_frame >= (end_frame >= 0 ? end_frame : total_frames)) {
+        std::cerr << "Error: Nothing to render between --start and --end (the piece has " << total_frames
+                  << " frames, " << FormatTime(midi_output.GetTotalDuration()) << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Distributed rendering coordinator: plans fixed-length segments in the shared directory, waits
+// for workers (started with the same options plus --worker) to publish them, then joins the
+// segments and muxes the soundtrack. Only loads the MIDI files, so it needs no GPU or window.
+static int RunDistributedCoordinator(const CommandLineOptions& options, const std::filesystem::path& output_path) {
+    MidiVideoOutput midi_output;
+    if (!midi_output.LoadMidiFiles(options.midi_inputs)) {
+        std::cerr << "Failed to load MIDI file: " << options.midi_file << std::endl;
+        return -1;
+    }
+
+    int start_frame = 0;
+    int end_frame = -1;
+    if (!ResolveFrameRange(options, midi_output, start_frame, end_frame)) {
+        return -1;
+    }
+
+    RenderManifest manifest;
+    manifest.width = options.video_width;
+    manifest.height = options.video_height;
+    manifest.fps = 60;
+    manifest.video_codec = options.video_codec;
+    manifest.start_frame = start_frame;
+    manifest.total_frames = end_frame >= 0 ? end_frame : midi_output.GetTotalFrameCount();
+    manifest.segment_frames = std::max(1, static_cast<int>(std::lround(options.segment_seconds * manifest.fps)));
+
+    DistributedRenderJob job(options.coordinator_directory);
+    RenderManifest existing;
+    if (job.ReadManifest(existing)) {
+        if (!existing.IsCompatibleWith(manifest)) {
+            std::cerr << "Error: " << options.coordinator_directory
+                      << " already holds a different job; use an empty directory" << std::endl;
+            return -1;
+        }
+        std::cout << "Resuming distributed render: " << job.CountPublishedSegments(manifest) << "/"
+                  << manifest.GetSegmentCount() << " segments already finished" << std::endl;
+    } else if (!job.WriteManifest(manifest)) {
+        return -1;
+    }
+
+    std::cout << "Distributed render:" << std::endl;
+    std::cout << "  Shared directory: " << options.coordinator_directory << std::endl;
+    std::cout << "  Frames: " << manifest.start_frame << "-" << manifest.total_frames << " in " << manifest.GetSegmentCount()
+              << " segment(s) of " << manifest.segment_frames << std::endl;
+
+    // The soundtrack is added when joining, so synthesize it while the workers render.
+    // An audio file is trimmed to the range start; the synth renders only the range
+    std::string audio_path = options.audio_file;
+    std::string synthesized_audio_path;
+    double audio_start_seconds = manifest.fps > 0 ? static_cast<double>(manifest.start_frame) / manifest.fps : 0.0;
+    if (audio_path.empty() && options.synth_audio) {
+        VideoOutputSettings synth_settings = midi_output.GetVideoSettings();
+        synth_settings.synth_max_voices = options.synth_voices;
+        synth_settings.start_frame = start_frame;
+        synth_settings.end_frame = end_frame;
+        midi_output.SetVideoSettings(synth_settings);
+        synthesized_audio_path = output_path.string() + ".synth.wav";
+        if (!midi_output.SynthesizeAudio(synthesized_audio_path)) {
+            return -1;
+        }
+        audio_path = synthesized_audio_path;
+        audio_start_seconds = 0.0;
+    }
+
+    int reported = -1;
+    while (true) {
+        if (g_should_exit.load()) {
+            std::cout << "Coordinator stopped. Finished segments are kept; run it again to resume." << std::endl;
+            return -1;
+        }
+        job.ReleaseStaleClaims(manifest, options.segment_timeout);
+        const int published = job.CountPublishedSegments(manifest);
+        if (published != reported) {
+            std::cout << "Segments finished: " << published << "/" << manifest.GetSegmentCount() << std::endl;
+            reported = published;
+        }
+        if (published == manifest.GetSegmentCount()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    const std::string output_file = output_path.string() + ".mp4";
+    const bool joined = job.Concatenate(manifest, options.ffmpeg_path, output_file, audio_path, audio_start_seconds,
+                                        midi_output.GetVideoSettings().audio_bitrate);
+    if (!synthesized_audio_path.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(synthesized_audio_path, ec);
+    }
+    if (!joined) {
+        return -1;
+    }
+    std::cout << "Video saved to: " << output_file << std::endl;
+    return 0;
+}
+
 static int RunApplication(int argc, char* argv[]) {
     // Parse command line arguments
     CommandLineOptions options = ParseCommandLineArguments(argc, argv);
 
+    // Pin the render thread and reserve CPUs before any worker thread exists
+    ThreadPlacement placement;
+    placement.render_cpus = options.render_cpus;
+    placement.background_cpus = options.background_cpus;
+    placement.encoder_cpus = options.encoder_cpus;
+    ConfigureThreadPlacement(placement);
+#ifdef _WIN32
+    if (!options.encoder_cpus.empty()) {
+        std::cerr << "Warning: --encoder-cpus is not supported on Windows; FFmpeg will use the process affinity" << std::endl;
+    }
+#endif
+
+    // Every subsystem schedules onto one shared pool, sized before its first use
+    unsigned int thread_count = options.thread_count;
+    const bool partitioned = !options.render_cpus.empty() || !options.background_cpus.empty() ||
+                             !options.encoder_cpus.empty();
+    if (thread_count == 0 && partitioned) {
+        // One worker per background CPU, plus the main thread which helps while it waits
+        thread_count = static_cast<unsigned int>(GetBackgroundThreadCpus().size()) + 1;
+    }
+    TaskSystem::Configure(thread_count);
+    std::cout << "Task system: " << TaskSystem::Instance().GetThreadCount() << " thread(s)" << std::endl;
+
+    // Decode the background image on a worker thread while the window and MIDI files load
+    if (!options.background_image.empty()) {
+        BackgroundImageCache::Instance().Request(options.background_image);
+    }
+
 #ifdef _WIN32
     SetConsoleCtrlHandler(ConsoleCtrlHandler, TRUE);
 #else
@@ -522,12 +1189,30 @@ static int RunApplication(int argc, char* argv[]) {
     } else if (!renderer_lower.empty() && renderer_lower != "opengl") {
         std::cerr << "Warning: Unknown renderer '" << options.renderer << "'. Falling back to OpenGL." << std::endl;
     }
+    if (options.realtime && renderer_type != RendererType::OpenGL) {
+        std::cerr << "Error: --realtime needs the OpenGL renderer; the other backends cannot present to a window yet." << std::endl;
+        return -1;
+    }
     
-    std::cout << "Loading MIDI file: " << options.midi_file << std::endl;
+    if (!options.midi_inputs.empty()) {
+        std::cout << "Loading MIDI file: " << options.midi_file << std::endl;
+    }
+    if (!options.live_midi_source.empty()) {
+        std::cout << "Live MIDI input: " << options.live_midi_source << std::endl;
+    }
+    if (options.midi_inputs.size() > 1) {
+        std::cout << "Merged MIDI files: " << options.midi_inputs.size() << std::endl;
+    }
     std::cout << "Video codec: " << options.video_codec << std::endl;
     std::cout << "Debug mode: " << (options.debug_mode ? "enabled" : "disabled") << std::endl;
     std::cout << "Preview window: " << (options.show_preview ? "enabled (1280x720)" : "disabled") << std::endl;
+    if (options.realtime) {
+        std::cout << "Mode: realtime playback (no video file is written)" << std::endl;
+    }
     std::cout << "Video resolution: " << options.video_width << "x" << options.video_height << std::endl;
+    if (options.render_scale != 1.0f) {
+        std::cout << "Render scale: " << options.render_scale << "x" << std::endl;
+    }
     std::cout << "Rate control: " << (options.use_cbr ? "CBR" : "VBR") << std::endl;
     std::cout << "Target bitrate: " << options.video_bitrate << " bps" << std::endl;
     std::cout << "Blip color mode: " << ColorModeToString(options.color_mode) << std::endl;
@@ -551,7 +1236,13 @@ static int RunApplication(int argc, char* argv[]) {
     // Create output path
     std::filesystem::path output_path = output_dir / (midi_name + "_output");
     
-    std::cout << "Output will be saved to: " << output_path.string() << ".mp4" << std::endl;
+    if (!options.realtime) {
+        std::cout << "Output will be saved to: " << output_path.string() << ".mp4" << std::endl;
+    }
+
+    if (!options.coordinator_directory.empty()) {
+        return RunDistributedCoordinator(options, output_path);
+    }
 
     // Set GLFW error callback
     glfwSetErrorCallback(error_callback);
@@ -565,6 +1256,12 @@ static int RunApplication(int argc, char* argv[]) {
     const int video_width = options.video_width;
     const int video_height = options.video_height;
 
+    // Draft renders draw below the video resolution, supersampled renders above it; the frame is
+    // resampled to the video resolution on the GPU before readback, so timing and layout match.
+    // Backends without render scaling are created at the video resolution and reset this below
+    int render_width = std::max(1, static_cast<int>(std::lround(video_width * options.render_scale)));
+    int render_height = std::max(1, static_cast<int>(std::lround(video_height * options.render_scale)));
+
     GLFWwindow* window = nullptr;
     GLFWwindow* preview_window = nullptr;
     g_opengl_renderer = nullptr;
@@ -582,6 +1279,14 @@ static int RunApplication(int argc, char* argv[]) {
         glfwWindowHint(GLFW_FOCUSED, GLFW_FALSE);
         glfwWindowHint(GLFW_DECORATED, GLFW_FALSE);
         glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_FALSE);
+        if (options.realtime) {
+            // Realtime playback presents straight from this context, so the window itself is the display
+            glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+            glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+            glfwWindowHint(GLFW_FOCUSED, GLFW_TRUE);
+            glfwWindowHint(GLFW_DECORATED, GLFW_TRUE);
+            glfwWindowHint(GLFW_DOUBLEBUFFER, GLFW_TRUE);
+        }
 
 #ifdef __APPLE__
         glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -607,7 +1312,7 @@ static int RunApplication(int argc, char* argv[]) {
         std::cout << "OpenGL initialized successfully!" << std::endl;
         std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
 
-        if (options.show_preview) {
+        if (options.show_preview && !options.realtime) {
             glfwDefaultWindowHints();
             glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
             glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -632,12 +1337,14 @@ static int RunApplication(int argc, char* argv[]) {
         }
 
         glfwMakeContextCurrent(window);
-        glfwSwapInterval(0);
+        // Realtime playback paces itself on the display's vsync; offline rendering runs flat out
+        glfwSwapInterval(options.realtime ? 1 : 0);
 
         std::cout << "Initializing OpenGL renderer..." << std::endl;
         auto opengl_renderer = std::make_unique<OpenGLRenderer>();
         g_opengl_renderer = opengl_renderer.get();
-        opengl_renderer->Initialize(video_width, video_height);
+        opengl_renderer->Initialize(render_width, render_height);
+        opengl_renderer->SetOutputSize(video_width, video_height);
         g_renderer = std::move(opengl_renderer);
         std::cout << "OpenGL renderer initialized successfully!" << std::endl;
     } else if (renderer_type == RendererType::DirectX12) {
@@ -699,25 +1406,53 @@ static int RunApplication(int argc, char* argv[]) {
         std::cout << "Vulkan renderer initialized successfully!" << std::endl;
     }
 
+    if (options.render_scale != 1.0f && !g_renderer->SupportsRenderScale()) {
+        std::cout << "Render scaling is not supported by the " << g_renderer->GetName()
+                  << " renderer. Rendering at the video resolution." << std::endl;
+        options.render_scale = 1.0f;
+        render_width = video_width;
+        render_height = video_height;
+    }
+
     // Initialize piano keyboard
     std::cout << "Initializing piano keyboard..." << std::endl;
-    g_piano_keyboard = std::make_unique<PianoKeyboard>();
-    g_piano_keyboard->Initialize();
-    g_piano_keyboard->UpdateLayout(video_width, video_height);
+    // Stacked keyboards each get an equal horizontal band of the frame
+    std::vector<PianoKeyboard*> keyboards;
+    const float keyboard_band_height = static_cast<float>(render_height) / static_cast<float>(options.keyboard_count);
+    for (int index = 0; index < options.keyboard_count; ++index) {
+        auto keyboard = std::make_unique<PianoKeyboard>();
+        keyboard->Initialize();
+        if (options.keyboard_count > 1) {
+            keyboard->SetLayoutRegion(keyboard_band_height * static_cast<float>(index), keyboard_band_height);
+        }
+        keyboard->UpdateLayout(render_width, render_height);
+        keyboard->SetBlipMode(options.blip_mode);
+        keyboards.push_back(keyboard.get());
+        g_piano_keyboards.push_back(std::move(keyboard));
+    }
     std::cout << "Piano keyboard initialized successfully!" << std::endl;
 
     // Initialize MIDI video output
     std::cout << "Initializing MIDI video output..." << std::endl;
     g_midi_video_output = std::make_unique<MidiVideoOutput>();
-    if (!g_midi_video_output->Initialize(g_piano_keyboard.get(), g_renderer.get())) {
+    if (!g_midi_video_output->Initialize(keyboards.front(), g_renderer.get()) ||
+        !g_midi_video_output->SetKeyboards(keyboards)) {
         std::cerr << "Failed to initialize MIDI video output" << std::endl;
         return -1;
     }
     std::cout << "MIDI video output initialized successfully!" << std::endl;
 
-    // Load MIDI file from command line argument
-    std::cout << "Attempting to load MIDI file: " << options.midi_file << std::endl;
-    if (!g_midi_video_output->LoadMidiFile(options.midi_file)) {
+    // Load MIDI file from command line argument (live input alone needs none)
+    if (!options.midi_inputs.empty()) {
+        std::cout << "Attempting to load MIDI file: " << options.midi_file << std::endl;
+    }
+    // Turn the note stats overlay on and pick the keyboard split before loading, so the load tasks
+    // build the stats timeline and the seek checkpoints for the final layout
+    auto load_settings = g_midi_video_output->GetVideoSettings();
+    load_settings.show_note_stats = options.note_stats;
+    load_settings.keyboard_split = options.keyboard_split;
+    g_midi_video_output->SetVideoSettings(load_settings);
+    if (!options.midi_inputs.empty() && !g_midi_video_output->LoadMidiFiles(options.midi_inputs)) {
         std::cerr << "Failed to load MIDI file: " << options.midi_file << std::endl;
         std::cerr << "Please check if the file exists and is a valid MIDI file." << std::endl;
         return -1;
@@ -749,167 +1484,535 @@ static int RunApplication(int argc, char* argv[]) {
     video_settings.output_path = output_path.string(); // Use the calculated output path
     video_settings.video_codec = options.video_codec; // Use command line specified codec
     video_settings.show_debug_info = options.debug_mode; // Enable debug overlay if requested
+    video_settings.show_note_stats = options.note_stats;
     video_settings.color_mode = options.color_mode;
+    video_settings.keyboard_split = options.keyboard_split;
     video_settings.ffmpeg_executable_path = options.ffmpeg_path; // Set custom FFmpeg path if specified
+    video_settings.decode_ahead_seconds = options.decode_ahead_seconds;
+    video_settings.encoder_cpus = GetEncoderCpus();  // --encoder-cpus, or the CPUs not given to --render-cpu
+    video_settings.use_huge_pages = options.huge_pages;
+    if (options.temporal_samples > 1 && !g_renderer->SupportsFrameAccumulation()) {
+        std::cerr << "Warning: --temporal-samples is not supported by the " << g_renderer->GetName()
+                  << " renderer, rendering one sample per frame" << std::endl;
+        options.temporal_samples = 1;
+    }
+    video_settings.temporal_samples = options.temporal_samples;
     if (!options.audio_file.empty()) {
         video_settings.include_audio = true;
         video_settings.audio_file_path = options.audio_file;
     }
+    video_settings.synthesize_audio = options.synth_audio;
+    video_settings.synth_max_voices = options.synth_voices;
+    if (g_midi_video_output->IsMidiLoaded() &&
+        !ResolveFrameRange(options, *g_midi_video_output, video_settings.start_frame, video_settings.end_frame)) {
+        return -1;
+    }
     std::cout << "Configuring video settings:" << std::endl;
     std::cout << "  Resolution: " << video_settings.width << "x" << video_settings.height << std::endl;
     std::cout << "  FPS: " << video_settings.fps << std::endl;
     std::cout << "  Bitrate: " << video_settings.bitrate << " bps" << std::endl;
     std::cout << "  Video codec: " << video_settings.video_codec << std::endl;
     std::cout << "  Debug overlay: " << (video_settings.show_debug_info ? "enabled" : "disabled") << std::endl;
-    std::cout << "  Audio file: " << (video_settings.include_audio ? video_settings.audio_file_path : "(none)") << std::endl;
+    std::cout << "  Note stats overlay: " << (video_settings.show_note_stats ? "enabled" : "disabled") << std::endl;
+    std::cout << "  Audio file: " << (video_settings.include_audio ? video_settings.audio_file_path
+                                                                 : (video_settings.synthesize_audio ? "(built-in synth)" : "(none)")) << std::endl;
     std::cout << "  Output path: " << video_settings.output_path << std::endl;
+    if (video_settings.start_frame > 0 || video_settings.end_frame >= 0) {
+        const int end_frame = video_settings.end_frame >= 0 ? video_settings.end_frame
+                                                            : g_midi_video_output->GetTotalFrameCount();
+        std::cout << "  Range: " << FormatTime(video_settings.start_frame / 60.0) << " - "
+                  << FormatTime(end_frame / 60.0) << " (frames " << video_settings.start_frame << "-"
+                  << end_frame << ")" << std::endl;
+    }
     std::cout << "  Blip color mode: " << ColorModeToString(video_settings.color_mode) << std::endl;
+    std::cout << "  Blip mode: " << (options.blip_mode == BlipMode::Heat ? "heat" : "stacked") << std::endl;
+    std::cout << "  Temporal samples: " << video_settings.temporal_samples << std::endl;
+    if (options.keyboard_count > 1) {
+        std::cout << "  Keyboards: " << options.keyboard_count << " (split by "
+                  << (options.keyboard_split == VideoOutputSettings::KeyboardSplit::Track ? "track" : "channel") << ")" << std::endl;
+    }
+    std::cout << "  Background: " << (options.background_image.empty() ? "(none)" : options.background_image) << std::endl;
     g_midi_video_output->SetVideoSettings(video_settings);
 
-    // Start recording video
-    std::cout << "Starting video output..." << std::endl;
-    if (!g_midi_video_output->StartVideoOutput(video_settings)) {
-        std::cerr << "Failed to start video recording" << std::endl;
-        return -1;
+    // The first frame must already show the background, so finish the decode before rendering
+    if (!options.background_image.empty() && !BackgroundImageCache::Instance().Wait(options.background_image)) {
+        std::cerr << "Warning: Background image could not be loaded, using a solid background" << std::endl;
+        options.background_image.clear();
     }
-    std::cout << "Video output started successfully!" << std::endl;
 
-    // Start MIDI playback
-    std::cout << "Starting MIDI playback..." << std::endl;
-    g_midi_video_output->Play();
-    std::cout << "MIDI playback started!" << std::endl;
+    auto render_background = [&]() {
+        if (!options.background_image.empty()) {
+            g_renderer->ClearWithImage(options.background_image, options.background_opacity,
+                                       static_cast<int>(options.background_scale));
+        } else {
+            g_renderer->Clear(Color(0.1f, 0.1f, 0.1f, 1.0f)); // Dark gray background
+        }
+    };
+    auto render_scene = [&]() {
+        render_background();
+        PianoKeyboard::RenderKeyboards(*g_renderer, keyboards.data(), keyboards.size());
+    };
+
+    // Records one video with the given settings: the whole piece, or one segment in worker mode.
+    // Returns false when recording could not be started.
+    auto render_video = [&](const VideoOutputSettings& settings) -> bool {
+        // Start recording video
+        std::cout << "Starting video output..." << std::endl;
+        if (!g_midi_video_output->StartVideoOutput(settings)) {
+            std::cerr << "Failed to start video recording" << std::endl;
+            return false;
+        }
+        std::cout << "Video output started successfully!" << std::endl;
+
+        // Start MIDI playback
+        std::cout << "Starting MIDI playback..." << std::endl;
+        g_midi_video_output->Play();
+        std::cout << "MIDI playback started!" << std::endl;
+
+        // Main render loop for headless video generation
+        double lastFrameTime = glfwGetTime();
+        std::cout << "Starting headless rendering..." << std::endl;
+
+        int frame_counter = 0;
+        int max_frames = static_cast<int>(g_midi_video_output->GetTotalDuration() * 60.0) + 60; // 安全マージン1秒
+        std::cout << "Maximum expected frames: " << max_frames << std::endl;
+
+        while (!glfwWindowShouldClose(window) && frame_counter < max_frames) {
+            if (g_should_exit.load()) {
+                std::cout << "Shutdown signal received. Stopping rendering..." << std::endl;
+                if (g_midi_video_output && g_midi_video_output->IsRecording()) {
+                    g_midi_video_output->StopVideoOutput();
+                }
+                break;
+            }
 
-    // Main render loop for headless video generation
-    double lastFrameTime = glfwGetTime();
-    std::cout << "Starting headless rendering..." << std::endl;
-    
-    int frame_counter = 0;
-    int max_frames = static_cast<int>(g_midi_video_output->GetTotalDuration() * 60.0) + 60; // 安全マージン1秒
-    std::cout << "Maximum expected frames: " << max_frames << std::endl;
-    
-    while (!glfwWindowShouldClose(window) && frame_counter < max_frames) {
-        if (g_should_exit.load()) {
-            std::cout << "Shutdown signal received. Stopping rendering..." << std::endl;
-            if (g_midi_video_output && g_midi_video_output->IsRecording()) {
+            frame_counter++;
+
+            // 定期的な進捗表示
+            if (frame_counter % 1800 == 0) { // 30秒ごと (60fps * 30s)
+                double progress = (double)frame_counter / max_frames * 100.0;
+                std::cout << "Progress: " << progress << "% (Frame " << frame_counter << "/" << max_frames << ")" << std::endl;
+            }
+
+            // Only poll events minimally for headless operation
+            glfwPollEvents();
+
+            if (preview_window && glfwWindowShouldClose(preview_window)) {
+                std::cout << "Preview window closed by user. Continuing headless rendering only." << std::endl;
+                glfwDestroyWindow(preview_window);
+                preview_window = nullptr;
+                glfwMakeContextCurrent(window);
+            }
+
+            // Calculate delta time for consistent frame rate
+            double currentFrameTime = glfwGetTime();
+            double deltaTime = 1.0 / 60.0; // Fixed 60 FPS for consistent video output
+            lastFrameTime = currentFrameTime;
+
+            // Update piano keyboards
+            for (PianoKeyboard* keyboard : keyboards) {
+                keyboard->Update();
+            }
+
+            // Update MIDI video output
+            g_midi_video_output->Update(deltaTime);
+
+            // Check if MIDI playback is finished - more detailed checking
+            bool is_playing = g_midi_video_output->IsPlaying();
+            double current_time = g_midi_video_output->GetCurrentTime();
+            double total_duration = g_midi_video_output->GetTotalDuration();
+
+            // デバッグ: 最初の3フレームのみ
+            if (frame_counter <= 3) {
+                std::cout << "Frame " << frame_counter << " - Time: " << current_time 
+                          << "s, Playing: " << (is_playing ? "true" : "false") << std::endl;
+            }
+
+            if (!is_playing && current_time > 0) {
+                std::cout << "MIDI playback finished." << std::endl;
+                std::cout << "  Current time: " << current_time << " seconds" << std::endl;
+                std::cout << "  Total duration: " << total_duration << " seconds" << std::endl;
+                std::cout << "  Is playing: " << (is_playing ? "true" : "false") << std::endl;
+                std::cout << "Stopping recording..." << std::endl;
                 g_midi_video_output->StopVideoOutput();
+                std::cout << "Video saved to: " << settings.output_path << ".mp4" << std::endl;
+                break;
             }
-            break;
-        }
 
-        frame_counter++;
-        
-        // 定期的な進捗表示
-        if (frame_counter % 1800 == 0) { // 30秒ごと (60fps * 30s)
-            double progress = (double)frame_counter / max_frames * 100.0;
-            std::cout << "Progress: " << progress << "% (Frame " << frame_counter << "/" << max_frames << ")" << std::endl;
-        }
-        
-        // Only poll events minimally for headless operation
-        glfwPollEvents();
+            if (g_midi_video_output->IsPreRolling()) {
+                // Catching up to --start: only advance the notes and keyboard animations so blips
+                // are already in place on the first recorded frame; nothing is drawn or read back
+                for (int sample = 1; sample < options.temporal_samples; ++sample) {
+                    g_midi_video_output->AdvanceSubFrame(sample);
+                    for (PianoKeyboard* keyboard : keyboards) {
+                        keyboard->Update();
+                    }
+                }
+                continue;
+            }
 
-        if (preview_window && glfwWindowShouldClose(preview_window)) {
-            std::cout << "Preview window closed by user. Continuing headless rendering only." << std::endl;
-            glfwDestroyWindow(preview_window);
-            preview_window = nullptr;
-            glfwMakeContextCurrent(window);
-        }
+            // Render to offscreen framebuffer for video output
+            g_renderer->ResetDrawCallCount();
+            g_renderer->BindOffscreenFramebuffer(); // ビデオ解像度のオフスクリーンFBOにバインド
+
+            if (options.temporal_samples > 1) {
+                // Render the keyboard at evenly spaced times inside the frame and average them on the
+                // GPU, so notes that start mid-frame fade in instead of popping; one readback per frame
+                const float sample_weight = 1.0f / static_cast<float>(options.temporal_samples);
+                const bool use_static_layer = g_renderer->SupportsStaticLayer();
+                g_renderer->BeginFrameAccumulation();
+                if (use_static_layer) {
+                    // The background and the white keys are drawn once per frame and copied back for
+                    // the later sub-frames, which only redraw the area around the white keys that move
+                    render_background();
+                    PianoKeyboard::RenderStaticLayer(*g_renderer, keyboards.data(), keyboards.size());
+                    g_renderer->CaptureStaticLayer();
+                }
+                for (int sample = 0; sample < options.temporal_samples; ++sample) {
+                    if (sample > 0) {
+                        g_midi_video_output->AdvanceSubFrame(sample);
+                        for (PianoKeyboard* keyboard : keyboards) {
+                            keyboard->Update();
+                        }
+                    }
+                    if (use_static_layer && sample == 0) {
+                        PianoKeyboard::RenderDynamicLayer(*g_renderer, keyboards.data(), keyboards.size());
+                    } else if (use_static_layer) {
+                        g_renderer->RestoreStaticLayer();
+                        PianoKeyboard::RenderDynamicLayer(*g_renderer, keyboards.data(), keyboards.size(),
+                                                          render_background);
+                    } else {
+                        render_scene();
+                    }
+                    g_renderer->AccumulateFrame(sample_weight);
+                }
+                g_renderer->ResolveAccumulatedFrame();
+            } else {
+                render_scene();
+            }
 
-        // Calculate delta time for consistent frame rate
-        double currentFrameTime = glfwGetTime();
-        double deltaTime = 1.0 / 60.0; // Fixed 60 FPS for consistent video output
-        lastFrameTime = currentFrameTime;
+            // ノート統計とデバッグ情報を描画 (有効な場合)
+            g_midi_video_output->RenderNoteStatsOverlay();
+            g_midi_video_output->RenderDebugOverlay();
 
-        // Update piano keyboard
-        g_piano_keyboard->Update();
+            // Resample to the video resolution when rendering at a different scale
+            g_renderer->ResolveOutputFrame();
 
-        // Update MIDI video output
-        g_midi_video_output->Update(deltaTime);
+            if (g_opengl_renderer) {
+                // Ensure all OpenGL commands are executed before frame capture
+                glFlush();
+                glFinish();
+            }
 
-        // Check if MIDI playback is finished - more detailed checking
-        bool is_playing = g_midi_video_output->IsPlaying();
-        double current_time = g_midi_video_output->GetCurrentTime();
-        double total_duration = g_midi_video_output->GetTotalDuration();
-        
-        // デバッグ: 最初の3フレームのみ
-        if (frame_counter <= 3) {
-            std::cout << "Frame " << frame_counter << " - Time: " << current_time 
-                      << "s, Playing: " << (is_playing ? "true" : "false") << std::endl;
-        }
-        
-        if (!is_playing && current_time > 0) {
-            std::cout << "MIDI playback finished." << std::endl;
-            std::cout << "  Current time: " << current_time << " seconds" << std::endl;
-            std::cout << "  Total duration: " << total_duration << " seconds" << std::endl;
-            std::cout << "  Is playing: " << (is_playing ? "true" : "false") << std::endl;
-            std::cout << "Stopping recording..." << std::endl;
-            g_midi_video_output->StopVideoOutput();
-            std::cout << "Video saved to: " << output_path.string() << ".mp4" << std::endl;
-            break;
+            // フレームバッファのバインドを解除（デフォルトフレームバッファに戻す）
+            g_renderer->UnbindOffscreenFramebuffer();
+
+            if (preview_window && g_opengl_renderer) {
+                glfwMakeContextCurrent(preview_window);
+                int preview_fb_width = PREVIEW_WIDTH;
+                int preview_fb_height = PREVIEW_HEIGHT;
+                glfwGetFramebufferSize(preview_window, &preview_fb_width, &preview_fb_height);
+                glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                g_renderer->RenderOffscreenTextureToScreen(preview_fb_width, preview_fb_height);
+
+                std::vector<std::string> overlay_lines;
+                const auto& preview_settings = g_midi_video_output->GetVideoSettings();
+
+                std::ostringstream ffmpeg_stream;
+                ffmpeg_stream << "FFmpeg: " << preview_settings.video_codec
+                              << " | " << preview_settings.width << "x" << preview_settings.height
+                              << "@" << preview_settings.fps << "fps"
+                              << " | " << std::fixed << std::setprecision(1)
+                              << (preview_settings.bitrate / 1000000.0f) << " Mbps"
+                              << " (" << (preview_settings.use_cbr ? "CBR" : "VBR") << ")";
+                overlay_lines.push_back(ffmpeg_stream.str());
+
+                std::ostringstream audio_stream;
+                if (preview_settings.include_audio && !preview_settings.audio_file_path.empty()) {
+                    std::filesystem::path audio_path(preview_settings.audio_file_path);
+                    audio_stream << "Audio: AAC " << (preview_settings.audio_bitrate / 1000)
+                                 << " kbps (" << audio_path.filename().string() << ")";
+                } else {
+                    audio_stream << "Audio: (none)";
+                }
+                overlay_lines.push_back(audio_stream.str());
+
+                double current_time = g_midi_video_output->GetCurrentTime();
+                double total_duration = g_midi_video_output->GetTotalDuration();
+                std::string total_time_str = total_duration > 0.0 ? FormatTime(total_duration) : "--:--";
+
+                std::ostringstream time_stream;
+                time_stream << "Time: " << FormatTime(current_time) << " / " << total_time_str;
+                overlay_lines.push_back(time_stream.str());
+
+                float progress_ratio = g_midi_video_output->GetProgress();
+                g_renderer->RenderPreviewOverlay(preview_fb_width, preview_fb_height, overlay_lines, progress_ratio);
+
+                glfwSwapBuffers(preview_window);
+                glfwMakeContextCurrent(window);
+            }
         }
+        return true;
+    };
 
-        // Render to offscreen framebuffer for video output
-        g_renderer->ResetDrawCallCount();
-        g_renderer->BindOffscreenFramebuffer(); // ビデオ解像度のオフスクリーンFBOにバインド
-        g_renderer->Clear(Color(0.1f, 0.1f, 0.1f, 1.0f)); // Dark gray background
-        g_piano_keyboard->Render(*g_renderer);
+    // Plays the piece live in the window. Playback time comes from a steady clock rather than a frame
+    // counter, and nothing is read back or encoded. A frame that misses its refresh is never caught up
+    // on: the next frame samples the clock again, so late frames are dropped instead of drifting behind.
+    auto run_realtime = [&]() -> bool {
+        if (options.temporal_samples > 1) {
+            std::cout << "Realtime playback draws one sample per refresh; ignoring --temporal-samples" << std::endl;
+        }
 
-        // デバッグ情報を描画 (デバッグモードが有効な場合)
-        g_midi_video_output->RenderDebugOverlay();
+        double refresh_interval = 1.0 / 60.0;
+        if (const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor())) {
+            if (mode->refreshRate > 0) {
+                refresh_interval = 1.0 / mode->refreshRate;
+            }
+        }
 
-        if (g_opengl_renderer) {
-            // Ensure all OpenGL commands are executed before frame capture
-            glFlush();
-            glFinish();
+        LiveMidiInput live_input;
+        if (!options.live_midi_source.empty() && !live_input.Open(options.live_midi_source)) {
+            return false;
+        }
+        std::vector<LiveMidiEvent> live_events;
+        std::vector<DecodedMidiEvent> live_notes;
+
+        const bool has_file = g_midi_video_output->IsMidiLoaded();
+        const double start_time = video_settings.start_frame / 60.0;
+        if (has_file) {
+            g_midi_video_output->Play();
+            if (start_time > 0.0) {
+                g_midi_video_output->Seek(start_time);
+            }
         }
+        std::cout << "Realtime playback started (display refresh " << std::fixed << std::setprecision(1)
+                  << 1.0 / refresh_interval << " Hz)" << std::defaultfloat << std::endl;
+
+        using Clock = std::chrono::steady_clock;
+        auto to_ms = [](Clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        };
+        const Clock::time_point origin = Clock::now();
+        Clock::time_point window_start = origin;
+        Clock::time_point last_present{};
+        RealtimeFrameStats window_stats;
+        RealtimeFrameStats shown_stats;
+        RealtimeFrameStats total_stats;
+
+        while (!glfwWindowShouldClose(window) && !g_should_exit.load()) {
+            glfwPollEvents();
+
+            // The frame shows the piece as of this instant; everything between it and the previous
+            // frame (including frames that were never drawn) is processed in one step
+            const Clock::time_point frame_start = Clock::now();
+            const double timeline_time = start_time + std::chrono::duration<double>(frame_start - origin).count();
+            if (has_file && g_midi_video_output->IsPlaying()) {
+                g_midi_video_output->UpdateToTime(timeline_time);
+                if (!g_midi_video_output->IsPlaying()) {
+                    std::cout << "MIDI playback finished." << std::endl;
+                    if (!live_input.IsOpen()) {
+                        break;
+                    }
+                }
+            }
+
+            // Live notes are picked up right before drawing, so a note shows on the next refresh
+            // after it arrives. Each keeps its arrival time for the key-press duration.
+            Clock::time_point oldest_live_arrival{};
+            if (live_input.IsOpen()) {
+                live_events.clear();
+                live_notes.clear();
+                live_input.Drain(live_events);
+                for (const LiveMidiEvent& live_event : live_events) {
+                    DecodedMidiEvent note;
+                    note.time_seconds = start_time + std::chrono::duration<double>(live_event.arrival_time - origin).count();
+                    note.source_index = std::numeric_limits<uint16_t>::max();  // Not a file: no --color-offset
+                    note.event_type = live_event.event_type;
+                    note.channel = live_event.channel;
+                    note.data1 = live_event.data1;
+                    note.data2 = live_event.data2;
+                    live_notes.push_back(note);
+                }
+                if (!live_events.empty()) {
+                    oldest_live_arrival = live_events.front().arrival_time;
+                }
+                g_midi_video_output->ProcessLiveEvents(live_notes, timeline_time);
+            }
+
+            for (PianoKeyboard* keyboard : keyboards) {
+                keyboard->Update();
+            }
 
-        // フレームバッファのバインドを解除（デフォルトフレームバッファに戻す）
-        g_renderer->UnbindOffscreenFramebuffer();
+            g_renderer->ResetDrawCallCount();
+            g_renderer->BindOffscreenFramebuffer();
+            render_scene();
+            g_midi_video_output->RenderNoteStatsOverlay();
+            g_renderer->UnbindOffscreenFramebuffer();
 
-        if (preview_window && g_opengl_renderer) {
-            glfwMakeContextCurrent(preview_window);
-            int preview_fb_width = PREVIEW_WIDTH;
-            int preview_fb_height = PREVIEW_HEIGHT;
-            glfwGetFramebufferSize(preview_window, &preview_fb_width, &preview_fb_height);
-            glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
+            int framebuffer_width = video_width;
+            int framebuffer_height = video_height;
+            glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT);
-            g_renderer->RenderOffscreenTextureToScreen(preview_fb_width, preview_fb_height);
+            g_renderer->RenderOffscreenTextureToScreen(framebuffer_width, framebuffer_height);
 
             std::vector<std::string> overlay_lines;
-            const auto& preview_settings = g_midi_video_output->GetVideoSettings();
-
-            std::ostringstream ffmpeg_stream;
-            ffmpeg_stream << "FFmpeg: " << preview_settings.video_codec
-                          << " | " << preview_settings.width << "x" << preview_settings.height
-                          << "@" << preview_settings.fps << "fps"
-                          << " | " << std::fixed << std::setprecision(1)
-                          << (preview_settings.bitrate / 1000000.0f) << " Mbps"
-                          << " (" << (preview_settings.use_cbr ? "CBR" : "VBR") << ")";
-            overlay_lines.push_back(ffmpeg_stream.str());
-
-            std::ostringstream audio_stream;
-            if (preview_settings.include_audio && !preview_settings.audio_file_path.empty()) {
-                std::filesystem::path audio_path(preview_settings.audio_file_path);
-                audio_stream << "Audio: AAC " << (preview_settings.audio_bitrate / 1000)
-                             << " kbps (" << audio_path.filename().string() << ")";
-            } else {
-                audio_stream << "Audio: (none)";
+            std::ostringstream rate_stream;
+            rate_stream << std::fixed << std::setprecision(1) << "Realtime: " << shown_stats.GetFps() << " fps @ "
+                        << 1.0 / refresh_interval << " Hz | dropped " << shown_stats.dropped_frames << " (total "
+                        << total_stats.dropped_frames << ")";
+            overlay_lines.push_back(rate_stream.str());
+            std::ostringstream frame_stream;
+            frame_stream << std::fixed << std::setprecision(2) << "Frame time: " << shown_stats.GetAverageFrameMs()
+                         << " ms avg / " << shown_stats.frame_ms_max << " ms max";
+            overlay_lines.push_back(frame_stream.str());
+            std::ostringstream latency_stream;
+            latency_stream << std::fixed << std::setprecision(2) << "Input to photon: "
+                           << shown_stats.GetAverageLatencyMs() << " ms avg / " << shown_stats.latency_ms_max << " ms max";
+            overlay_lines.push_back(latency_stream.str());
+            if (live_input.IsOpen()) {
+                std::ostringstream live_stream;
+                live_stream << std::fixed << std::setprecision(2) << "Live MIDI: " << live_input.GetReceivedEventCount()
+                            << " notes | arrival to photon " << shown_stats.GetAverageLiveLatencyMs() << " ms avg / "
+                            << shown_stats.live_latency_ms_max << " ms max";
+                overlay_lines.push_back(live_stream.str());
+            }
+            const double total_duration = g_midi_video_output->GetTotalDuration();
+            overlay_lines.push_back("Time: " + FormatTime(has_file ? g_midi_video_output->GetCurrentTime() : timeline_time) +
+                                    " / " + (total_duration > 0.0 ? FormatTime(total_duration) : "--:--"));
+            g_renderer->RenderPreviewOverlay(framebuffer_width, framebuffer_height, overlay_lines,
+                                             g_midi_video_output->GetProgress());
+            const Clock::time_point render_end = Clock::now();
+
+            // Waiting for the swap keeps the driver from queueing frames ahead of the display, so each
+            // frame is at most one refresh old when it is shown
+            glfwSwapBuffers(window);
+            glFinish();
+            const Clock::time_point present = Clock::now();
+
+            // Input to photon is measured from the instant the frame samples to the completed swap;
+            // the monitor's own scan-out delay comes on top of it
+            int dropped = 0;
+            if (last_present != Clock::time_point{}) {
+                const double refreshes = std::chrono::duration<double>(present - last_present).count() / refresh_interval;
+                dropped = std::max(0, static_cast<int>(std::lround(refreshes)) - 1);
+            }
+            last_present = present;
+            window_stats.Add(to_ms(render_end - frame_start), to_ms(present - frame_start), dropped);
+            total_stats.Add(to_ms(render_end - frame_start), to_ms(present - frame_start), dropped);
+            if (oldest_live_arrival != Clock::time_point{}) {
+                window_stats.AddLiveLatency(to_ms(present - oldest_live_arrival));
+                total_stats.AddLiveLatency(to_ms(present - oldest_live_arrival));
             }
-            overlay_lines.push_back(audio_stream.str());
 
-            double current_time = g_midi_video_output->GetCurrentTime();
-            double total_duration = g_midi_video_output->GetTotalDuration();
-            std::string total_time_str = total_duration > 0.0 ? FormatTime(total_duration) : "--:--";
+            if (present - window_start >= std::chrono::seconds(1)) {
+                window_stats.seconds = std::chrono::duration<double>(present - window_start).count();
+                shown_stats = window_stats;
+                window_stats = RealtimeFrameStats();
+                window_start = present;
+            }
+        }
+
+        if (g_midi_video_output->IsPlaying()) {
+            g_midi_video_output->Stop();
+        }
+        total_stats.seconds = std::chrono::duration<double>(Clock::now() - origin).count();
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Realtime summary: " << total_stats.frames << " frames in " << total_stats.seconds << " s ("
+                  << total_stats.GetFps() << " fps), " << total_stats.dropped_frames << " dropped" << std::endl;
+        std::cout << "  Frame time: " << total_stats.GetAverageFrameMs() << " ms avg / "
+                  << total_stats.frame_ms_max << " ms max" << std::endl;
+        std::cout << "  Input to photon: " << total_stats.GetAverageLatencyMs() << " ms avg / "
+                  << total_stats.latency_ms_max << " ms max" << std::endl;
+        if (!options.live_midi_source.empty()) {
+            std::cout << "  Live MIDI: " << live_input.GetReceivedEventCount() << " notes, arrival to photon "
+                      << total_stats.GetAverageLiveLatencyMs() << " ms avg / " << total_stats.live_latency_ms_max
+                      << " ms max" << std::endl;
+        }
+        std::cout << std::defaultfloat;
+        return true;
+    };
+
+    if (options.realtime) {
+        run_realtime();
+    } else if (!options.worker_directory.empty()) {
+        // Distributed rendering worker: claim segments from the shared directory until all are published
+        DistributedRenderJob job(options.worker_directory);
+        RenderManifest manifest;
+        bool waiting_reported = false;
+        while (!job.ReadManifest(manifest)) {
+            if (g_should_exit.load()) {
+                return -1;
+            }
+            if (!waiting_reported) {
+                std::cout << "Waiting for a coordinator manifest in " << options.worker_directory << "..." << std::endl;
+                waiting_reported = true;
+            }
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+
+        RenderManifest local = manifest;
+        local.width = video_settings.width;
+        local.height = video_settings.height;
+        local.fps = video_settings.fps;
+        local.video_codec = video_settings.video_codec;
+        local.start_frame = video_settings.start_frame;
+        local.total_frames = video_settings.end_frame >= 0 ? video_settings.end_frame
+                                                           : g_midi_video_output->GetTotalFrameCount();
+        if (!local.IsCompatibleWith(manifest)) {
+            std::cerr << "Error: This worker's options do not match the coordinator's job (resolution, codec, range or MIDI input differ)" << std::endl;
+            return -1;
+        }
 
-            std::ostringstream time_stream;
-            time_stream << "Time: " << FormatTime(current_time) << " / " << total_time_str;
-            overlay_lines.push_back(time_stream.str());
+        int rendered_segments = 0;
+        while (!g_should_exit.load()) {
+            const int segment = job.ClaimNextSegment(manifest);
+            if (segment < 0) {
+                // Stay around while other workers are busy, in case one of their segments is handed back
+                if (job.CountPublishedSegments(manifest) == manifest.GetSegmentCount()) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::seconds(2));
+                continue;
+            }
 
-            float progress_ratio = g_midi_video_output->GetProgress();
-            g_renderer->RenderPreviewOverlay(preview_fb_width, preview_fb_height, overlay_lines, progress_ratio);
+            // Segments are video only; the coordinator adds the soundtrack when joining them
+            VideoOutputSettings segment_settings = video_settings;
+            segment_settings.output_path = job.GetPartialOutputPath(segment);
+            segment_settings.start_frame = manifest.GetSegmentStartFrame(segment);
+            segment_settings.end_frame = manifest.GetSegmentEndFrame(segment);
+            segment_settings.include_audio = false;
+            segment_settings.audio_file_path.clear();
+            segment_settings.synthesize_audio = false;
+            std::cout << "Rendering segment " << segment << " (frames " << segment_settings.start_frame
+                      << "-" << segment_settings.end_frame << ")" << std::endl;
+
+            g_midi_video_output->SetFrameCapturedCallback([&job, segment](int frame) {
+                if (frame % 60 == 0) {
+                    job.RefreshClaim(segment);
+                }
+            });
+            const bool started = render_video(segment_settings);
+            if (g_midi_video_output->IsRecording()) {
+                g_midi_video_output->StopVideoOutput();
+            }
+            g_midi_video_output->SetFrameCapturedCallback(nullptr);
 
-            glfwSwapBuffers(preview_window);
-            glfwMakeContextCurrent(window);
+            const int expected_frames = segment_settings.end_frame - segment_settings.start_frame;
+            if (started && !g_should_exit.load() && g_midi_video_output->GetLastEncoderExitCode() == 0 &&
+                g_midi_video_output->GetCapturedFrameCount() == expected_frames && job.PublishSegment(segment)) {
+                rendered_segments++;
+                std::cout << "Segment " << segment << " published" << std::endl;
+            } else {
+                std::cerr << "Segment " << segment << " failed (" << g_midi_video_output->GetCapturedFrameCount()
+                          << "/" << expected_frames << " frames), returning it to the queue" << std::endl;
+                job.AbandonSegment(segment);
+            }
         }
+        std::cout << "Worker finished: rendered " << rendered_segments << " segment(s)" << std::endl;
+    } else if (!render_video(video_settings)) {
+        return -1;
     }
 
     if (g_should_exit.load() && g_midi_video_output && g_midi_video_output->IsRecording()) {
@@ -918,7 +2021,7 @@ static int RunApplication(int argc, char* argv[]) {
 
     // Cleanup
     g_midi_video_output.reset();
-    g_piano_keyboard.reset();
+    g_piano_keyboards.clear();
     g_renderer.reset();
 
     if (preview_window) {
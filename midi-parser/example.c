@@ -1,15 +1,48 @@
 #include "midi_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(_MSC_VER)
 #pragma execution_character_set("utf-8")
 #endif
 
 // 使用例とテストプログラム
+
+// --stream: 生のMIDIバイト列（"-" で標準入力）を逐次デコーダーで読み、チャンネルメッセージを表示する
+static int decode_stream(const char* path) {
+    FILE* input = (path[0] == '-' && path[1] == '\0') ? stdin : fopen(path, "rb");
+    if (!input) {
+        printf("Failed to open stream: %s\n", path);
+        return 1;
+    }
+    
+    MidiStreamDecoder decoder;
+    midi_stream_decoder_init(&decoder);
+    MidiEvent event;
+    int eventCount = 0;
+    int byte;
+    while ((byte = fgetc(input)) != EOF) {
+        if (midi_stream_decoder_push(&decoder, (uint8_t)byte, &event)) {
+            printf("Stream event %d: type=0x%02X channel=%u data1=%u data2=%u\n", eventCount + 1,
+                   event.eventType, event.channel, event.data1, event.data2);
+            eventCount++;
+        }
+    }
+    printf("Stream events: %d\n", eventCount);
+    
+    if (input != stdin) {
+        fclose(input);
+    }
+    return 0;
+}
 int main(int argc, char* argv[]) {
+    if (argc == 3 && strcmp(argv[1], "--stream") == 0) {
+        return decode_stream(argv[2]);
+    }
     if (argc != 2) {
         printf("Usage: %s <midi_file>\n", argv[0]);
+        printf("       %s --stream <raw_midi_bytes|->\n", argv[0]);
         return 1;
     }
     
@@ -1,8 +1,22 @@
+// fseeko/ftello と 64bit off_t を -std=c99 でも有効にする
+#if !defined(_WIN32)
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#endif
+
 #include "midi_parser.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <inttypes.h>
+#if !defined(_WIN32)
+#include <sys/types.h>
+#endif
 
 #if defined(_MSC_VER)
 #pragma execution_character_set("utf-8")
@@ -38,6 +52,18 @@ uint32_t midi_read_variable_length(uint8_t** data, size_t* remaining) {
     return value;
 }
 
+// 64bitファイルオフセット
+#if defined(_MSC_VER)
+#define midi_fseek64(file, offset, origin) _fseeki64((file), (offset), (origin))
+#define midi_ftell64(file) ((int64_t)_ftelli64(file))
+#elif defined(_WIN32)
+#define midi_fseek64(file, offset, origin) fseeko64((file), (offset), (origin))
+#define midi_ftell64(file) ((int64_t)ftello64(file))
+#else
+#define midi_fseek64(file, offset, origin) fseeko((file), (off_t)(offset), (origin))
+#define midi_ftell64(file) ((int64_t)ftello(file))
+#endif
+
 // ファイルからMIDIファイルをロード
 MidiParseResult midi_load_file(const char* filename, MidiFile** midiFile) {
     FILE* file = fopen(filename, "rb");
@@ -46,38 +72,43 @@ MidiParseResult midi_load_file(const char* filename, MidiFile** midiFile) {
         return MIDI_PARSE_ERROR_FILE_NOT_FOUND;
     }
     
-    // ファイルサイズを取得
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    // ファイルサイズを取得（longが32bitの環境でも2GBを超えるファイルを扱えるようにする）
+    int64_t fileSize = -1;
+    if (midi_fseek64(file, 0, SEEK_END) == 0) {
+        fileSize = midi_ftell64(file);
+    }
+    midi_fseek64(file, 0, SEEK_SET);
     
     if (fileSize <= 0) {
         fclose(file);
         return MIDI_PARSE_ERROR_CORRUPTED_DATA;
     }
     
+    if ((uint64_t)fileSize > (uint64_t)SIZE_MAX) {
+        fprintf(stderr, "Error: File %s is too large for this platform (%" PRId64 " bytes)\n", filename, fileSize);
+        fclose(file);
+        return MIDI_PARSE_ERROR_MEMORY_ALLOCATION;
+    }
+    
     // データを読み込み
-    uint8_t* data = (uint8_t*)malloc(fileSize);
+    size_t dataSize = (size_t)fileSize;
+    uint8_t* data = (uint8_t*)malloc(dataSize);
     if (!data) {
         fclose(file);
         return MIDI_PARSE_ERROR_MEMORY_ALLOCATION;
     }
     
-    size_t bytesRead = fread(data, 1, fileSize, file);
+    size_t bytesRead = fread(data, 1, dataSize, file);
     fclose(file);
     
-    if (bytesRead != (size_t)fileSize) {
+    if (bytesRead != dataSize) {
         free(data);
         return MIDI_PARSE_ERROR_CORRUPTED_DATA;
     }
     
-    // メモリからパース
-    MidiParseResult result = midi_load_from_memory(data, fileSize, midiFile);
-    
-    // パースに失敗した場合はデータを解放
-    if (result != MIDI_PARSE_SUCCESS) {
-        free(data);
-    }
+    // メモリからパース（midi_load_from_memoryは内部にコピーを持つので、読み込みバッファは常に解放する）
+    MidiParseResult result = midi_load_from_memory(data, dataSize, midiFile);
+    free(data);
     
     return result;
 }
@@ -159,7 +190,7 @@ MidiParseResult midi_load_from_memory(const uint8_t* data, size_t size, MidiFile
     }
     
     // 各トラックをパース
-    uint32_t maxTicks = 0;
+    uint64_t maxTicks = 0;
     for (int i = 0; i < midi->header.numberOfTracks; i++) {
         if (remaining < 8) {
             fprintf(stderr, "Error: Insufficient data for track %d header\n", i);
@@ -231,7 +262,7 @@ MidiParseResult midi_load_from_memory(const uint8_t* data, size_t size, MidiFile
         // このトラックの総ティック数を計算（簡易版）
         uint8_t* trackData = midi->tracks[i].data;
         size_t trackRemaining = midi->tracks[i].size;
-        uint32_t trackTicks = 0;
+        uint64_t trackTicks = 0;
         uint8_t runningStatus = 0;
         
         while (trackRemaining > 0) {
@@ -351,20 +382,17 @@ bool midi_read_next_event(MidiTrack* track, MidiEvent* event) {
     }
     
     // イベントタイプを読み取り
-    uint8_t eventByte = *track->current;
+    const bool hasStatusByte = (*track->current & 0x80) != 0;
+    uint8_t eventByte = midi_apply_running_status(&track->runningStatus, *track->current);
     
-    if (eventByte & 0x80) {
-        // 新しいステータスバイト
-        track->runningStatus = eventByte;
-        track->current++;
-        remaining--;
-    } else if (track->runningStatus == 0) {
+    if (eventByte == 0) {
         // ランニングステータスが設定されていない
         track->ended = true;
         return false;
-    } else {
-        // ランニングステータスを使用
-        eventByte = track->runningStatus;
+    }
+    if (hasStatusByte) {
+        track->current++;
+        remaining--;
     }
     
     event->eventType = (MidiEventType)(eventByte & 0xF0);
@@ -425,29 +453,87 @@ bool midi_read_next_event(MidiTrack* track, MidiEvent* event) {
         }
         
     } else {
-        // チャンネルメッセージ
-        uint8_t msgType = eventByte & 0xF0;
+        // チャンネルメッセージ（プログラムチェンジ、チャンネルプレッシャーは1バイト、それ以外は2バイト）
+        uint8_t length = midi_channel_message_length(eventByte);
         
-        if (msgType == 0xC0 || msgType == 0xD0) {
-            // プログラムチェンジ、チャンネルプレッシャー（1バイト）
-            if (remaining < 1) {
-                track->ended = true;
-                return false;
-            }
-            event->data1 = *track->current++;
-            remaining--;
-        } else {
-            // その他のチャンネルメッセージ（2バイト）
-            if (remaining < 2) {
-                track->ended = true;
-                return false;
-            }
-            event->data1 = *track->current++;
+        if (remaining < length) {
+            track->ended = true;
+            return false;
+        }
+        event->data1 = *track->current++;
+        if (length == 2) {
             event->data2 = *track->current++;
-            remaining -= 2;
         }
+        remaining -= length;
+    }
+    
+    return true;
+}
+
+uint8_t midi_apply_running_status(uint8_t* runningStatus, uint8_t byte) {
+    if (byte & 0x80) {
+        // 新しいステータスバイト
+        *runningStatus = byte;
+        return byte;
+    }
+    // データバイト: ランニングステータスを使用（未設定なら0）
+    return *runningStatus;
+}
+
+uint8_t midi_channel_message_length(uint8_t status) {
+    uint8_t msgType = status & 0xF0;
+    return (msgType == 0xC0 || msgType == 0xD0) ? 1 : 2;
+}
+
+void midi_stream_decoder_init(MidiStreamDecoder* decoder) {
+    if (!decoder) return;
+    memset(decoder, 0, sizeof(MidiStreamDecoder));
+}
+
+bool midi_stream_decoder_push(MidiStreamDecoder* decoder, uint8_t byte, MidiEvent* event) {
+    if (!decoder || !event) {
+        return false;
     }
     
+    if (byte >= 0xF8) {
+        // リアルタイムメッセージ（クロックなど）: どこに挟まっても状態を変えない
+        // （ファイルと違い、ライブ入力の 0xFF はメタイベントではなくシステムリセット）
+        return false;
+    }
+    
+    if (byte >= 0xF0) {
+        // SysEx とシステムコモンはランニングステータスを解除する。続くデータバイトは読み捨てる
+        decoder->runningStatus = 0;
+        decoder->dataCount = 0;
+        decoder->inSysEx = (byte == 0xF0);
+        return false;
+    }
+    
+    if (byte & 0x80) {
+        decoder->inSysEx = false;
+        decoder->dataCount = 0;
+    } else if (decoder->inSysEx) {
+        return false;
+    }
+    
+    uint8_t status = midi_apply_running_status(&decoder->runningStatus, byte);
+    if (status == 0 || (byte & 0x80)) {
+        // ステータスを待っている、またはステータスバイトを受け取っただけ
+        return false;
+    }
+    
+    decoder->data[decoder->dataCount++] = byte;
+    if (decoder->dataCount < midi_channel_message_length(status)) {
+        return false;
+    }
+    
+    // メッセージが揃った。ランニングステータスは残し、次のデータバイトから次のメッセージとする
+    memset(event, 0, sizeof(MidiEvent));
+    event->eventType = (MidiEventType)(status & 0xF0);
+    event->channel = status & 0x0F;
+    event->data1 = decoder->data[0];
+    event->data2 = decoder->dataCount > 1 ? decoder->data[1] : 0;
+    decoder->dataCount = 0;
     return true;
 }
 
@@ -474,7 +560,7 @@ void midi_print_header_info(const MidiFile* midiFile) {
     printf("  Format Type: %u\n", midiFile->header.formatType);
     printf("  Number of Tracks: %u\n", midiFile->header.numberOfTracks);
     printf("  Time Division: %u\n", midiFile->header.timeDivision);
-    printf("  Total Ticks: %u\n", midiFile->totalTicks);
+    printf("  Total Ticks: %" PRIu64 "\n", midiFile->totalTicks);
     
     if (midiFile->header.timeDivision & 0x8000) {
         // SMPTE時間
@@ -495,7 +581,7 @@ void midi_print_track_info(const MidiFile* midiFile, int trackIndex) {
     const MidiTrack* track = &midiFile->tracks[trackIndex];
     printf("Track %d Information:\n", trackIndex);
     printf("  Data Size: %zu bytes\n", track->size);
-    printf("  Current Tick: %u\n", track->currentTick);
+    printf("  Current Tick: %" PRIu64 "\n", track->currentTick);
     printf("  Ended: %s\n", track->ended ? "Yes" : "No");
 }
 
@@ -553,7 +639,7 @@ void midi_print_event_info(const MidiEvent* event) {
 }
 
 // 時間計算ヘルパー関数
-double midi_ticks_to_time(uint32_t ticks, uint32_t division, uint32_t tempo) {
+double midi_ticks_to_time(uint64_t ticks, uint32_t division, uint32_t tempo) {
     if (division & 0x8000) {
         // SMPTE時間
         int framerate = -(int8_t)(division >> 8);
@@ -566,15 +652,15 @@ double midi_ticks_to_time(uint32_t ticks, uint32_t division, uint32_t tempo) {
     }
 }
 
-uint32_t midi_time_to_ticks(double time, uint32_t division, uint32_t tempo) {
+uint64_t midi_time_to_ticks(double time, uint32_t division, uint32_t tempo) {
     if (division & 0x8000) {
         // SMPTE時間
         int framerate = -(int8_t)(division >> 8);
         int ticksPerFrame = division & 0xFF;
-        return (uint32_t)(time * framerate * ticksPerFrame);
+        return (uint64_t)(time * framerate * ticksPerFrame);
     } else {
         // 音楽時間
         double quarterNotes = time * 1000000.0 / tempo;
-        return (uint32_t)(quarterNotes * division);
+        return (uint64_t)(quarterNotes * division);
     }
 }
\ No newline at end of file
@@ -81,18 +81,27 @@ typedef struct {
     uint8_t* data;             // トラックデータの開始位置
     uint8_t* current;          // 現在の読み取り位置
     size_t size;               // トラックデータのサイズ
-    uint32_t currentTick;      // 現在の絶対ティック位置
+    uint64_t currentTick;      // 現在の絶対ティック位置（長尺・高分解能でも溢れないよう64bit）
     uint8_t runningStatus;     // ランニングステータス
     bool ended;                // トラック終了フラグ
 } MidiTrack;
 
+// ライブ入力（生のMIDIバイト列）の逐次デコーダー
+// ファイルのトラックと同じランニングステータスを持ち、届いたバイトを1つずつ渡す
+typedef struct {
+    uint8_t runningStatus;     // ランニングステータス（0 = 未設定。システムコモンで解除される）
+    uint8_t data[2];           // 受信途中のデータバイト
+    uint8_t dataCount;         // 受信済みのデータバイト数
+    bool inSysEx;              // SysEx (F0 ... F7) の途中（データバイトは読み捨てる）
+} MidiStreamDecoder;
+
 // MIDIファイル構造体
 typedef struct {
     MidiHeader header;         // ヘッダー情報
     MidiTrack* tracks;         // トラック配列
     uint8_t* data;             // 全データバッファ
     size_t dataSize;           // データサイズ
-    uint32_t totalTicks;       // 総ティック数
+    uint64_t totalTicks;       // 総ティック数
 } MidiFile;
 
 // パース結果
@@ -118,6 +127,19 @@ void midi_free_file(MidiFile* midiFile);
 bool midi_read_next_event(MidiTrack* track, MidiEvent* event);
 void midi_free_event(MidiEvent* event);
 
+// ランニングステータス（ファイルとライブ入力で共通）
+// ステータスバイトならランニングステータスを更新し、データバイトならランニングステータスを使う。
+// 使うべきステータスを返す（データバイトなのにランニングステータスが未設定なら0）
+uint8_t midi_apply_running_status(uint8_t* runningStatus, uint8_t byte);
+// チャンネルメッセージのデータバイト数（0xC0/0xD0 は1、それ以外は2）
+uint8_t midi_channel_message_length(uint8_t status);
+
+// ライブ入力のデコード（パイプやソケットから届いた生のMIDIバイト列）
+void midi_stream_decoder_init(MidiStreamDecoder* decoder);
+// 1バイト渡し、チャンネルメッセージが揃ったら event に書いて true を返す（deltaTime は常に0）。
+// リアルタイムメッセージ (F8-FF) はメッセージの途中に挟まってもよく、無視される
+bool midi_stream_decoder_push(MidiStreamDecoder* decoder, uint8_t byte, MidiEvent* event);
+
 // ヘルパー関数
 uint32_t midi_read_variable_length(uint8_t** data, size_t* remaining);
 uint16_t midi_swap_uint16(uint16_t val);
@@ -129,8 +151,8 @@ void midi_print_track_info(const MidiFile* midiFile, int trackIndex);
 void midi_print_event_info(const MidiEvent* event);
 
 // 時間計算ヘルパー
-double midi_ticks_to_time(uint32_t ticks, uint32_t division, uint32_t tempo);
-uint32_t midi_time_to_ticks(double time, uint32_t division, uint32_t tempo);
+double midi_ticks_to_time(uint64_t ticks, uint32_t division, uint32_t tempo);
+uint64_t midi_time_to_ticks(double time, uint32_t division, uint32_t tempo);
 
 #ifdef __cplusplus
 }
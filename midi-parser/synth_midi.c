@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// 大きな入力を検証するための合成MIDIファイル生成ツール
+//
+// 使い方: synth_midi <output.mid> [notes] [delta_ticks] [tracks]
+//   notes       : トラックあたりのノート数（既定 16）
+//   delta_ticks : ノート間のデルタタイム（既定 0x0FFFFFFF = VLQ最大値）
+//   tracks      : トラック数（既定 1）
+//
+// 既定値では1トラックの総ティック数が 2^32 を超えるため、
+// 64bitティック累積が正しく動作しているかを確認できる。
+// notes を大きくすれば数百MB〜GB級のファイルも生成できる。
+
+static void write_u32_be(FILE* file, uint32_t value) {
+    uint8_t bytes[4] = {
+        (uint8_t)(value >> 24), (uint8_t)(value >> 16),
+        (uint8_t)(value >> 8), (uint8_t)value
+    };
+    fwrite(bytes, 1, 4, file);
+}
+
+static void write_u16_be(FILE* file, uint16_t value) {
+    uint8_t bytes[2] = { (uint8_t)(value >> 8), (uint8_t)value };
+    fwrite(bytes, 1, 2, file);
+}
+
+// 可変長数値を書き込み、書き込んだバイト数を返す
+static size_t encode_variable_length(uint32_t value, uint8_t* out) {
+    uint8_t buffer[5];
+    size_t count = 0;
+
+    buffer[count++] = value & 0x7F;
+    while ((value >>= 7) != 0) {
+        buffer[count++] = (uint8_t)((value & 0x7F) | 0x80);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        out[i] = buffer[count - 1 - i];
+    }
+    return count;
+}
+
+static int write_track(FILE* file, unsigned long long notes, uint32_t deltaTicks, int trackIndex) {
+    uint8_t deltaBytes[5];
+    size_t deltaLength = encode_variable_length(deltaTicks, deltaBytes);
+    uint8_t zeroDelta[5];
+    size_t zeroLength = encode_variable_length(0, zeroDelta);
+
+    // テンポ(7) + ノートごとに (delta + 3) * 2 (ランニングステータスで2個目は2バイト) + End of Track(4)
+    unsigned long long perNote = (unsigned long long)(zeroLength + 3) + (deltaLength + 2);
+    unsigned long long trackSize = 7 + notes * perNote + (deltaLength + 3);
+    if (trackSize > 0xFFFFFFFFull) {
+        fprintf(stderr, "Error: Track %d would exceed 4 GB chunk size\n", trackIndex);
+        return 0;
+    }
+
+    fwrite("MTrk", 1, 4, file);
+    write_u32_be(file, (uint32_t)trackSize);
+
+    // テンポ: 120 BPM
+    static const uint8_t tempo[] = { 0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20 };
+    fwrite(tempo, 1, sizeof(tempo), file);
+
+    uint8_t status = (uint8_t)(0x90 | (trackIndex & 0x0F));
+    for (unsigned long long i = 0; i < notes; i++) {
+        uint8_t note = (uint8_t)(21 + (i % 88));
+
+        // Note ON (delta 0)
+        fwrite(zeroDelta, 1, zeroLength, file);
+        uint8_t on[3] = { status, note, 100 };
+        fwrite(on, 1, 3, file);
+
+        // Note OFF はベロシティ0のNote ONをランニングステータスで書く
+        fwrite(deltaBytes, 1, deltaLength, file);
+        uint8_t off[2] = { note, 0 };
+        fwrite(off, 1, 2, file);
+    }
+
+    // End of Track
+    fwrite(deltaBytes, 1, deltaLength, file);
+    static const uint8_t endOfTrack[] = { 0xFF, 0x2F, 0x00 };
+    fwrite(endOfTrack, 1, sizeof(endOfTrack), file);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 5) {
+        printf("Usage: %s <output.mid> [notes] [delta_ticks] [tracks]\n", argv[0]);
+        return 1;
+    }
+
+    unsigned long long notes = (argc > 2) ? strtoull(argv[2], NULL, 10) : 16;
+    unsigned long deltaTicks = (argc > 3) ? strtoul(argv[3], NULL, 0) : 0x0FFFFFFFul;
+    int tracks = (argc > 4) ? atoi(argv[4]) : 1;
+
+    if (deltaTicks > 0x0FFFFFFFul) {
+        fprintf(stderr, "Error: delta_ticks must fit in a 28-bit variable length value\n");
+        return 1;
+    }
+    if (tracks < 1 || tracks > 0xFFFF) {
+        fprintf(stderr, "Error: tracks must be between 1 and 65535\n");
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not create %s\n", argv[1]);
+        return 1;
+    }
+
+    fwrite("MThd", 1, 4, file);
+    write_u32_be(file, 6);
+    write_u16_be(file, tracks > 1 ? 1 : 0);
+    write_u16_be(file, (uint16_t)tracks);
+    write_u16_be(file, 960);
+
+    for (int i = 0; i < tracks; i++) {
+        if (!write_track(file, notes, (uint32_t)deltaTicks, i)) {
+            fclose(file);
+            return 1;
+        }
+    }
+
+    fclose(file);
+
+    unsigned long long expectedTicks = (notes + 1) * (unsigned long long)deltaTicks;
+    printf("Wrote %s: %d track(s), %llu notes per track, expected total ticks %llu\n",
+           argv[1], tracks, notes, expectedTicks);
+    return 0;
+}
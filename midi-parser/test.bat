@@ -13,6 +13,13 @@ if %ERRORLEVEL% neq 0 (
     exit /b 1
 )
 
+gcc -Wall -Wextra -std=c99 -O2 -o synth_midi.exe synth_midi.c
+
+if %ERRORLEVEL% neq 0 (
+    echo Build failed!
+    exit /b 1
+)
+
 echo Build successful!
 
 REM テスト用のMIDIファイルがあるかチェック
@@ -33,5 +40,11 @@ if defined TEST_MIDI (
     echo Usage: midi_example.exe ^<midi_file^>
 )
 
+REM 合成入力で64bitティック累積を検証（期待値: 4563402735）
+echo Testing with synthetic long MIDI (^> 2^^32 ticks)...
+synth_midi.exe "%TEMP%\midi_parser_long.mid" 16
+midi_example.exe "%TEMP%\midi_parser_long.mid" | findstr /C:"Total Ticks"
+del /Q "%TEMP%\midi_parser_long.mid" 2>nul
+
 echo === Test completed ===
 pause
\ No newline at end of file
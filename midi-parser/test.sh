@@ -33,4 +33,49 @@ else
     echo "Usage: ./midi_example <midi_file>"
 fi
 
+# 合成入力で64bitティック累積を検証
+# 既定: 1トラック16ノート、デルタ0x0FFFFFFF → 総ティック数が2^32を超える
+echo "Testing with synthetic long MIDI (> 2^32 ticks)..."
+SYNTH_DIR=$(mktemp -d)
+trap 'rm -rf "$SYNTH_DIR"' EXIT
+
+check_total_ticks() {
+    local file="$1"
+    local expected="$2"
+    local actual
+    actual=$(./midi_example "$file" | sed -n 's/^  Total Ticks: //p')
+    if [ "$actual" != "$expected" ]; then
+        echo "FAIL: $file total ticks $actual (expected $expected)"
+        exit 1
+    fi
+    echo "OK: $file total ticks $actual"
+}
+
+./synth_midi "$SYNTH_DIR/long.mid" 16 > /dev/null || exit 1
+check_total_ticks "$SYNTH_DIR/long.mid" $(( 17 * 0x0FFFFFFF ))
+
+# 大量ノート・複数トラックの大きな入力（SYNTH_LARGE_NOTES で増やせる）
+LARGE_NOTES=${SYNTH_LARGE_NOTES:-2000000}
+echo "Testing with synthetic large MIDI ($LARGE_NOTES notes x 4 tracks)..."
+./synth_midi "$SYNTH_DIR/large.mid" "$LARGE_NOTES" 2400 4 > /dev/null || exit 1
+check_total_ticks "$SYNTH_DIR/large.mid" $(( (LARGE_NOTES + 1) * 2400 ))
+
+# ライブ入力の逐次デコード: ランニングステータス、途中に挟まるクロック (F8)、
+# SysEx とシステムコモン (F2) によるランニングステータスの解除
+echo "Testing raw MIDI stream decoding..."
+STREAM_OUTPUT=$(printf '\x90\x3c\x64\x3e\xf8\x64\x40\x00\xf0\x7e\x01\xf7\x3c\x00\xc1\x05\x06\xf2\x10\x20\x80\x3c\x00' | ./midi_example --stream -)
+STREAM_EXPECTED="Stream event 1: type=0x90 channel=0 data1=60 data2=100
+Stream event 2: type=0x90 channel=0 data1=62 data2=100
+Stream event 3: type=0x90 channel=0 data1=64 data2=0
+Stream event 4: type=0xC0 channel=1 data1=5 data2=0
+Stream event 5: type=0xC0 channel=1 data1=6 data2=0
+Stream event 6: type=0x80 channel=0 data1=60 data2=0
+Stream events: 6"
+if [ "$STREAM_OUTPUT" != "$STREAM_EXPECTED" ]; then
+    echo "FAIL: raw MIDI stream decoding"
+    echo "$STREAM_OUTPUT"
+    exit 1
+fi
+echo "OK: raw MIDI stream decoding"
+
 echo "=== Test completed ==="
\ No newline at end of file
@@ -0,0 +1,416 @@
+#include "midi_audio_synth.h"
+#include "task_system.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+namespace {
+
+constexpr float kAttackSeconds = 0.004f;
+constexpr float kSilenceThreshold = 1.0e-3f;  // これ以下に減衰したボイスは破棄
+constexpr double kTwoPi = 6.283185307179586;
+constexpr float kHarmonicGains[MidiAudioSynth::kHarmonics] = { 1.0f, 0.45f, 0.2f };
+
+void WriteU32(std::ofstream& out, uint32_t value) {
+    const char bytes[4] = {
+        static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+        static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF)
+    };
+    out.write(bytes, 4);
+}
+
+void WriteU16(std::ofstream& out, uint16_t value) {
+    const char bytes[2] = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF) };
+    out.write(bytes, 2);
+}
+
+void WriteWavHeader(std::ofstream& out, int sample_rate, uint32_t data_bytes) {
+    const uint16_t channels = 2;
+    const uint16_t bits_per_sample = 16;
+    out.write("RIFF", 4);
+    WriteU32(out, 36 + data_bytes);
+    out.write("WAVE", 4);
+    out.write("fmt ", 4);
+    WriteU32(out, 16);
+    WriteU16(out, 1);  // PCM
+    WriteU16(out, channels);
+    WriteU32(out, static_cast<uint32_t>(sample_rate));
+    WriteU32(out, static_cast<uint32_t>(sample_rate) * channels * bits_per_sample / 8);
+    WriteU16(out, channels * bits_per_sample / 8);
+    WriteU16(out, bits_per_sample);
+    out.write("data", 4);
+    WriteU32(out, data_bytes);
+}
+
+} // namespace
+
+MidiAudioSynth::MidiAudioSynth(const AudioSynthSettings& settings)
+    : settings_(settings)
+{
+    settings_.sample_rate = std::max(8000, settings_.sample_rate);
+    settings_.max_voices = std::max(1, settings_.max_voices);
+    settings_.release_seconds = std::max(0.001f, settings_.release_seconds);
+
+    for (int key = 0; key < kKeyCount; ++key) {
+        key_frequency_[key] = 440.0f * std::pow(2.0f, (key - 69) / 12.0f);
+        const float pan = key / 127.0f;
+        key_pan_left_[key] = std::sqrt(1.0f - pan);
+        key_pan_right_[key] = std::sqrt(pan);
+    }
+}
+
+float MidiAudioSynth::Envelope(const SynthNote& note, double time_seconds) const {
+    const double elapsed = time_seconds - note.start_seconds;
+    if (elapsed < 0.0) {
+        return 0.0f;
+    }
+
+    float level = static_cast<float>(std::exp(-note.decay_rate * std::min(elapsed, note.end_seconds - note.start_seconds)));
+    if (elapsed < kAttackSeconds) {
+        level *= static_cast<float>(elapsed / kAttackSeconds);
+    }
+    if (time_seconds > note.end_seconds) {
+        const double released = time_seconds - note.end_seconds;
+        level *= std::max(0.0f, 1.0f - static_cast<float>(released / settings_.release_seconds));
+    }
+    return level;
+}
+
+void MidiAudioSynth::AccumulateVoices(const size_t* voices, size_t voice_count, double block_start,
+                                      int frame_count, PhasorSum* sums) const {
+    const double sample_period = 1.0 / settings_.sample_rate;
+    const float nyquist = settings_.sample_rate * 0.5f;
+
+    for (size_t v = 0; v < voice_count; ++v) {
+        const SynthNote& note = notes_[voices[v]];
+        const float frequency = key_frequency_[note.key];
+
+        // 位相は開始時刻からの経過時間だけで決まる（ボイスごとの状態を持たない）。
+        // ブロック先頭で e^{iθ} を求め、以降の区間は一定角の回転で進める。
+        const double cycles = (block_start - note.start_seconds) * frequency;
+        const double theta = kTwoPi * (cycles - std::floor(cycles));
+        float c1 = static_cast<float>(std::cos(theta));
+        float s1 = static_cast<float>(std::sin(theta));
+        const double step_angle = kTwoPi * frequency * kSubBlockFrames * sample_period;
+        const float step_c = static_cast<float>(std::cos(step_angle));
+        const float step_s = static_cast<float>(std::sin(step_angle));
+
+        float env0 = Envelope(note, block_start);
+        for (int sub_block = 0; sub_block * kSubBlockFrames < frame_count; ++sub_block) {
+            const int offset = sub_block * kSubBlockFrames;
+            const int count = std::min(kSubBlockFrames, frame_count - offset);
+            const double t1 = block_start + (offset + count) * sample_period;
+            const float env1 = Envelope(note, t1);
+
+            if (env0 > 0.0f || env1 > 0.0f) {
+                const float base = env0 * note.amplitude;
+                const float slope = (env1 - env0) / count * note.amplitude;
+
+                PhasorSum& sum = sums[sub_block * kKeyCount + note.key];
+                float ch = c1;
+                float sh = s1;
+                for (int h = 0; h < kHarmonics; ++h) {
+                    if (frequency * (h + 1) >= nyquist) {
+                        break;
+                    }
+                    const float gain = kHarmonicGains[h];
+                    sum.base_re[h] += base * gain * ch;
+                    sum.base_im[h] += base * gain * sh;
+                    sum.slope_re[h] += slope * gain * ch;
+                    sum.slope_im[h] += slope * gain * sh;
+
+                    // e^{i(h+1)θ} -> e^{i(h+2)θ}
+                    const float next_c = ch * c1 - sh * s1;
+                    const float next_s = ch * s1 + sh * c1;
+                    ch = next_c;
+                    sh = next_s;
+                }
+            }
+
+            env0 = env1;
+            const float next_c = c1 * step_c - s1 * step_s;
+            const float next_s = c1 * step_s + s1 * step_c;
+            c1 = next_c;
+            s1 = next_s;
+        }
+    }
+}
+
+void MidiAudioSynth::SynthesizeBlock(const PhasorSum* sums, int frame_count, float* left, float* right) const {
+    const double sample_period = 1.0 / settings_.sample_rate;
+    std::array<float, kSubBlockFrames> samples;
+
+    for (int sub_block = 0; sub_block * kSubBlockFrames < frame_count; ++sub_block) {
+        const int offset = sub_block * kSubBlockFrames;
+        const int count = std::min(kSubBlockFrames, frame_count - offset);
+
+        for (int key = 0; key < kKeyCount; ++key) {
+            const PhasorSum& sum = sums[sub_block * kKeyCount + key];
+            bool silent = true;
+            for (int h = 0; h < kHarmonics; ++h) {
+                if (sum.base_re[h] != 0.0f || sum.base_im[h] != 0.0f ||
+                    sum.slope_re[h] != 0.0f || sum.slope_im[h] != 0.0f) {
+                    silent = false;
+                    break;
+                }
+            }
+            if (silent) {
+                continue;
+            }
+
+            std::fill(samples.begin(), samples.begin() + count, 0.0f);
+            for (int h = 0; h < kHarmonics; ++h) {
+                // 出力は Im((base + slope * i) * e^{iωi})。回転は複素数の漸化式で進める。
+                const double omega = kTwoPi * key_frequency_[key] * (h + 1) * sample_period;
+                const float rot_c = static_cast<float>(std::cos(omega));
+                const float rot_s = static_cast<float>(std::sin(omega));
+                float zc = 1.0f;
+                float zs = 0.0f;
+                for (int i = 0; i < count; ++i) {
+                    const float re = sum.base_re[h] + sum.slope_re[h] * i;
+                    const float im = sum.base_im[h] + sum.slope_im[h] * i;
+                    samples[i] += re * zs + im * zc;
+                    const float next_c = zc * rot_c - zs * rot_s;
+                    const float next_s = zc * rot_s + zs * rot_c;
+                    zc = next_c;
+                    zs = next_s;
+                }
+            }
+
+            const float gain_left = key_pan_left_[key];
+            const float gain_right = key_pan_right_[key];
+            float* out_left = left + offset;
+            float* out_right = right + offset;
+            for (int i = 0; i < count; ++i) {
+                out_left[i] += samples[i] * gain_left;
+                out_right[i] += samples[i] * gain_right;
+            }
+        }
+    }
+}
+
+bool MidiAudioSynth::Render(const std::vector<MidiDecodeSource>& sources, double start_seconds,
+                            double duration_seconds, const PcmWriter& write) {
+    auto start_clock = std::chrono::steady_clock::now();
+
+    const int sample_rate = settings_.sample_rate;
+    const uint64_t total_frames = static_cast<uint64_t>(std::max(0.0, duration_seconds) * sample_rate);
+    const uint64_t first_frame = std::min(total_frames, static_cast<uint64_t>(std::max(0.0, start_seconds) * sample_rate));
+
+    TaskSystem& tasks = TaskSystem::Instance();
+    unsigned int thread_count = settings_.thread_count > 0
+        ? static_cast<unsigned int>(settings_.thread_count)
+        : tasks.GetThreadCount();
+
+    std::cout << "Synthesizing audio: " << static_cast<double>(total_frames - first_frame) / sample_rate
+              << " seconds, " << thread_count << " thread(s), voice limit " << settings_.max_voices << std::endl;
+
+    // スレッドごとの複素振幅バッファと、合成後のステレオバッファ
+    const size_t sums_per_block = static_cast<size_t>(kSubBlocksPerBlock) * kKeyCount;
+    std::vector<std::vector<PhasorSum>> thread_sums(thread_count, std::vector<PhasorSum>(sums_per_block));
+    std::vector<float> left(kBlockFrames);
+    std::vector<float> right(kBlockFrames);
+    std::vector<int16_t> pcm(static_cast<size_t>(kBlockFrames) * 2);
+
+    // (ソース, チャンネル, ノート) ごとに未解決のノートオンを押された順に保持する。
+    // 先頭位置を進めるだけで取り出し、全部離されたら空に戻す（ノートオフごとの要素の詰め直しをしない）
+    struct OpenNote {
+        size_t slot;
+        uint64_t serial;
+    };
+    struct OpenNotes {
+        std::vector<OpenNote> notes;
+        size_t head = 0;
+    };
+    std::vector<OpenNotes> open_notes(sources.size() * 16 * kKeyCount);
+
+    MidiEventMerger merger;
+    merger.Reset(sources);
+    notes_.clear();
+    free_notes_.clear();
+
+    std::vector<size_t> active;   // notes_ のスロット（開始時刻順）
+    uint64_t note_count = 0;
+    size_t stolen_voices = 0;
+    size_t peak_voices = 0;
+    int last_progress = -1;
+    bool completed = true;
+
+    // ボイスの状態が先頭から合成した場合と同じになるよう、開始位置より前のブロックもノートの出入りだけは処理する。
+    // ブロックの区切りは0秒からの位置に揃える（エンベロープの補間区間も同じになる）
+    for (uint64_t block_frame = 0; block_frame < total_frames; block_frame += kBlockFrames) {
+        const int frame_count = static_cast<int>(std::min<uint64_t>(kBlockFrames, total_frames - block_frame));
+        const double block_start = static_cast<double>(block_frame) / sample_rate;
+        const double block_end = static_cast<double>(block_frame + frame_count) / sample_rate;
+
+        // 終了・減衰しきったボイスを外す（順序は保ったまま詰め、空いたスロットは再利用する）
+        size_t kept = 0;
+        for (size_t slot : active) {
+            const SynthNote& note = notes_[slot];
+            if (note.end_seconds + settings_.release_seconds <= block_start ||
+                (note.start_seconds < block_start && Envelope(note, block_start) < kSilenceThreshold)) {
+                free_notes_.push_back(slot);
+            } else {
+                active[kept++] = slot;
+            }
+        }
+        active.resize(kept);
+
+        // このブロックの終わりより前のイベントだけをマージから取り出す（先読みは1ブロック分）。
+        // ブロックは duration_seconds で終わるので、それ以降に始まるノートは読まない
+        DecodedMidiEvent event;
+        for (const DecodedMidiEvent* next = merger.Peek(); next && next->time_seconds < block_end; next = merger.Peek()) {
+            merger.Next(event);
+            OpenNotes& pending = open_notes[(static_cast<size_t>(event.source_index) * 16 + (event.channel & 0x0F)) * kKeyCount +
+                                            (event.data1 & 0x7F)];
+            if (event.IsNoteOn()) {
+                SynthNote note{};
+                note.start_seconds = event.time_seconds;
+                note.end_seconds = duration_seconds;   // ノートオフが来なければ最後まで鳴らす
+                note.amplitude = (event.data2 / 127.0f) * 0.2f;
+                note.key = event.data1 & 0x7F;
+                note.decay_rate = 0.6f + note.key * 0.04f;
+                note.serial = note_count++;
+
+                size_t slot = notes_.size();
+                if (!free_notes_.empty()) {
+                    slot = free_notes_.back();
+                    free_notes_.pop_back();
+                    notes_[slot] = note;
+                } else {
+                    notes_.push_back(note);
+                }
+                pending.notes.push_back({slot, note.serial});
+                active.push_back(slot);
+            } else if (event.IsNoteOff() && pending.head < pending.notes.size()) {
+                // 重なったノートは先に押されたものから離す（外したボイスのスロットが再利用されていれば何もしない）
+                const OpenNote& open = pending.notes[pending.head++];
+                if (notes_[open.slot].serial == open.serial) {
+                    notes_[open.slot].end_seconds = event.time_seconds;
+                }
+                if (pending.head == pending.notes.size()) {
+                    pending.notes.clear();
+                    pending.head = 0;
+                }
+            }
+        }
+
+        // ボイススティール: 上限を超えたら古いノートから捨てる（active は開始時刻順）
+        if (active.size() > static_cast<size_t>(settings_.max_voices)) {
+            const size_t excess = active.size() - settings_.max_voices;
+            free_notes_.insert(free_notes_.end(), active.begin(), active.begin() + excess);
+            active.erase(active.begin(), active.begin() + excess);
+            stolen_voices += excess;
+        }
+        peak_voices = std::max(peak_voices, active.size());
+
+        if (block_frame + frame_count <= first_frame) {
+            continue;
+        }
+
+        // アクティブボイスを分割数で区切り、タスクシステム上で並列に複素振幅へ足し込む
+        const unsigned int workers = static_cast<unsigned int>(
+            std::min<size_t>(thread_count, std::max<size_t>(1, active.size() / 256)));
+        const size_t per_worker = (active.size() + workers - 1) / workers;
+        tasks.ParallelFor(0, workers, 1, [&](size_t first_worker, size_t last_worker) {
+            for (size_t w = first_worker; w < last_worker; ++w) {
+                std::fill(thread_sums[w].begin(), thread_sums[w].end(), PhasorSum{});
+                const size_t first = std::min(active.size(), w * per_worker);
+                const size_t count = std::min(active.size(), first + per_worker) - first;
+                AccumulateVoices(active.data() + first, count, block_start, frame_count, thread_sums[w].data());
+            }
+        });
+
+        // スレッドごとの振幅を合算し、鍵盤単位で波形を生成
+        PhasorSum* sums = thread_sums[0].data();
+        for (unsigned int w = 1; w < workers; ++w) {
+            const PhasorSum* other = thread_sums[w].data();
+            for (size_t i = 0; i < sums_per_block; ++i) {
+                for (int h = 0; h < kHarmonics; ++h) {
+                    sums[i].base_re[h] += other[i].base_re[h];
+                    sums[i].base_im[h] += other[i].base_im[h];
+                    sums[i].slope_re[h] += other[i].slope_re[h];
+                    sums[i].slope_im[h] += other[i].slope_im[h];
+                }
+            }
+        }
+        std::fill(left.begin(), left.begin() + frame_count, 0.0f);
+        std::fill(right.begin(), right.begin() + frame_count, 0.0f);
+        SynthesizeBlock(sums, frame_count, left.data(), right.data());
+
+        // ソフトクリップして16bitに変換
+        for (int i = 0; i < frame_count; ++i) {
+            float l = left[i] * settings_.master_gain;
+            float r = right[i] * settings_.master_gain;
+            l = l / (1.0f + std::fabs(l));
+            r = r / (1.0f + std::fabs(r));
+            pcm[i * 2] = static_cast<int16_t>(l * 32767.0f);
+            pcm[i * 2 + 1] = static_cast<int16_t>(r * 32767.0f);
+        }
+        // 開始位置を含む最初のブロックは、開始位置より前のサンプルを渡さない
+        const int skip = static_cast<int>(std::max(block_frame, first_frame) - block_frame);
+        if (!write(pcm.data() + skip * 2, static_cast<size_t>(frame_count - skip))) {
+            completed = false;
+            break;
+        }
+
+        int progress = static_cast<int>((block_frame + frame_count - first_frame) * 10 /
+                                        std::max<uint64_t>(1, total_frames - first_frame));
+        if (progress != last_progress) {
+            last_progress = progress;
+            std::cout << "  Audio synthesis: " << progress * 10 << "% (" << active.size() << " voices)" << std::endl;
+        }
+    }
+
+    notes_.clear();
+    notes_.shrink_to_fit();
+    free_notes_.clear();
+    free_notes_.shrink_to_fit();
+    if (!completed) {
+        return false;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_clock).count();
+    std::cout << "Audio synthesis finished in " << elapsed << " seconds (" << note_count << " notes, peak voices "
+              << peak_voices << ", stolen " << stolen_voices << ")" << std::endl;
+    return true;
+}
+
+bool MidiAudioSynth::RenderToWav(const std::vector<MidiDecodeSource>& sources, double start_seconds,
+                                 double duration_seconds, const std::string& wav_path) {
+    std::ofstream out(wav_path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to create synthesized audio file: " << wav_path << std::endl;
+        return false;
+    }
+
+    const int sample_rate = settings_.sample_rate;
+    const uint64_t total_frames = static_cast<uint64_t>(std::max(0.0, duration_seconds) * sample_rate);
+    const uint64_t first_frame = std::min(total_frames, static_cast<uint64_t>(std::max(0.0, start_seconds) * sample_rate));
+    const uint64_t data_bytes = (total_frames - first_frame) * 4;
+    if (data_bytes > 0xFFFFFFFFull - 36) {
+        std::cerr << "Synthesized audio would exceed the 4 GB WAV limit" << std::endl;
+        return false;
+    }
+    WriteWavHeader(out, sample_rate, static_cast<uint32_t>(data_bytes));
+
+    // WAVはリトルエンディアン（対応プラットフォームはすべてリトルエンディアン）
+    const bool rendered = Render(sources, start_seconds, duration_seconds, [&](const int16_t* samples, size_t frame_count) {
+        out.write(reinterpret_cast<const char*>(samples), static_cast<std::streamsize>(frame_count) * 4);
+        return static_cast<bool>(out);
+    });
+
+    out.close();
+    if (!rendered || !out) {
+        std::cerr << "Failed to write synthesized audio file: " << wav_path << std::endl;
+        return false;
+    }
+    return true;
+}
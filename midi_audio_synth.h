@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "midi_event_decoder.h"
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+struct AudioSynthSettings {
+    int sample_rate = 48000;
+    int max_voices = 131072;        // 同時発音数の上限（超えた分は古いボイスから奪う）
+    int thread_count = 0;           // 足し込みの分割数（0 = タスクシステムのスレッド数）
+    float master_gain = 0.25f;
+    float release_seconds = 0.08f;  // ノートオフ後のリリース時間
+};
+
+// 内蔵シンセサイザー
+// 動画と同じマージ済みノートストリームから簡易ピアノ音色（基音 + 倍音の正弦波）のPCMを生成する。
+// ノートは合成中のブロックの終わりまでの分だけマージから取り出し、鳴っているノートだけを保持するので
+// メモリは曲の長さやノート数ではなく同時発音数で決まる。
+//
+// 同じ鍵盤の正弦波の和は1本の正弦波になるため、ボイスはサンプル単位では合成しない。
+// 短い区間（kSubBlockFrames）ごとに各ボイスの位相と音量を鍵盤×倍音ごとの複素振幅に足し込み、
+// 波形の生成は鍵盤単位で1回だけ行う。サンプルあたりのコストが同時発音数に依存しないので
+// ブラックMIDIの10万音以上の同時発音でも実時間より速く処理できる。
+// 足し込みはブロックごとにアクティブなボイスを分割し、TaskSystem 上で並列に行う。
+class MidiAudioSynth {
+public:
+    static constexpr int kBlockFrames = 16384;     // 1ブロックあたりのサンプルフレーム数
+    static constexpr int kSubBlockFrames = 256;    // エンベロープを線形補間する区間
+    static constexpr int kSubBlocksPerBlock = kBlockFrames / kSubBlockFrames;
+    static constexpr int kHarmonics = 3;
+    static constexpr int kKeyCount = 128;
+
+    explicit MidiAudioSynth(const AudioSynthSettings& settings = AudioSynthSettings());
+
+    // 16bitステレオのインターリーブ済みPCMを受け取る。false を返すと合成を中断する。
+    using PcmWriter = std::function<bool(const int16_t* samples, size_t frame_count)>;
+
+    // sources のノートを [start_seconds, duration_seconds) の範囲だけ合成し、ブロックごとに write へ渡す
+    // （先頭が start_seconds。それより前に押されて鳴り続けている音も含む）
+    bool Render(const std::vector<MidiDecodeSource>& sources, double start_seconds, double duration_seconds,
+                const PcmWriter& write);
+    // Render の結果を16bitステレオWAVに書き出す
+    bool RenderToWav(const std::vector<MidiDecodeSource>& sources, double start_seconds, double duration_seconds,
+                     const std::string& wav_path);
+
+private:
+    struct SynthNote {
+        double start_seconds;
+        double end_seconds;
+        float amplitude;    // ベロシティ由来の音量
+        float decay_rate;   // 押鍵中の減衰（1/秒、高音ほど速い）
+        uint8_t key;
+        uint64_t serial;    // 通し番号（再利用されたスロットへの古いノートオフを見分ける）
+    };
+
+    // 1区間・1鍵盤ぶんの複素振幅（区間内の音量は base + slope * i）
+    struct PhasorSum {
+        float base_re[kHarmonics];
+        float base_im[kHarmonics];
+        float slope_re[kHarmonics];
+        float slope_im[kHarmonics];
+    };
+
+    float Envelope(const SynthNote& note, double time_seconds) const;
+    void AccumulateVoices(const size_t* voices, size_t voice_count, double block_start, int frame_count,
+                          PhasorSum* sums) const;
+    void SynthesizeBlock(const PhasorSum* sums, int frame_count, float* left, float* right) const;
+
+    AudioSynthSettings settings_;
+    std::vector<SynthNote> notes_;      // 鳴っているノートのプール（Render 中だけ使う）
+    std::vector<size_t> free_notes_;    // notes_ の空きスロット
+    float key_frequency_[kKeyCount];
+    float key_pan_left_[kKeyCount];
+    float key_pan_right_[kKeyCount];
+};
@@ -0,0 +1,477 @@
+#include "midi_event_decoder.h"
+#include "thread_affinity.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+namespace {
+
+constexpr double kMinReadAheadSeconds = 0.05;
+
+double SegmentTicksToSeconds(uint64_t ticks, uint32_t division, uint32_t tempo) {
+    if (division & 0x8000) {
+        // SMPTE時間（現在は簡易実装）
+        return static_cast<double>(ticks) / 1000.0;
+    }
+    if (division == 0) {
+        return 0.0;
+    }
+    double quarter_notes = static_cast<double>(ticks) / division;
+    return quarter_notes * (tempo / 1000000.0);
+}
+
+} // namespace
+
+void MidiTempoMap::Build(std::vector<TempoChange> changes, uint32_t division) {
+    std::stable_sort(changes.begin(), changes.end(),
+                     [](const TempoChange& a, const TempoChange& b) {
+                         return a.tick < b.tick;
+                     });
+    if (changes.empty() || changes.front().tick > 0) {
+        changes.insert(changes.begin(), TempoChange{0, kDefaultTempo});
+    }
+
+    changes_ = std::move(changes);
+    division_ = division;
+    change_seconds_.assign(changes_.size(), 0.0);
+    for (size_t i = 1; i < changes_.size(); ++i) {
+        uint64_t segment_ticks = changes_[i].tick - changes_[i - 1].tick;
+        change_seconds_[i] = change_seconds_[i - 1] +
+            SegmentTicksToSeconds(segment_ticks, division_, changes_[i - 1].tempo);
+    }
+}
+
+void MidiTempoMap::Clear() {
+    changes_.clear();
+    change_seconds_.clear();
+    division_ = 0;
+}
+
+double MidiTempoMap::TickToSeconds(uint64_t tick) const {
+    if (changes_.empty()) {
+        return SegmentTicksToSeconds(tick, division_, kDefaultTempo);
+    }
+
+    // tick以下で最後のテンポ変更を二分探索
+    auto it = std::upper_bound(changes_.begin(), changes_.end(), tick,
+                               [](uint64_t value, const TempoChange& change) {
+                                   return value < change.tick;
+                               });
+    size_t index = (it == changes_.begin()) ? 0 : static_cast<size_t>(it - changes_.begin()) - 1;
+    const TempoChange& change = changes_[index];
+    return change_seconds_[index] + SegmentTicksToSeconds(tick - change.tick, division_, change.tempo);
+}
+
+void MidiEventMerger::Reset(const std::vector<MidiDecodeSource>& sources) {
+    sources_ = sources;
+
+    size_t total_tracks = 0;
+    for (const auto& source : sources_) {
+        if (source.midi_file) {
+            total_tracks += source.midi_file->header.numberOfTracks;
+        }
+    }
+
+    tracks_.clear();
+    tracks_.reserve(total_tracks);
+    pending_events_ = {};
+    for (size_t source_index = 0; source_index < sources_.size(); ++source_index) {
+        const MidiFile* midi_file = sources_[source_index].midi_file;
+        if (!midi_file || !sources_[source_index].tempo_map) {
+            continue;
+        }
+        for (int i = 0; i < midi_file->header.numberOfTracks; ++i) {
+            StreamingTrackState state;
+            state.events = MidiTrackIterator<MidiEventKind::Notes>(midi_file->tracks[i]);
+            state.source_index = source_index;
+            state.local_track_index = static_cast<uint32_t>(i);
+            tracks_.push_back(state);
+        }
+    }
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        LoadNextTrackEvent(i);
+    }
+}
+
+void MidiEventMerger::Clear() {
+    tracks_.clear();
+    pending_events_ = {};
+    sources_.clear();
+}
+
+bool MidiEventMerger::Next(DecodedMidiEvent& out) {
+    while (!pending_events_.empty()) {
+        PendingEvent next = pending_events_.top();
+        pending_events_.pop();
+
+        auto& state = tracks_[next.track_index];
+        if (!state.has_event) {
+            continue;
+        }
+
+        out = state.next_event;
+        state.has_event = false;
+        LoadNextTrackEvent(next.track_index);
+        return true;
+    }
+    return false;
+}
+
+const DecodedMidiEvent* MidiEventMerger::Peek() const {
+    if (pending_events_.empty()) {
+        return nullptr;
+    }
+    const StreamingTrackState& state = tracks_[pending_events_.top().track_index];
+    return state.has_event ? &state.next_event : nullptr;
+}
+
+bool MidiEventMerger::LoadNextTrackEvent(size_t track_index) {
+    auto& state = tracks_[track_index];
+    state.has_event = false;
+
+    if (state.events.AtEnd()) {
+        return false;
+    }
+
+    const MidiTrackEvent& event = *state.events;
+    const MidiDecodeSource& source = sources_[state.source_index];
+    DecodedMidiEvent& decoded = state.next_event;
+    decoded.tick = event.tick;
+    decoded.time_seconds = source.time_offset_seconds + source.tempo_map->TickToSeconds(decoded.tick);
+    decoded.track_index = state.local_track_index;
+    decoded.global_track_index = static_cast<uint32_t>(track_index);
+    decoded.source_index = static_cast<uint16_t>(state.source_index);
+    decoded.event_type = event.status & 0xF0;
+    decoded.channel = event.channel;
+    decoded.data1 = event.data1;
+    decoded.data2 = event.data2;
+    state.has_event = true;
+    ++state.events;
+
+    pending_events_.push({track_index, decoded.time_seconds, decoded.tick});
+    return true;
+}
+
+void MidiEventStore::Build(const std::vector<MidiDecodeSource>& sources, size_t expected_event_count) {
+    Clear();
+
+    MidiEventMerger merger;
+    merger.Reset(sources);
+    events_.reserve(expected_event_count);
+
+    // マージ結果は時間順なのでソート不要
+    DecodedMidiEvent event;
+    while (merger.Next(event)) {
+        events_.push_back(event);
+    }
+    events_.shrink_to_fit();
+    built_ = true;
+}
+
+void MidiEventStore::Clear() {
+    events_.clear();
+    events_.shrink_to_fit();
+    built_ = false;
+}
+
+DecodedEventRange MidiEventStore::GetEventsInRange(double start_time, double end_time) const {
+    if (events_.empty() || end_time < start_time) {
+        return {};
+    }
+
+    auto first = std::lower_bound(events_.begin(), events_.end(), start_time,
+                                  [](const DecodedMidiEvent& event, double time) {
+                                      return event.time_seconds < time;
+                                  });
+    auto last = std::upper_bound(first, events_.end(), end_time,
+                                 [](double time, const DecodedMidiEvent& event) {
+                                     return time < event.time_seconds;
+                                 });
+    return {events_.data() + (first - events_.begin()), events_.data() + (last - events_.begin())};
+}
+
+DecodedEventRange MidiEventStore::GetAllEvents() const {
+    return {events_.data(), events_.data() + events_.size()};
+}
+
+void MidiNoteStatsTimeline::Build(const std::vector<MidiDecodeSource>& sources, int frames_per_second,
+                                  double duration_seconds) {
+    Clear();
+
+    frames_per_second_ = std::max(1, frames_per_second);
+    const size_t frame_count = static_cast<size_t>(std::max(0.0, duration_seconds) * frames_per_second_) + 1;
+    std::vector<uint32_t> note_counts(frame_count, 0);
+    polyphony_.assign(frame_count, 0);
+
+    // 同時発音数は (ソース, チャンネル, ノート) ごとの重なり数で数える
+    std::vector<uint32_t> active_keys(sources.size() * 16 * 128, 0);
+    uint32_t active_count = 0;
+
+    MidiEventMerger merger;
+    merger.Reset(sources);
+    DecodedMidiEvent event;
+    size_t current_frame = 0;
+    while (merger.Next(event)) {
+        const size_t frame = FrameIndex(event.time_seconds);
+
+        // イベントのないフレームは直前フレーム終了時の同時発音数を引き継ぐ
+        // （マージ順なのでフレーム番号は単調増加する）
+        while (current_frame < frame) {
+            polyphony_[++current_frame] = active_count;
+        }
+
+        const size_t key = (static_cast<size_t>(event.source_index) * 16 + (event.channel & 0x0F)) * 128 +
+                           (event.data1 & 0x7F);
+        if (event.IsNoteOn()) {
+            note_counts[frame]++;
+            active_keys[key]++;
+            active_count++;
+        } else if (event.IsNoteOff() && active_keys[key] > 0) {
+            active_keys[key]--;
+            active_count--;
+        }
+
+        polyphony_[frame] = std::max(polyphony_[frame], active_count);
+    }
+    while (current_frame + 1 < frame_count) {
+        polyphony_[++current_frame] = active_count;
+    }
+
+    note_prefix_.assign(frame_count, 0);
+    uint64_t total = 0;
+    for (size_t frame = 0; frame < frame_count; ++frame) {
+        total += note_counts[frame];
+        note_prefix_[frame] = total;
+    }
+}
+
+void MidiNoteStatsTimeline::Clear() {
+    note_prefix_.clear();
+    note_prefix_.shrink_to_fit();
+    polyphony_.clear();
+    polyphony_.shrink_to_fit();
+}
+
+size_t MidiNoteStatsTimeline::FrameIndex(double time_seconds) const {
+    if (time_seconds <= 0.0 || polyphony_.empty()) {
+        return 0;
+    }
+    const size_t frame = static_cast<size_t>(time_seconds * frames_per_second_);
+    return std::min(frame, polyphony_.size() - 1);
+}
+
+uint64_t MidiNoteStatsTimeline::GetNotesPlayed(double time_seconds) const {
+    if (note_prefix_.empty()) {
+        return 0;
+    }
+    return note_prefix_[FrameIndex(time_seconds)];
+}
+
+uint64_t MidiNoteStatsTimeline::GetNotesPerSecond(double time_seconds) const {
+    if (note_prefix_.empty()) {
+        return 0;
+    }
+    const size_t frame = FrameIndex(time_seconds);
+    const size_t window = static_cast<size_t>(frames_per_second_);
+    const uint64_t window_start = (frame >= window) ? note_prefix_[frame - window] : 0;
+    return note_prefix_[frame] - window_start;
+}
+
+uint32_t MidiNoteStatsTimeline::GetPolyphony(double time_seconds) const {
+    if (polyphony_.empty()) {
+        return 0;
+    }
+    return polyphony_[FrameIndex(time_seconds)];
+}
+
+MidiEventDecoder::MidiEventDecoder()
+    : read_ahead_seconds_(2.0)
+    , playhead_(0.0)
+    , decoded_until_(0.0)
+    , finished_(true)
+    , stop_requested_(false)
+    , current_index_(0)
+{
+}
+
+MidiEventDecoder::~MidiEventDecoder() {
+    Stop();
+}
+
+void MidiEventDecoder::Start(const std::vector<MidiDecodeSource>& sources, double read_ahead_seconds,
+                             double start_time) {
+    Stop();
+
+    if (sources.empty()) {
+        return;
+    }
+
+    // 全ソースのトラックを1つのk-wayマージに載せる
+    merger_.Reset(sources);
+    StartWorker(read_ahead_seconds, start_time);
+}
+
+void MidiEventDecoder::Resume(const MidiEventMerger& merger, double read_ahead_seconds, double start_time) {
+    Stop();
+
+    merger_ = merger;
+    StartWorker(read_ahead_seconds, start_time);
+}
+
+void MidiEventDecoder::StartWorker(double read_ahead_seconds, double start_time) {
+    read_ahead_seconds_ = std::max(kMinReadAheadSeconds, read_ahead_seconds);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        playhead_ = start_time;
+        decoded_until_ = 0.0;
+        finished_ = false;
+        stop_requested_ = false;
+    }
+
+    worker_ = std::thread(&MidiEventDecoder::DecodeLoop, this);
+}
+
+void MidiEventDecoder::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    producer_cv_.notify_all();
+    consumer_cv_.notify_all();
+
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // ブロックは再利用のためフリーリストに戻す
+    while (!ready_blocks_.empty()) {
+        free_blocks_.push_back(std::move(ready_blocks_.front()));
+        ready_blocks_.pop_front();
+    }
+    if (current_block_) {
+        free_blocks_.push_back(std::move(current_block_));
+    }
+    current_index_ = 0;
+    finished_ = true;
+    merger_.Clear();
+}
+
+void MidiEventDecoder::SetPlayhead(double time_seconds) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (time_seconds <= playhead_) {
+            return;
+        }
+        playhead_ = time_seconds;
+    }
+    producer_cv_.notify_one();
+}
+
+const DecodedMidiEvent* MidiEventDecoder::PeekNext(double until_time) {
+    if (current_block_ && current_index_ < current_block_->events.size()) {
+        return &current_block_->events[current_index_];
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (current_block_) {
+        free_blocks_.push_back(std::move(current_block_));
+        current_index_ = 0;
+    }
+
+    // until_time以前のイベントが未デコードの可能性がある間だけ待機する
+    consumer_cv_.wait(lock, [&] {
+        return stop_requested_ || finished_ || !ready_blocks_.empty() || decoded_until_ > until_time;
+    });
+
+    if (ready_blocks_.empty()) {
+        return nullptr;
+    }
+
+    current_block_ = std::move(ready_blocks_.front());
+    ready_blocks_.pop_front();
+    current_index_ = 0;
+    lock.unlock();
+    producer_cv_.notify_one();
+
+    return current_block_->events.empty() ? nullptr : &current_block_->events[0];
+}
+
+void MidiEventDecoder::PopNext() {
+    if (current_block_ && current_index_ < current_block_->events.size()) {
+        current_index_++;
+    }
+}
+
+size_t MidiEventDecoder::GetQueuedBlockCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ready_blocks_.size();
+}
+
+double MidiEventDecoder::GetDecodedUntil() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return decoded_until_;
+}
+
+void MidiEventDecoder::DecodeLoop() {
+    EnterBackgroundThread("midi-decoder");
+    while (true) {
+        std::unique_ptr<DecodedEventBlock> block;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            producer_cv_.wait(lock, [&] {
+                return stop_requested_ ||
+                       (ready_blocks_.size() < kMaxQueuedBlocks && decoded_until_ < playhead_ + read_ahead_seconds_);
+            });
+            if (stop_requested_) {
+                return;
+            }
+            block = AcquireBlock();
+        }
+
+        // ブロックを埋める間はロックを持たない
+        DecodedMidiEvent event;
+        bool end_of_stream = false;
+        while (block->events.size() < kBlockSize) {
+            if (!merger_.Next(event)) {
+                end_of_stream = true;
+                break;
+            }
+            block->events.push_back(event);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!block->events.empty()) {
+                decoded_until_ = block->events.back().time_seconds;
+                ready_blocks_.push_back(std::move(block));
+            } else {
+                free_blocks_.push_back(std::move(block));
+            }
+            if (end_of_stream) {
+                finished_ = true;
+            }
+        }
+        consumer_cv_.notify_all();
+
+        if (end_of_stream) {
+            return;
+        }
+    }
+}
+
+std::unique_ptr<DecodedEventBlock> MidiEventDecoder::AcquireBlock() {
+    std::unique_ptr<DecodedEventBlock> block;
+    if (!free_blocks_.empty()) {
+        block = std::move(free_blocks_.back());
+        free_blocks_.pop_back();
+        block->events.clear();
+    } else {
+        block = std::make_unique<DecodedEventBlock>();
+        block->events.reserve(kBlockSize);
+    }
+    return block;
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "midi_parser.h"
+#include "midi_track_range.h"
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+struct TempoChange {
+    uint64_t tick;          // 変更が発生するティック
+    uint32_t tempo;         // マイクロ秒/四分音符
+};
+
+// テンポマップ（各テンポ変更時点の経過秒数を事前計算し、二分探索で変換する）
+class MidiTempoMap {
+public:
+    static constexpr uint32_t kDefaultTempo = 500000;  // 120 BPM
+
+    void Build(std::vector<TempoChange> changes, uint32_t division);
+    void Clear();
+
+    double TickToSeconds(uint64_t tick) const;
+    const std::vector<TempoChange>& GetChanges() const { return changes_; }
+    uint32_t GetInitialTempo() const { return changes_.empty() ? kDefaultTempo : changes_.front().tempo; }
+
+private:
+    std::vector<TempoChange> changes_;
+    std::vector<double> change_seconds_;  // 各テンポ変更時点の経過秒数
+    uint32_t division_{0};
+};
+
+// デコーダーへの入力（複数MIDIのマージ用）
+struct MidiDecodeSource {
+    const MidiFile* midi_file{nullptr};
+    const MidiTempoMap* tempo_map{nullptr};
+    double time_offset_seconds{0.0};   // このファイルの開始時刻
+};
+
+// デコード済みノートイベント（テンポ変換済み・メタデータなしの軽量形式）
+struct DecodedMidiEvent {
+    double time_seconds{0.0};   // 絶対時間（秒、time_offset_seconds適用済み）
+    uint64_t tick{0};           // MIDI ティック（元ファイル内）
+    uint32_t track_index{0};    // 元トラック番号（元ファイル内。色分けなどファイル単位の用途）
+    uint32_t global_track_index{0};  // 全入力ファイルを通したトラック番号（鍵盤の振り分け用）
+    uint16_t source_index{0};   // 入力ファイル番号
+    uint8_t event_type{0};      // MIDI_EVENT_NOTE_ON / MIDI_EVENT_NOTE_OFF
+    uint8_t channel{0};
+    uint8_t data1{0};           // ノート番号
+    uint8_t data2{0};           // ベロシティ
+
+    bool IsNoteOn() const { return event_type == MIDI_EVENT_NOTE_ON && data2 > 0; }
+    bool IsNoteOff() const {
+        return event_type == MIDI_EVENT_NOTE_OFF || (event_type == MIDI_EVENT_NOTE_ON && data2 == 0);
+    }
+};
+
+// 固定サイズのイベントブロック
+struct DecodedEventBlock {
+    std::vector<DecodedMidiEvent> events;
+};
+
+struct StreamingTrackState {
+    MidiTrackIterator<MidiEventKind::Notes> events{};  // ノートイベントのみをデコード
+    size_t source_index{0};
+    uint32_t local_track_index{0};
+    DecodedMidiEvent next_event{};
+    bool has_event{false};
+};
+
+struct PendingEvent {
+    size_t track_index{0};
+    double time_seconds{0.0};
+    uint64_t tick{0};
+};
+
+struct PendingEventCompare {
+    bool operator()(const PendingEvent& lhs, const PendingEvent& rhs) const {
+        if (lhs.time_seconds == rhs.time_seconds) {
+            if (lhs.tick == rhs.tick) {
+                return lhs.track_index > rhs.track_index;
+            }
+            return lhs.tick > rhs.tick;
+        }
+        return lhs.time_seconds > rhs.time_seconds;
+    }
+};
+
+// 全入力ファイルの全トラックをk-wayマージし、テンポ変換済みのノートイベントを時間順に返す
+// 先読みデコーダーとイベントストアの両方で使う（スレッドセーフではない）
+class MidiEventMerger {
+public:
+    // 各ソースの midi_file / tempo_map は Clear() まで有効である必要がある
+    void Reset(const std::vector<MidiDecodeSource>& sources);
+    void Clear();
+
+    // 次のイベントを取得。終端に達したら false を返す。
+    bool Next(DecodedMidiEvent& out);
+    // 次に Next で返るイベント（取り出さない）。終端なら nullptr。ポインタは次の Next まで有効。
+    const DecodedMidiEvent* Peek() const;
+
+    size_t GetTrackCount() const { return tracks_.size(); }
+
+private:
+    bool LoadNextTrackEvent(size_t track_index);
+
+    std::vector<MidiDecodeSource> sources_;
+    std::vector<StreamingTrackState> tracks_;   // 全ソースのトラックを連結したもの
+    std::priority_queue<PendingEvent, std::vector<PendingEvent>, PendingEventCompare> pending_events_;
+};
+
+// DecodedMidiEvent の連続領域を指す軽量ビュー（コピーなし）
+struct DecodedEventRange {
+    const DecodedMidiEvent* first{nullptr};
+    const DecodedMidiEvent* last{nullptr};
+
+    const DecodedMidiEvent* begin() const { return first; }
+    const DecodedMidiEvent* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    const DecodedMidiEvent& operator[](size_t index) const { return first[index]; }
+};
+
+// デコード済みイベントストア
+// 全ノートイベントを時間順に1つの配列へ展開しておき、時間範囲の問い合わせを
+// 二分探索で O(log n + k) にする。解析ツールやシーク・プレビュー向け。
+class MidiEventStore {
+public:
+    // ソースは Build 中だけ有効であればよい（ストアはイベントをコピーして保持する）
+    void Build(const std::vector<MidiDecodeSource>& sources, size_t expected_event_count = 0);
+    void Clear();
+
+    bool IsBuilt() const { return built_; }
+    size_t GetEventCount() const { return events_.size(); }
+
+    // [start_time, end_time] に含まれるイベント。戻り値は次の Build/Clear まで有効。
+    DecodedEventRange GetEventsInRange(double start_time, double end_time) const;
+    DecodedEventRange GetAllEvents() const;
+
+private:
+    std::vector<DecodedMidiEvent> events_;  // time_seconds 昇順（マージ順そのまま）
+    bool built_{false};
+};
+
+// フレーム単位のノート統計（鍵盤オーバーレイの「演奏済みノート数 / NPS / 同時発音数」用）
+// ノートストリームを1回だけ走査し、フレームごとのノートオン数の累積和と最大同時発音数を保持する。
+// 描画時の問い合わせはすべて O(1)。
+class MidiNoteStatsTimeline {
+public:
+    void Build(const std::vector<MidiDecodeSource>& sources, int frames_per_second, double duration_seconds);
+    void Clear();
+
+    bool IsBuilt() const { return !note_prefix_.empty(); }
+    int GetFramesPerSecond() const { return frames_per_second_; }
+
+    uint64_t GetNotesPlayed(double time_seconds) const;      // time_seconds のフレームまでのノートオン数
+    uint64_t GetNotesPerSecond(double time_seconds) const;   // 直近1秒（fpsフレーム）のスライディングウィンドウ
+    uint32_t GetPolyphony(double time_seconds) const;        // そのフレーム内の最大同時発音数
+
+private:
+    size_t FrameIndex(double time_seconds) const;
+
+    std::vector<uint64_t> note_prefix_;   // note_prefix_[f] = フレーム0〜fのノートオン数の合計
+    std::vector<uint32_t> polyphony_;     // フレームごとの最大同時発音数
+    int frames_per_second_{60};
+};
+
+// 先読みデコーダー
+// 別スレッドで MidiEventMerger を回し、テンポ変換済みのノートイベントを
+// 固定サイズのブロックに詰めて再生位置より read_ahead_seconds 先まで用意する。
+// 描画スレッドは PeekNext/PopNext でブロックを消費するだけになる。
+class MidiEventDecoder {
+public:
+    static constexpr size_t kBlockSize = 4096;        // 1ブロックあたりのイベント数
+    static constexpr size_t kMaxQueuedBlocks = 256;   // 先読みの上限（密集区間でのメモリ制限）
+
+    MidiEventDecoder();
+    ~MidiEventDecoder();
+
+    MidiEventDecoder(const MidiEventDecoder&) = delete;
+    MidiEventDecoder& operator=(const MidiEventDecoder&) = delete;
+
+    // デコードスレッドを開始（既存のスレッドは停止される）
+    // 各ソースの midi_file / tempo_map はStop()まで有効である必要がある
+    void Start(const std::vector<MidiDecodeSource>& sources, double read_ahead_seconds, double start_time = 0.0);
+    // 保存しておいたマージ状態（シーク用チェックポイント）の続きからデコードを開始する
+    // merger が参照するソースは Stop() まで有効である必要がある
+    void Resume(const MidiEventMerger& merger, double read_ahead_seconds, double start_time);
+    void Stop();
+    bool IsRunning() const { return worker_.joinable(); }
+
+    // 再生位置を通知（デコーダーはこの位置 + read_ahead_seconds まで進む）
+    void SetPlayhead(double time_seconds);
+
+    // 次のイベントを取得。until_time までのイベントがまだデコードされていなければ待機する。
+    // 戻り値が nullptr の場合は until_time 以前のイベントが存在しない（または終端）。
+    const DecodedMidiEvent* PeekNext(double until_time);
+    void PopNext();
+
+    // 統計
+    size_t GetQueuedBlockCount() const;
+    double GetDecodedUntil() const;
+
+private:
+    void StartWorker(double read_ahead_seconds, double start_time);
+    void DecodeLoop();
+    std::unique_ptr<DecodedEventBlock> AcquireBlock();
+
+    // デコードスレッド専用の状態
+    MidiEventMerger merger_;
+    double read_ahead_seconds_;
+
+    // スレッド間で共有する状態（mutex_で保護）
+    mutable std::mutex mutex_;
+    std::condition_variable producer_cv_;
+    std::condition_variable consumer_cv_;
+    std::deque<std::unique_ptr<DecodedEventBlock>> ready_blocks_;
+    std::vector<std::unique_ptr<DecodedEventBlock>> free_blocks_;
+    double playhead_;
+    double decoded_until_;
+    bool finished_;
+    bool stop_requested_;
+    std::thread worker_;
+
+    // 消費側（描画スレッド）専用の状態
+    std::unique_ptr<DecodedEventBlock> current_block_;
+    size_t current_index_;
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include "midi_parser.h"
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// MidiTrack を C++ の range として走査するためのヘッダーオンリー実装
+//
+//   for (const MidiTrackEvent& event : ReadTrackEvents<MidiEventKind::Notes | MidiEventKind::Tempo>(track)) {
+//       ...
+//   }
+//
+// midi_read_next_event と違い、メタ/SysEx データを malloc でコピーせず、
+// マスクに含まれないイベントはデコード時にそのまま読み飛ばす。
+// VLQ・ランニングステータスの解釈は呼び出し側にインライン展開される。
+
+namespace MidiEventKind {
+    enum : uint32_t {
+        NoteOn          = 1u << 0,   // ベロシティ > 0 のノートオン
+        NoteOff         = 1u << 1,   // ノートオフ、またはベロシティ0のノートオン
+        PolyPressure    = 1u << 2,
+        ControlChange   = 1u << 3,
+        ProgramChange   = 1u << 4,
+        ChannelPressure = 1u << 5,
+        PitchBend       = 1u << 6,
+        Tempo           = 1u << 7,   // Set Tempo メタイベント（長さ3）
+        Meta            = 1u << 8,   // Set Tempo 以外のメタイベント
+        SysEx           = 1u << 9,
+
+        Notes           = NoteOn | NoteOff,
+        Channel         = NoteOn | NoteOff | PolyPressure | ControlChange | ProgramChange | ChannelPressure | PitchBend,
+        All             = Channel | Tempo | Meta | SysEx
+    };
+}
+
+// デコード済みイベント（payload は MidiTrack のデータを直接指すビュー）
+struct MidiTrackEvent {
+    uint64_t tick{0};               // 絶対ティック
+    uint32_t kind{0};               // MidiEventKind のいずれか1ビット
+    uint8_t status{0};              // ステータスバイト（ランニングステータス適用後）
+    uint8_t channel{0};
+    uint8_t data1{0};
+    uint8_t data2{0};
+    uint8_t meta_type{0};
+    uint32_t tempo{0};              // Tempo の場合のみ有効（マイクロ秒/四分音符）
+    const uint8_t* payload{nullptr};
+    uint32_t payload_length{0};
+
+    bool IsNoteOn() const { return kind == MidiEventKind::NoteOn; }
+    bool IsNoteOff() const { return kind == MidiEventKind::NoteOff; }
+};
+
+template <uint32_t Mask>
+class MidiTrackIterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = MidiTrackEvent;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const MidiTrackEvent*;
+    using reference = const MidiTrackEvent&;
+
+    // 終端イテレータ
+    MidiTrackIterator() = default;
+
+    explicit MidiTrackIterator(const MidiTrack& track)
+        : current_(track.current)
+        , end_(track.data + track.size)
+        , tick_(track.currentTick)
+        , running_status_(track.runningStatus)
+        , ended_(track.ended || !track.current) {
+        Advance();
+    }
+
+    reference operator*() const { return event_; }
+    pointer operator->() const { return &event_; }
+
+    MidiTrackIterator& operator++() {
+        Advance();
+        return *this;
+    }
+
+    void operator++(int) { Advance(); }
+
+    bool AtEnd() const { return ended_; }
+
+    // 終端同士のみ等しい（input iterator として range-for で使う用途）
+    friend bool operator==(const MidiTrackIterator& lhs, const MidiTrackIterator& rhs) {
+        return lhs.ended_ == rhs.ended_ && (lhs.ended_ || lhs.current_ == rhs.current_);
+    }
+    friend bool operator!=(const MidiTrackIterator& lhs, const MidiTrackIterator& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    static inline bool ReadVariableLength(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+        uint32_t result = 0;
+        uint8_t byte;
+        do {
+            if (p == end) {
+                return false;
+            }
+            byte = *p++;
+            result = (result << 7) | (byte & 0x7F);
+        } while (byte & 0x80);
+        value = result;
+        return true;
+    }
+
+    static inline uint32_t ChannelKind(uint8_t status, uint8_t velocity) {
+        switch (status & 0xF0) {
+            case 0x80: return MidiEventKind::NoteOff;
+            case 0x90: return velocity > 0 ? MidiEventKind::NoteOn : MidiEventKind::NoteOff;
+            case 0xA0: return MidiEventKind::PolyPressure;
+            case 0xB0: return MidiEventKind::ControlChange;
+            case 0xC0: return MidiEventKind::ProgramChange;
+            case 0xD0: return MidiEventKind::ChannelPressure;
+            default:   return MidiEventKind::PitchBend;
+        }
+    }
+
+    // マスクに一致する次のイベントまで進める。データ不足・EOT後は終端になる。
+    inline void Advance() {
+        while (!ended_) {
+            if (current_ >= end_) {
+                ended_ = true;
+                return;
+            }
+
+            uint32_t delta = 0;
+            if (!ReadVariableLength(current_, end_, delta) || current_ == end_) {
+                ended_ = true;
+                return;
+            }
+            tick_ += delta;
+
+            uint8_t status = *current_;
+            if (status & 0x80) {
+                running_status_ = status;
+                current_++;
+            } else if (running_status_ == 0) {
+                // ランニングステータスが設定されていない
+                ended_ = true;
+                return;
+            } else {
+                status = running_status_;
+            }
+
+            if (status == 0xFF) {
+                // メタイベント
+                if (current_ == end_) {
+                    ended_ = true;
+                    return;
+                }
+                uint8_t meta_type = *current_++;
+                uint32_t length = 0;
+                if (!ReadVariableLength(current_, end_, length) ||
+                    static_cast<size_t>(end_ - current_) < length) {
+                    ended_ = true;
+                    return;
+                }
+                const uint8_t* payload = current_;
+                current_ += length;
+
+                const bool end_of_track = (meta_type == MIDI_META_END_OF_TRACK);
+                const uint32_t kind = (meta_type == MIDI_META_SET_TEMPO && length == 3)
+                    ? static_cast<uint32_t>(MidiEventKind::Tempo)
+                    : static_cast<uint32_t>(MidiEventKind::Meta);
+
+                if (Mask & kind) {
+                    SetEvent(kind, status, 0, 0);
+                    event_.meta_type = meta_type;
+                    event_.payload = payload;
+                    event_.payload_length = length;
+                    if (kind == MidiEventKind::Tempo) {
+                        event_.tempo = (static_cast<uint32_t>(payload[0]) << 16) |
+                                       (static_cast<uint32_t>(payload[1]) << 8) | payload[2];
+                    }
+                    // EOT はイベントとして返した後、次の Advance で終端にする
+                    if (end_of_track) {
+                        current_ = end_;
+                    }
+                    return;
+                }
+                if (end_of_track) {
+                    ended_ = true;
+                    return;
+                }
+            } else if (status == 0xF0 || status == 0xF7) {
+                // SysEx
+                uint32_t length = 0;
+                if (!ReadVariableLength(current_, end_, length) ||
+                    static_cast<size_t>(end_ - current_) < length) {
+                    ended_ = true;
+                    return;
+                }
+                const uint8_t* payload = current_;
+                current_ += length;
+
+                if (Mask & MidiEventKind::SysEx) {
+                    SetEvent(MidiEventKind::SysEx, status, 0, 0);
+                    event_.payload = payload;
+                    event_.payload_length = length;
+                    return;
+                }
+            } else {
+                // チャンネルメッセージ
+                const uint8_t msg_type = status & 0xF0;
+                const size_t data_size = (msg_type == 0xC0 || msg_type == 0xD0) ? 1 : 2;
+                if (static_cast<size_t>(end_ - current_) < data_size) {
+                    ended_ = true;
+                    return;
+                }
+                const uint8_t data1 = current_[0];
+                const uint8_t data2 = (data_size == 2) ? current_[1] : 0;
+                current_ += data_size;
+
+                const uint32_t kind = ChannelKind(status, data2);
+                if (Mask & kind) {
+                    SetEvent(kind, status, data1, data2);
+                    event_.channel = status & 0x0F;
+                    return;
+                }
+            }
+        }
+    }
+
+    inline void SetEvent(uint32_t kind, uint8_t status, uint8_t data1, uint8_t data2) {
+        event_ = MidiTrackEvent{};
+        event_.tick = tick_;
+        event_.kind = kind;
+        event_.status = status;
+        event_.data1 = data1;
+        event_.data2 = data2;
+    }
+
+    const uint8_t* current_{nullptr};
+    const uint8_t* end_{nullptr};
+    uint64_t tick_{0};
+    uint8_t running_status_{0};
+    bool ended_{true};
+    MidiTrackEvent event_{};
+};
+
+template <uint32_t Mask>
+class MidiTrackRange {
+public:
+    explicit MidiTrackRange(const MidiTrack& track) : track_(track) {}
+
+    MidiTrackIterator<Mask> begin() const { return MidiTrackIterator<Mask>(track_); }
+    MidiTrackIterator<Mask> end() const { return MidiTrackIterator<Mask>(); }
+
+private:
+    MidiTrack track_;  // 走査位置の初期状態（コピーなので元のトラックは変更されない）
+};
+
+template <uint32_t Mask>
+inline MidiTrackRange<Mask> ReadTrackEvents(const MidiTrack& track) {
+    return MidiTrackRange<Mask>(track);
+}
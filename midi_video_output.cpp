@@ -1,4 +1,6 @@
 #include "midi_video_output.h"
+#include "task_system.h"
+#include "thread_affinity.h"
 #include <iostream>
 #include <algorithm>
 #include <array>
@@ -27,7 +29,6 @@
 
 MidiVideoOutput::MidiVideoOutput()
     : playback_state_(MidiPlaybackState::Stopped)
-    , midi_file_(nullptr)
     , current_time_(0.0)
     , total_duration_(0.0)
     , pause_duration_(0.0)
@@ -35,7 +36,6 @@ MidiVideoOutput::MidiVideoOutput()
     , frame_time_(1.0 / 60.0)  // 60FPS = 0.016666...秒/フレーム
     , is_recording_(false)
     , frame_count_(0)
-    , piano_keyboard_(nullptr)
     , renderer_(nullptr)
     , active_notes_(128, false)
     , note_press_times_(128)
@@ -45,7 +45,6 @@ MidiVideoOutput::MidiVideoOutput()
     , total_note_count_(0)
     , processed_event_count_(0)
     , total_event_count_(0)
-    , last_event_tick_(0)
     , ffmpeg_process_(nullptr)
 {
     // パス文字列を初期化
@@ -56,6 +55,8 @@ MidiVideoOutput::MidiVideoOutput()
     strcpy(midi_file_path_, "");
     strcpy(video_output_path_, "output_video");
 #endif
+
+    RebuildBlipPalette();
 }
 
 MidiVideoOutput::~MidiVideoOutput() {
@@ -68,8 +69,8 @@ bool MidiVideoOutput::Initialize(PianoKeyboard* piano_keyboard, RendererBackend*
         return false;
     }
     
-    piano_keyboard_ = piano_keyboard;
     renderer_ = renderer;
+    SetKeyboards({piano_keyboard});
 
     if (renderer_) {
         video_settings_.use_gpu_optimized_capture = renderer_->SupportsAsyncReadback();
@@ -95,28 +96,149 @@ void MidiVideoOutput::Cleanup() {
     
     UnloadMidiFile();
     
-    piano_keyboard_ = nullptr;
+    piano_keyboards_.clear();
     renderer_ = nullptr;
 }
 
+bool MidiVideoOutput::SetKeyboards(const std::vector<PianoKeyboard*>& keyboards) {
+    if (keyboards.empty() || std::find(keyboards.begin(), keyboards.end(), nullptr) != keyboards.end()) {
+        std::cerr << "Error: Invalid piano_keyboard pointer" << std::endl;
+        return false;
+    }
+
+    ReleaseAllKeys();
+    piano_keyboards_ = keyboards;
+    active_notes_.assign(piano_keyboards_.size() * 128, false);
+    note_press_times_.assign(piano_keyboards_.size() * 128, 0.0);
+    // チェックポイントの押下状態は鍵盤の振り分けに依存する
+    if (!sources_.empty()) {
+        BuildSeekCheckpoints(sources_, total_duration_);
+    }
+    return true;
+}
+
+size_t MidiVideoOutput::GetKeyboardIndex(uint8_t channel, size_t global_track_index) const {
+    const size_t keyboard_count = piano_keyboards_.size();
+    if (keyboard_count <= 1) {
+        return 0;
+    }
+    if (video_settings_.keyboard_split == VideoOutputSettings::KeyboardSplit::Track) {
+        // 複数ファイルのマージ時に各ファイルのトラック0が同じ鍵盤へ集まらないよう、通し番号で振り分ける
+        return global_track_index % keyboard_count;
+    }
+    return static_cast<size_t>(channel) % keyboard_count;
+}
+
+void MidiVideoOutput::ApplyNoteState(const DecodedMidiEvent& event, std::vector<bool>& note_state,
+                                     std::vector<double>& note_on_times) const {
+    const int note = event.data1;
+    if (note < 0 || note >= 128 || note_state.empty()) {
+        return;
+    }
+    const size_t slot = GetKeyboardIndex(event.channel, event.global_track_index) * 128 + static_cast<size_t>(note);
+    if (event.IsNoteOn()) {
+        note_state[slot] = true;
+        note_on_times[slot] = event.time_seconds;
+    } else if (event.IsNoteOff()) {
+        note_state[slot] = false;
+    }
+}
+
+void MidiVideoOutput::ReleaseAllKeys() {
+    for (PianoKeyboard* keyboard : piano_keyboards_) {
+        for (int note = 0; note < 128; note++) {
+            keyboard->SetKeyPressed(note, false);
+        }
+    }
+    std::fill(active_notes_.begin(), active_notes_.end(), false);
+}
+
 bool MidiVideoOutput::LoadMidiFile(const std::string& filepath) {
-    std::cout << "Loading MIDI file: " << filepath << std::endl;
+    MidiInputSource input;
+    input.path = filepath;
+    return LoadMidiFiles({input});
+}
+
+bool MidiVideoOutput::LoadMidiFiles(const std::vector<MidiInputSource>& inputs) {
+    if (inputs.empty()) {
+        std::cerr << "No MIDI files specified" << std::endl;
+        return false;
+    }
     
     // 既存のファイルをアンロード
     UnloadMidiFile();
     
-    // MIDIファイルをロード
-    MidiFile* midi_file_raw = nullptr;
-    MidiParseResult result = midi_load_file(filepath.c_str(), &midi_file_raw);
+    std::vector<LoadedMidiSource> sources(inputs.size());
+    std::vector<MidiParseResult> results(inputs.size(), MIDI_PARSE_SUCCESS);
+    
+    // ファイルごとに「ロード → テンポマップと統計情報の作成」をタスクグラフで並べる
+    // （あるファイルの読み込みと別のファイルの走査が重なる。走査自体もトラック単位で並列）
+    TaskGraph load_graph;
+    std::vector<TaskGraph::NodeId> scans;
+    scans.reserve(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::cout << "Loading MIDI file: " << inputs[i].path << std::endl;
+        sources[i].path = inputs[i].path;
+        sources[i].time_offset_seconds = std::max(0.0, inputs[i].time_offset_seconds);
+        sources[i].color_offset = inputs[i].color_offset;
+        
+        TaskGraph::NodeId load = load_graph.AddTask([&, i]() {
+            MidiFile* midi_file_raw = nullptr;
+            results[i] = midi_load_file(inputs[i].path.c_str(), &midi_file_raw);
+            sources[i].file.reset(midi_file_raw);
+        });
+        TaskGraph::NodeId scan = load_graph.AddTask([&, i]() {
+            if (results[i] == MIDI_PARSE_SUCCESS) {
+                BuildTempoMapAndStats(sources[i]);
+            }
+        });
+        load_graph.AddDependency(load, scan);
+        scans.push_back(scan);
+    }
+    // ノート統計オーバーレイのタイムラインは全ファイルの走査が終わってからロード中に作る
+    // （描画時は参照するだけ。ロード後にオーバーレイを有効にした場合は SetVideoSettings で作る）
+    if (video_settings_.show_note_stats) {
+        TaskGraph::NodeId note_stats = load_graph.AddTask([&]() {
+            if (std::all_of(results.begin(), results.end(),
+                            [](MidiParseResult result) { return result == MIDI_PARSE_SUCCESS; })) {
+                BuildNoteStats(sources, CalculateTotalDuration(sources));
+            }
+        });
+        for (TaskGraph::NodeId scan : scans) {
+            load_graph.AddDependency(scan, note_stats);
+        }
+    }
+    // シーク用チェックポイントも同じく全ファイルの走査後に作る
+    // （チェックポイントが指すのは各ソースの MidiFile とテンポマップなので、sources_ へ移した後も有効）
+    TaskGraph::NodeId seek_checkpoints = load_graph.AddTask([&]() {
+        if (std::all_of(results.begin(), results.end(),
+                        [](MidiParseResult result) { return result == MIDI_PARSE_SUCCESS; })) {
+            BuildSeekCheckpoints(sources, CalculateTotalDuration(sources));
+        }
+    });
+    for (TaskGraph::NodeId scan : scans) {
+        load_graph.AddDependency(scan, seek_checkpoints);
+    }
+    load_graph.Run();
     
-    if (result != MIDI_PARSE_SUCCESS) {
-        std::cerr << "Failed to load MIDI file: " << filepath << " (Error: " << static_cast<int>(result) << ")" << std::endl;
-        return false;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (results[i] != MIDI_PARSE_SUCCESS) {
+            std::cerr << "Failed to load MIDI file: " << inputs[i].path << " (Error: " << static_cast<int>(results[i]) << ")" << std::endl;
+            total_note_count_ = 0;
+            total_event_count_ = 0;
+            return false;
+        }
+        
+        const LoadedMidiSource& source = sources[i];
+        total_event_count_ += source.event_count;
+        total_note_count_ += source.note_count;
     }
     
-    midi_file_ = std::unique_ptr<MidiFile>(midi_file_raw);
+    sources_ = std::move(sources);
+    current_tempo_ = sources_.front().tempo_map.GetInitialTempo();
     
     // ファイルパスを保存
+    const std::string& filepath = sources_.front().path;
 #ifdef _WIN32
     strncpy_s(midi_file_path_, sizeof(midi_file_path_), filepath.c_str(), _TRUNCATE);
 #else
@@ -124,19 +246,23 @@ bool MidiVideoOutput::LoadMidiFile(const std::string& filepath) {
     midi_file_path_[sizeof(midi_file_path_) - 1] = '\0';  // null終端を保証
 #endif
     
-    // テンポマップと統計情報を作成
-    BuildTempoMapAndStats();
-    
     // 総再生時間を計算
-    total_duration_ = CalculateTotalDuration();
+    total_duration_ = CalculateTotalDuration(sources_);
     
     // ストリーミング状態を初期化
     ResetStreamingState();
     
     std::cout << "MIDI file loaded successfully:" << std::endl;
-    std::cout << "  Format: " << midi_file_->header.formatType << std::endl;
-    std::cout << "  Tracks: " << midi_file_->header.numberOfTracks << std::endl;
-    std::cout << "  Division: " << midi_file_->header.timeDivision << std::endl;
+    for (size_t i = 0; i < sources_.size(); ++i) {
+        const auto& source = sources_[i];
+        if (sources_.size() > 1) {
+            std::cout << "  [" << i << "] " << source.path
+                      << " (offset " << source.time_offset_seconds << "s, color offset " << source.color_offset << ")" << std::endl;
+        }
+        std::cout << "  Format: " << source.file->header.formatType << std::endl;
+        std::cout << "  Tracks: " << source.file->header.numberOfTracks << std::endl;
+        std::cout << "  Division: " << source.file->header.timeDivision << std::endl;
+    }
     std::cout << "  Duration: " << total_duration_ << " seconds" << std::endl;
     std::cout << "  Total events: " << total_event_count_ << std::endl;
     std::cout << "  Note events: " << total_note_count_ << std::endl;
@@ -147,17 +273,21 @@ bool MidiVideoOutput::LoadMidiFile(const std::string& filepath) {
 void MidiVideoOutput::UnloadMidiFile() {
     Stop();
     
-    if (midi_file_) {
+    if (!sources_.empty()) {
         ClearStreamingResources();
-        midi_file_.reset();
-        tempo_changes_.clear();
+        {
+            std::lock_guard<std::mutex> lock(event_store_mutex_);
+            event_store_.Clear();
+        }
+        note_stats_.Clear();
+        seek_checkpoints_.clear();
+        sources_.clear();
         
         current_time_ = 0.0;
         total_duration_ = 0.0;
         total_note_count_ = 0;
         processed_event_count_ = 0;
         total_event_count_ = 0;
-        last_event_tick_ = 0;
         
         // アクティブノートをクリア
         std::fill(active_notes_.begin(), active_notes_.end(), false);
@@ -167,7 +297,7 @@ void MidiVideoOutput::UnloadMidiFile() {
 }
 
 bool MidiVideoOutput::IsMidiLoaded() const {
-    return midi_file_ != nullptr;
+    return !sources_.empty();
 }
 
 void MidiVideoOutput::Play() {
@@ -212,15 +342,8 @@ void MidiVideoOutput::Stop() {
     current_time_ = 0.0;
     processed_event_count_ = 0;
     
-    // すべてのキーをリリース
-    if (piano_keyboard_) {
-        for (int note = 0; note < 128; note++) {
-            piano_keyboard_->SetKeyPressed(note, false);
-        }
-    }
-    
-    // アクティブノートをクリア
-    std::fill(active_notes_.begin(), active_notes_.end(), false);
+    // すべてのキーをリリースしてアクティブノートをクリア
+    ReleaseAllKeys();
     
     ResetStreamingState();
     
@@ -233,77 +356,56 @@ void MidiVideoOutput::Seek(double time_seconds) {
     }
     
     time_seconds = std::max(0.0, std::min(time_seconds, total_duration_));
-    ResetStreamingState();
 
     // すべてのキーをリリース
-    if (piano_keyboard_) {
-        for (int note = 0; note < 128; note++) {
-            piano_keyboard_->SetKeyPressed(note, false);
-        }
-    }
-
-    std::fill(active_notes_.begin(), active_notes_.end(), false);
-
-    std::array<bool, 128> note_state{};
-    processed_event_count_ = 0;
-
-    while (!pending_events_.empty()) {
-        PendingEvent next = pending_events_.top();
-        if (next.time_seconds > time_seconds + kTimeEpsilon) {
-            break;
-        }
-
-        size_t track_index = next.track_index;
-        pending_events_.pop();
+    ReleaseAllKeys();
 
-        if (track_index >= streaming_tracks_.size()) {
-            continue;
-        }
+    std::vector<bool> note_state(active_notes_.size(), false);
+    std::vector<double> note_on_times(active_notes_.size(), 0.0);
 
-        auto& track_state = streaming_tracks_[track_index];
-        if (!track_state.has_event || std::fabs(track_state.event_time - next.time_seconds) > kTimeEpsilon) {
-            continue;
+    // 目標時刻より前で最後のチェックポイントからデコードを再開する（なければ先頭から）
+    auto checkpoint = std::upper_bound(seek_checkpoints_.begin(), seek_checkpoints_.end(), time_seconds,
+                                       [](double time, const SeekCheckpoint& entry) {
+                                           return time < entry.time_seconds;
+                                       });
+    if (checkpoint == seek_checkpoints_.begin()) {
+        ResetStreamingState();
+    } else {
+        --checkpoint;
+        ClearStreamingResources();
+        event_decoder_.Resume(checkpoint->merger, video_settings_.decode_ahead_seconds, checkpoint->time_seconds);
+        processed_event_count_ = checkpoint->event_count;
+        for (const HeldKey& key : checkpoint->held_keys) {
+            if (key.slot < note_state.size()) {
+                note_state[key.slot] = true;
+                note_on_times[key.slot] = key.press_time;
+            }
         }
+    }
 
-        const MidiEvent& event = track_state.current_event;
-        if (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 > 0) {
-            int note = event.data1;
-            if (note >= 0 && note < 128) {
-                note_state[note] = true;
-            }
-        } else if (event.eventType == MIDI_EVENT_NOTE_OFF ||
-                   (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 == 0)) {
-            int note = event.data1;
-            if (note >= 0 && note < 128) {
-                note_state[note] = false;
-            }
+    // チェックポイントから目標時刻までのブロックだけを消費してキー状態を再構築
+    event_decoder_.SetPlayhead(time_seconds);
+    while (const DecodedMidiEvent* event = event_decoder_.PeekNext(time_seconds + kTimeEpsilon)) {
+        if (event->time_seconds > time_seconds + kTimeEpsilon) {
+            break;
         }
 
-        midi_free_event(&track_state.current_event);
-        track_state.current_event = MidiEvent{};
-        track_state.has_event = false;
+        ApplyNoteState(*event, note_state, note_on_times);
+        event_decoder_.PopNext();
         processed_event_count_++;
-
-        LoadNextTrackEvent(track_index);
     }
 
-    auto now = std::chrono::steady_clock::now();
-    if (piano_keyboard_) {
-        for (int note = 0; note < 128; note++) {
-            piano_keyboard_->SetKeyPressed(note, note_state[note]);
-            active_notes_[note] = note_state[note];
-            if (note_state[note]) {
-                note_press_times_[note] = now;
-            }
-        }
-    } else {
-        for (int note = 0; note < 128; note++) {
-            active_notes_[note] = note_state[note];
-            if (note_state[note]) {
-                note_press_times_[note] = now;
-            }
+    // 押下継続時間を過ぎたノートは UpdateActiveNotes と同じ条件でリリース済みにする
+    for (size_t slot = 0; slot < note_state.size(); slot++) {
+        const bool pressed = note_state[slot] &&
+                             !(time_seconds - note_on_times[slot] > video_settings_.key_press_duration);
+        if (slot / 128 < piano_keyboards_.size()) {
+            piano_keyboards_[slot / 128]->SetKeyPressed(static_cast<int>(slot % 128), pressed);
         }
+        active_notes_[slot] = pressed;
+        note_press_times_[slot] = note_on_times[slot];
     }
+    SetKeyboardAnimationTime(time_seconds);
 
     current_time_ = time_seconds;
     current_frame_ = static_cast<int>(current_time_ / frame_time_);
@@ -322,7 +424,12 @@ bool MidiVideoOutput::StartVideoOutput(const VideoOutputSettings& settings) {
         return false;
     }
     
+    const bool split_changed = settings.keyboard_split != video_settings_.keyboard_split;
     video_settings_ = settings;
+    RebuildBlipPalette();
+    if (split_changed && piano_keyboards_.size() > 1) {
+        BuildSeekCheckpoints(sources_, total_duration_);
+    }
     if (video_settings_.include_audio && video_settings_.audio_file_path.empty()) {
         std::cerr << "Audio output requested but no audio file path provided." << std::endl;
         return false;
@@ -339,15 +446,39 @@ bool MidiVideoOutput::StartVideoOutput(const VideoOutputSettings& settings) {
     // 出力ビデオファイルのパスを設定
     output_video_path_ = settings.output_path + ".mp4";
     
+    // 外部オーディオがなければ内蔵シンセの音声をパイプで FFmpeg の2つ目の入力にする
+    if (video_settings_.synthesize_audio && !video_settings_.include_audio) {
+        if (!synth_pipe_.Create()) {
+            return false;
+        }
+        video_settings_.include_audio = true;
+        video_settings_.audio_file_path = synth_pipe_.GetPath();
+    }
+    
+    // リードバック先を確保してページを確定させておく（録画中の確保とページフォルトを避ける）
+    const size_t frame_size = static_cast<size_t>(video_settings_.width) * video_settings_.height * 4;
+    if (!frame_pool_.Initialize(frame_size, kFramesInFlight, video_settings_.use_huge_pages)) {
+        std::cerr << "Failed to allocate frame buffers" << std::endl;
+        synth_pipe_.Close();
+        return false;
+    }
+    
     // FFmpegを初期化
     if (!InitializeFFmpeg()) {
         std::cerr << "Failed to initialize FFmpeg" << std::endl;
+        frame_pool_.Clear();
+        synth_pipe_.Close();
         return false;
     }
+    // 合成は映像と並行して進める（FFmpeg が読む速さに合わせて待たされるので、先読みはパイプの分だけ）
+    if (synth_pipe_.IsCreated()) {
+        StartAudioSynthesis();
+    }
     
     // 録画開始
     is_recording_ = true;
     frame_count_ = 0;
+    last_encoder_exit_code_ = -1;
     playback_state_ = MidiPlaybackState::Recording;
     
     // デバッグ情報を初期化
@@ -357,18 +488,42 @@ bool MidiVideoOutput::StartVideoOutput(const VideoOutputSettings& settings) {
     debug_info_.estimated_total_duration = total_duration_;
     debug_info_.current_frame_count = 0;
     debug_info_.current_fps = 0.0;
+    debug_overlay_.Invalidate();
+    
+    // ブリップとキーのアニメーションは動画の時刻で進める（前の録画の残りは消す）
+    for (PianoKeyboard* keyboard : piano_keyboards_) {
+        keyboard->ClearEffects();
+    }
+    SetKeyboardAnimationTime(0.0);
     
     // 再生を最初から開始
     Stop();
     current_time_ = 0.0;
     Play();
     
+    // 途中のフレームから録画する場合は、最初のフレームまでにブリップやアニメーションが出揃う分と
+    // キャプチャの遅れの分だけ手前にシークする。シーク先より前のノートは最初のフレームに影響しないので、
+    // 0秒から回さなくても全体をレンダリングした場合と同じ絵になる
+    // （空回しの間は描画を省略でき、キャプチャの遅れの分は読み出しだけ行って FFmpeg には書かない）
+    if (video_settings_.start_frame > 0) {
+        const int lead_in = std::min(video_settings_.start_frame, kCaptureLatencyFrames + GetPreRollFrameCount());
+        Seek((video_settings_.start_frame - lead_in) * frame_time_);
+        current_frame_ = video_settings_.start_frame - lead_in;
+        current_time_ = current_frame_ * frame_time_;
+    }
+    
     std::cout << "Video output started:" << std::endl;
     std::cout << "  Output file: " << output_video_path_ << std::endl;
     std::cout << "  Resolution: " << settings.width << "x" << settings.height << std::endl;
     std::cout << "  FPS: " << settings.fps << std::endl;
     std::cout << "  Bitrate: " << settings.bitrate << " bps" << std::endl;
     std::cout << "  Rate control: " << (settings.use_cbr ? "CBR" : "VBR") << std::endl;
+    if (settings.start_frame > 0 || settings.end_frame >= 0) {
+        std::cout << "  Frames: " << settings.start_frame << " - "
+                  << (settings.end_frame >= 0 ? settings.end_frame : GetTotalFrameCount()) << std::endl;
+    }
+    std::cout << "  Frame buffers: " << kFramesInFlight << " x " << (frame_size / (1024 * 1024)) << " MB ("
+              << frame_pool_.DescribeBacking() << ")" << std::endl;
     if (video_settings_.include_audio) {
         std::cout << "  Audio file: " << video_settings_.audio_file_path << std::endl;
         std::cout << "  Audio codec: aac" << std::endl;
@@ -379,21 +534,25 @@ bool MidiVideoOutput::StartVideoOutput(const VideoOutputSettings& settings) {
     
     // MIDI情報を表示
     std::cout << "MIDI Information:" << std::endl;
-    if (midi_file_ && midi_file_->header.numberOfTracks > 0) {
-        // 全トラックのイベント数を計算（概算）
-        std::cout << "  Number of tracks: " << midi_file_->header.numberOfTracks << std::endl;
-        std::cout << "  Time division: " << midi_file_->header.timeDivision << std::endl;
-    } else {
+    if (sources_.empty()) {
         std::cout << "  No tracks available" << std::endl;
     }
-    std::cout << "  Default tempo: " << current_tempo_ << " μs/quarter" << std::endl;
-    std::cout << "  Tempo changes: " << tempo_changes_.size() << std::endl;
-    
-    // 最初の数個のテンポ変更を表示
-    for (size_t i = 0; i < std::min((size_t)5, tempo_changes_.size()); ++i) {
-        const auto& tc = tempo_changes_[i];
-        std::cout << "    Tempo change " << i << ": tick=" << tc.tick 
-                  << ", tempo=" << tc.tempo << " μs/quarter" << std::endl;
+    for (const auto& source : sources_) {
+        const auto& tempo_changes = source.tempo_map.GetChanges();
+        if (sources_.size() > 1) {
+            std::cout << "  Source: " << source.path << " (offset " << source.time_offset_seconds << "s)" << std::endl;
+        }
+        std::cout << "  Number of tracks: " << source.file->header.numberOfTracks << std::endl;
+        std::cout << "  Time division: " << source.file->header.timeDivision << std::endl;
+        std::cout << "  Default tempo: " << source.tempo_map.GetInitialTempo() << " μs/quarter" << std::endl;
+        std::cout << "  Tempo changes: " << tempo_changes.size() << std::endl;
+        
+        // 最初の数個のテンポ変更を表示
+        for (size_t i = 0; i < std::min((size_t)5, tempo_changes.size()); ++i) {
+            const auto& tc = tempo_changes[i];
+            std::cout << "    Tempo change " << i << ": tick=" << tc.tick 
+                      << ", tempo=" << tc.tempo << " μs/quarter" << std::endl;
+        }
     }
     
     return true;
@@ -406,6 +565,11 @@ void MidiVideoOutput::StopVideoOutput() {
         
         // FFmpegプロセスを終了
         FinalizeFFmpeg();
+        frame_pool_.Clear();
+        
+        for (PianoKeyboard* keyboard : piano_keyboards_) {
+            keyboard->UseWallClock();
+        }
         
         std::cout << "Video output stopped. Captured " << frame_count_ << " frames" << std::endl;
         std::cout << "Output file: " << output_video_path_ << std::endl;
@@ -453,8 +617,9 @@ void MidiVideoOutput::Update(double delta_time) {
                   << ", time=" << current_time_ << "s, duration=" << total_duration_ << "s" << std::endl;
     }
     
-    // 終了チェック
-    if (current_time_ >= total_duration_) {
+    // 終了チェック（フレーム範囲の指定があればその終わりまで）
+    const bool past_end_frame = video_settings_.end_frame >= 0 && current_frame_ > video_settings_.end_frame;
+    if (current_time_ >= total_duration_ || past_end_frame) {
         if (is_recording_) {
             StopVideoOutput();
         } else {
@@ -467,7 +632,11 @@ void MidiVideoOutput::Update(double delta_time) {
     if (update_counter <= 3) {
         std::cout << "Update " << update_counter << ": Processing MIDI events at " << current_time_ << "s" << std::endl;
     }
-    ProcessMidiEvents(current_time_);
+    // サブフレームを描く場合は最初のサブフレーム時刻まで。残りは AdvanceSubFrame で進める
+    ProcessMidiEvents(GetSubFrameTime(0));
+    if (video_settings_.temporal_samples > 1) {
+        CollectSubFrameEvents();
+    }
     
     // アクティブノートを更新
     UpdateActiveNotes(current_time_);
@@ -486,6 +655,75 @@ void MidiVideoOutput::Update(double delta_time) {
     }
 }
 
+void MidiVideoOutput::UpdateToTime(double time_seconds) {
+    if (playback_state_ != MidiPlaybackState::Playing || !IsMidiLoaded()) {
+        return;
+    }
+
+    // 時刻は戻さない（クロックの揺れで同じイベントを二重に処理しないように）
+    current_time_ = std::max(current_time_, time_seconds);
+    current_frame_ = static_cast<int>(current_time_ / frame_time_);
+
+    const double end_time = video_settings_.end_frame >= 0 ? video_settings_.end_frame * frame_time_ : total_duration_;
+    if (current_time_ >= std::min(end_time, total_duration_)) {
+        Stop();
+        return;
+    }
+
+    ProcessMidiEvents(current_time_);
+    UpdateActiveNotes(current_time_);
+
+    if (progress_callback_) {
+        progress_callback_(GetProgress());
+    }
+}
+
+void MidiVideoOutput::ProcessLiveEvents(const std::vector<DecodedMidiEvent>& events, double current_time) {
+    for (const DecodedMidiEvent& event : events) {
+        ProcessNoteEvent(event);
+    }
+    UpdateActiveNotes(current_time);
+}
+
+double MidiVideoOutput::GetSubFrameTime(int sample_index) const {
+    // サブフレームは前フレームと現フレームの間に等間隔で置き、最後のサブフレームが現フレーム時刻になる
+    const int sample_count = std::max(1, video_settings_.temporal_samples);
+    const int remaining = sample_count - 1 - std::clamp(sample_index, 0, sample_count - 1);
+    return current_time_ - frame_time_ * static_cast<double>(remaining) / static_cast<double>(sample_count);
+}
+
+void MidiVideoOutput::CollectSubFrameEvents() {
+    // フレーム終わりまでのイベントを先に取り出しておき、途中のサブフレームで押される鍵盤に印を付ける。
+    // 印のない静止中の白鍵はフレームの間ずっと変わらないので、1フレームに1回だけ描けばよい
+    for (PianoKeyboard* keyboard : piano_keyboards_) {
+        keyboard->ClearFrameChanges();
+    }
+    sub_frame_events_.clear();
+    sub_frame_event_index_ = 0;
+
+    event_decoder_.SetPlayhead(current_time_);
+    while (const DecodedMidiEvent* event = event_decoder_.PeekNext(current_time_ + kTimeEpsilon)) {
+        if (event->time_seconds > current_time_ + kTimeEpsilon) {
+            break;
+        }
+        if (event->IsNoteOn() && !piano_keyboards_.empty()) {
+            piano_keyboards_[GetKeyboardIndex(event->channel, event->global_track_index)]->MarkKeyChangesThisFrame(event->data1);
+        }
+        sub_frame_events_.push_back(*event);
+        event_decoder_.PopNext();
+    }
+}
+
+void MidiVideoOutput::AdvanceSubFrame(int sample_index) {
+    if (playback_state_ != MidiPlaybackState::Playing && playback_state_ != MidiPlaybackState::Recording) {
+        return;
+    }
+    if (!IsMidiLoaded()) {
+        return;
+    }
+    ProcessMidiEvents(GetSubFrameTime(sample_index));
+}
+
 bool MidiVideoOutput::CaptureFrame() {
     if (!is_recording_ || !renderer_ || !ffmpeg_process_) {
         std::cerr << "CaptureFrame failed: is_recording_=" << is_recording_ 
@@ -494,29 +732,42 @@ bool MidiVideoOutput::CaptureFrame() {
         return false;
     }
     
+    // 空回し中は読み出さない（描画も省略されている）
+    if (IsPreRolling()) {
+        return true;
+    }
+    
     // Measure frame capture time
     auto capture_start = std::chrono::high_resolution_clock::now();
     
-    // フレームバッファをキャプチャ
-    std::vector<uint8_t> frame_data = CaptureFramebuffer();
+    // プールのフレームバッファへ直接キャプチャ
+    FrameBuffer* frame = frame_pool_.Acquire();
+    if (!frame) {
+        std::cerr << "CaptureFrame failed: no free frame buffer" << std::endl;
+        return false;
+    }
+    const uint8_t* frame_data = frame->GetData();
+    const size_t frame_size = frame->GetSize();
+    bool captured = CaptureFramebufferInto(frame->GetData());
     
     auto capture_end = std::chrono::high_resolution_clock::now();
     auto capture_duration = std::chrono::duration_cast<std::chrono::microseconds>(capture_end - capture_start);
     
-    if (frame_data.empty()) {
-        std::cerr << "CaptureFrame failed: frame_data is empty" << std::endl;
+    if (!captured) {
+        std::cerr << "CaptureFrame failed: framebuffer readback failed" << std::endl;
+        frame_pool_.Release(frame);
         return false;
     }
     
     // デバッグ: フレームデータとパフォーマンス情報を出力
     if (frame_count_ < 5 || frame_count_ % 100 == 0) {
-        std::cerr << "Frame " << frame_count_ << ": data size=" << frame_data.size() 
+        std::cerr << "Frame " << frame_count_ << ": data size=" << frame_size 
                   << ", expected=" << (video_settings_.width * video_settings_.height * 4) 
                   << ", capture time=" << capture_duration.count() << "μs"
                   << ", GPU optimized=" << (video_settings_.use_gpu_optimized_capture ? "yes" : "no") << std::endl;
         
         // 最初の数ピクセルの値をチェック
-        if (frame_data.size() >= 16) {
+        if (frame_size >= 16) {
             std::cerr << "First 4 pixels RGBA: ";
             for (int i = 0; i < 16; i += 4) {
                 std::cerr << "(" << (int)frame_data[i] << "," << (int)frame_data[i+1] 
@@ -526,8 +777,15 @@ bool MidiVideoOutput::CaptureFrame() {
         }
     }
     
+    // 範囲の手前のフレーム（キャプチャの遅れを埋めるための読み出し）は書き込まない
+    if (current_frame_ <= video_settings_.start_frame) {
+        frame_pool_.Release(frame);
+        return true;
+    }
+    
     // FFmpegプロセスにフレームデータを送信
-    bool success = WriteFrameToFFmpeg(frame_data);
+    bool success = WriteFrameToFFmpeg(frame_data, frame_size);
+    frame_pool_.Release(frame);
     
     if (success) {
         frame_count_++;
@@ -558,6 +816,122 @@ double MidiVideoOutput::GetTotalDuration() const {
     return total_duration_;
 }
 
+int MidiVideoOutput::GetTotalFrameCount() const {
+    // Update と同じ計算で「current_frame_ * frame_time_ < total_duration_」となる最後のフレームを求める
+    int frames = std::max(0, static_cast<int>(total_duration_ / frame_time_) - 1);
+    while ((frames + 1) * frame_time_ < total_duration_) {
+        frames++;
+    }
+    while (frames > 0 && frames * frame_time_ >= total_duration_) {
+        frames--;
+    }
+    return frames;
+}
+
+int MidiVideoOutput::GetFrameAtTime(double time_seconds) const {
+    // 動画のフレーム j には時刻 j * frame_time_ の状態が写る
+    return static_cast<int>(std::ceil(std::max(0.0, time_seconds) / frame_time_ - kTimeEpsilon));
+}
+
+double MidiVideoOutput::GetTickTime(uint64_t tick) const {
+    if (sources_.empty()) {
+        return 0.0;
+    }
+    const LoadedMidiSource& source = sources_.front();
+    return source.time_offset_seconds + source.tempo_map.TickToSeconds(tick);
+}
+
+double MidiVideoOutput::GetBarStartTime(int bar) const {
+    if (sources_.empty() || !sources_.front().file) {
+        return 0.0;
+    }
+    const LoadedMidiSource& source = sources_.front();
+    const uint64_t quarter_ticks = source.file->header.timeDivision;
+
+    // 拍子変更を順にたどり、小節線の位置を数える（拍子指定がなければ 4/4）
+    auto ticks_per_bar = [quarter_ticks](uint8_t numerator, uint8_t denominator_power) {
+        return std::max<uint64_t>(1, quarter_ticks * 4 * numerator >> denominator_power);
+    };
+    uint64_t bar_tick = 0;
+    uint64_t bar_length = ticks_per_bar(4, 2);
+    int current_bar = 1;
+    for (const TimeSignatureChange& change : source.time_signatures) {
+        if (change.tick > bar_tick) {
+            // 小節の途中の拍子変更は次の小節線から有効とみなす
+            const uint64_t bars = (change.tick - bar_tick + bar_length - 1) / bar_length;
+            if (current_bar + static_cast<int64_t>(bars) > bar) {
+                break;
+            }
+            current_bar += static_cast<int>(bars);
+            bar_tick += bars * bar_length;
+        }
+        bar_length = ticks_per_bar(change.numerator, change.denominator_power);
+    }
+    bar_tick += static_cast<uint64_t>(std::max(0, bar - current_bar)) * bar_length;
+    return GetTickTime(bar_tick);
+}
+
+bool MidiVideoOutput::IsPreRolling() const {
+    // ここより後のフレームは、キャプチャの遅れを埋めるために描画して読み出す必要がある
+    return is_recording_ && current_frame_ <= video_settings_.start_frame - kCaptureLatencyFrames;
+}
+
+AudioSynthSettings MidiVideoOutput::GetSynthSettings() const {
+    AudioSynthSettings synth_settings;
+    synth_settings.max_voices = video_settings_.synth_max_voices;
+    return synth_settings;
+}
+
+void MidiVideoOutput::GetSynthRange(double& start_seconds, double& end_seconds) const {
+    end_seconds = total_duration_;
+    if (video_settings_.end_frame >= 0) {
+        end_seconds = std::min(end_seconds, (video_settings_.end_frame + 1) * frame_time_);
+    }
+    // 範囲の開始位置から生成する（音声の先頭が最初の出力フレームに揃う）
+    start_seconds = std::min(end_seconds, video_settings_.start_frame * frame_time_);
+}
+
+void MidiVideoOutput::StartAudioSynthesis() {
+    double start = 0.0;
+    double end = 0.0;
+    GetSynthRange(start, end);
+    const AudioSynthSettings synth_settings = GetSynthSettings();
+    synth_thread_ = std::thread([this, start, end, synth_settings]() {
+        EnterBackgroundThread("audio-synth");
+        // FFmpeg が音声入力を開くまで待つ（開かずに終了した場合は StopAudioSynthesis で打ち切る）
+        if (!synth_pipe_.Connect()) {
+            return;
+        }
+        // -shortest で映像が先に終わると FFmpeg が読むのをやめるので、途中で書けなくなっても失敗扱いにしない
+        MidiAudioSynth synth(synth_settings);
+        synth.Render(MakeDecodeSources(sources_), start, end, [this](const int16_t* samples, size_t frame_count) {
+            return synth_pipe_.Write(samples, frame_count * 4);
+        });
+        synth_pipe_.CloseWriter();
+    });
+}
+
+void MidiVideoOutput::StopAudioSynthesis() {
+    // FFmpeg の終了後に呼ぶ（書き込み中の合成スレッドはパイプが閉じられて抜ける）
+    synth_pipe_.Abort();
+    if (synth_thread_.joinable()) {
+        synth_thread_.join();
+    }
+    synth_pipe_.Close();
+}
+
+bool MidiVideoOutput::SynthesizeAudio(const std::string& wav_path) const {
+    MidiAudioSynth synth(GetSynthSettings());
+    double start = 0.0;
+    double duration = 0.0;
+    GetSynthRange(start, duration);
+    if (!synth.RenderToWav(MakeDecodeSources(sources_), start, duration, wav_path)) {
+        std::cerr << "Failed to synthesize audio" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 float MidiVideoOutput::GetProgress() const {
     if (total_duration_ <= 0.0) {
         return 0.0f;
@@ -574,56 +948,91 @@ const VideoOutputSettings& MidiVideoOutput::GetVideoSettings() const {
 }
 
 void MidiVideoOutput::SetVideoSettings(const VideoOutputSettings& settings) {
+    const bool split_changed = settings.keyboard_split != video_settings_.keyboard_split;
     video_settings_ = settings;
-}
+    RebuildBlipPalette();
 
-const MidiFile* MidiVideoOutput::GetMidiFile() const {
-    return midi_file_.get();
-}
+    // 鍵盤の振り分けが変わったらシーク用チェックポイントの押下状態も作り直す
+    if (split_changed && piano_keyboards_.size() > 1 && !sources_.empty()) {
+        BuildSeekCheckpoints(sources_, total_duration_);
+    }
 
-std::vector<TimedMidiEvent> MidiVideoOutput::GetEventsInRange(double start_time, double end_time) const {
-    std::vector<TimedMidiEvent> events;
-    if (!midi_file_ || end_time < start_time) {
-        return events;
+    // ロード後にオーバーレイを有効にしたときやフレームレートが変わったときはここで作り直す（描画中には作らない）
+    if (video_settings_.show_note_stats && !sources_.empty() &&
+        (!note_stats_.IsBuilt() || note_stats_.GetFramesPerSecond() != std::max(1, video_settings_.fps))) {
+        BuildNoteStats(sources_, total_duration_);
     }
+}
 
-    for (int track_index = 0; track_index < midi_file_->header.numberOfTracks; ++track_index) {
-        MidiTrack track_copy = midi_file_->tracks[track_index];
-        MidiEvent event{};
+void MidiVideoOutput::BuildNoteStats(const std::vector<LoadedMidiSource>& sources, double duration_seconds) {
+    note_stats_.Build(MakeDecodeSources(sources), video_settings_.fps, duration_seconds);
+}
 
-        while (midi_read_next_event(&track_copy, &event)) {
-            uint32_t absolute_tick = track_copy.currentTick;
+void MidiVideoOutput::BuildSeekCheckpoints(const std::vector<LoadedMidiSource>& sources, double duration_seconds) {
+    seek_checkpoints_.clear();
+    if (piano_keyboards_.empty()) {
+        return;
+    }
 
-            if ((event.eventType == MIDI_EVENT_NOTE_ON && event.data2 > 0) ||
-                event.eventType == MIDI_EVENT_NOTE_OFF ||
-                (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 == 0)) {
-                double time = CalculateElapsedTimeFromTick(absolute_tick);
-                if (time >= start_time && time <= end_time) {
-                    TimedMidiEvent timed_event{};
-                    timed_event.event = event;
-                    timed_event.tick = absolute_tick;
-                    timed_event.time_seconds = time;
-                    timed_event.processed = false;
-                    events.push_back(timed_event);
+    MidiEventMerger merger;
+    merger.Reset(MakeDecodeSources(sources));
+
+    // 1つあたりの大きさはトラック数に比例するので、合計が上限に収まるよう間隔を広げる
+    const size_t checkpoint_bytes = merger.GetTrackCount() * (sizeof(StreamingTrackState) + sizeof(PendingEvent)) + 1;
+    const size_t max_checkpoints = std::max<size_t>(1, kSeekCheckpointBudgetBytes / checkpoint_bytes);
+    const double interval = std::max(kSeekCheckpointInterval, duration_seconds / static_cast<double>(max_checkpoints));
+
+    std::vector<bool> note_state(piano_keyboards_.size() * 128, false);
+    std::vector<double> note_on_times(note_state.size(), 0.0);
+    size_t event_count = 0;
+    double next_time = interval;
+    DecodedMidiEvent event;
+    while (const DecodedMidiEvent* next = merger.Peek()) {
+        if (next->time_seconds >= next_time) {
+            SeekCheckpoint checkpoint;
+            checkpoint.time_seconds = next->time_seconds;
+            checkpoint.event_count = event_count;
+            checkpoint.merger = merger;
+            for (size_t slot = 0; slot < note_state.size(); slot++) {
+                if (note_state[slot]) {
+                    checkpoint.held_keys.push_back({static_cast<uint32_t>(slot), note_on_times[slot]});
                 }
             }
-
-            midi_free_event(&event);
-            event = MidiEvent{};
+            seek_checkpoints_.push_back(std::move(checkpoint));
+            next_time = next->time_seconds + interval;
         }
+
+        merger.Next(event);
+        ApplyNoteState(event, note_state, note_on_times);
+        event_count++;
     }
+}
 
-    std::sort(events.begin(), events.end(), [](const TimedMidiEvent& a, const TimedMidiEvent& b) {
-        if (a.time_seconds == b.time_seconds) {
-            return a.tick < b.tick;
-        }
-        return a.time_seconds < b.time_seconds;
-    });
+const MidiFile* MidiVideoOutput::GetMidiFile(size_t source_index) const {
+    if (source_index >= sources_.size()) {
+        return nullptr;
+    }
+    return sources_[source_index].file.get();
+}
+
+size_t MidiVideoOutput::GetMidiSourceCount() const {
+    return sources_.size();
+}
+
+DecodedEventRange MidiVideoOutput::GetEventsInRange(double start_time, double end_time) const {
+    std::lock_guard<std::mutex> lock(event_store_mutex_);
+    if (sources_.empty()) {
+        return {};
+    }
+
+    if (!event_store_.IsBuilt()) {
+        event_store_.Build(MakeDecodeSources(sources_), total_event_count_);
+    }
 
-    return events;
+    return event_store_.GetEventsInRange(start_time, end_time);
 }
 
-int MidiVideoOutput::GetTotalNoteCount() const {
+size_t MidiVideoOutput::GetTotalNoteCount() const {
     return total_note_count_;
 }
 
@@ -642,7 +1051,7 @@ void MidiVideoOutput::SetFrameCapturedCallback(std::function<void(int)> callback
 // 内部メソッドの実装
 
 void MidiVideoOutput::ProcessMidiEvents(double current_time) {
-    if (!midi_file_) {
+    if (sources_.empty()) {
         return;
     }
     
@@ -652,296 +1061,211 @@ void MidiVideoOutput::ProcessMidiEvents(double current_time) {
                   << "s, processed=" << processed_event_count_ << "/" << total_event_count_ << std::endl;
     }
 
-    while (!pending_events_.empty()) {
-        PendingEvent next = pending_events_.top();
-        if (next.time_seconds > current_time + kTimeEpsilon) {
-            break;
-        }
-
-        pending_events_.pop();
-
-        if (next.track_index >= streaming_tracks_.size()) {
-            continue;
-        }
+    SetKeyboardAnimationTime(current_time);
 
-        auto& track_state = streaming_tracks_[next.track_index];
-        if (!track_state.has_event || std::fabs(track_state.event_time - next.time_seconds) > kTimeEpsilon) {
-            continue;
+    // CollectSubFrameEvents で取り出し済みのイベントが先（デコーダーに残っているのはそれより後）
+    while (sub_frame_event_index_ < sub_frame_events_.size() &&
+           sub_frame_events_[sub_frame_event_index_].time_seconds <= current_time + kTimeEpsilon) {
+        ProcessNoteEvent(sub_frame_events_[sub_frame_event_index_++]);
+        processed_event_count_++;
+    }
+    if (sub_frame_event_index_ < sub_frame_events_.size()) {
+        return;
+    }
+    
+    // デコードはデコードスレッドで先行して行われているので、ここではブロックを消費するだけ
+    event_decoder_.SetPlayhead(current_time);
+    while (const DecodedMidiEvent* event = event_decoder_.PeekNext(current_time + kTimeEpsilon)) {
+        if (event->time_seconds > current_time + kTimeEpsilon) {
+            break;
         }
 
         if (debug_count < 10) {
-            std::cout << "  Event track=" << next.track_index
-                      << ", tick=" << track_state.event_tick
-                      << ", time=" << track_state.event_time << "s" << std::endl;
+            std::cout << "  Event track=" << event->track_index
+                      << ", tick=" << event->tick
+                      << ", time=" << event->time_seconds << "s" << std::endl;
             debug_count++;
         }
 
-    ProcessNoteEvent(track_state.current_event, track_state.event_time, next.track_index);
-        midi_free_event(&track_state.current_event);
-        track_state.current_event = MidiEvent{};
-        track_state.has_event = false;
+        ProcessNoteEvent(*event);
+        event_decoder_.PopNext();
         processed_event_count_++;
-
-        LoadNextTrackEvent(next.track_index);
     }
 }
 
 void MidiVideoOutput::ResetStreamingState() {
     ClearStreamingResources();
 
-    if (!midi_file_) {
+    if (sources_.empty()) {
         return;
     }
 
-    streaming_tracks_.resize(midi_file_->header.numberOfTracks);
-    for (size_t i = 0; i < streaming_tracks_.size(); ++i) {
-        auto& state = streaming_tracks_[i];
-        state.track_state = midi_file_->tracks[i];
-        state.current_event = MidiEvent{};
-        state.has_event = false;
-        state.event_tick = 0;
-        state.event_time = 0.0;
-    }
-
     processed_event_count_ = 0;
-    pending_events_ = PendingEventQueue{};
-
-    for (size_t i = 0; i < streaming_tracks_.size(); ++i) {
-        LoadNextTrackEvent(i);
-    }
+    event_decoder_.Start(MakeDecodeSources(sources_), video_settings_.decode_ahead_seconds);
 }
 
 void MidiVideoOutput::ClearStreamingResources() {
-    for (auto& state : streaming_tracks_) {
-        if (state.has_event) {
-            midi_free_event(&state.current_event);
-            state.current_event = MidiEvent{};
-            state.has_event = false;
-        }
-    }
-    streaming_tracks_.clear();
-    pending_events_ = PendingEventQueue{};
+    event_decoder_.Stop();
+    sub_frame_events_.clear();
+    sub_frame_event_index_ = 0;
 }
 
-bool MidiVideoOutput::LoadNextTrackEvent(size_t track_index) {
-    if (!midi_file_ || track_index >= streaming_tracks_.size()) {
-        return false;
+void MidiVideoOutput::SetKeyboardAnimationTime(double time_seconds) {
+    // 録画中だけ動画の時刻で進める（プレビューや操作中は実時間のまま）
+    if (!is_recording_) {
+        return;
     }
-
-    auto& state = streaming_tracks_[track_index];
-    if (state.has_event) {
-        midi_free_event(&state.current_event);
-        state.current_event = MidiEvent{};
-        state.has_event = false;
+    for (PianoKeyboard* keyboard : piano_keyboards_) {
+        keyboard->SetAnimationTime(time_seconds);
     }
+}
 
-    MidiEvent event{};
-    while (midi_read_next_event(&state.track_state, &event)) {
-        uint32_t absolute_tick = state.track_state.currentTick;
-
-        if (event.eventType == MIDI_EVENT_META && event.metaType == MIDI_META_SET_TEMPO && event.metaLength == 3) {
-            uint32_t tempo = (event.metaData[0] << 16) | (event.metaData[1] << 8) | event.metaData[2];
-            current_tempo_ = tempo;
-        }
-
-        if ((event.eventType == MIDI_EVENT_NOTE_ON && event.data2 > 0) ||
-            event.eventType == MIDI_EVENT_NOTE_OFF ||
-            (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 == 0)) {
-            state.current_event = event;
-            state.has_event = true;
-            state.event_tick = absolute_tick;
-            state.event_time = CalculateElapsedTimeFromTick(absolute_tick);
-
-            pending_events_.push({track_index, state.event_time, state.event_tick});
-            return true;
-        }
-
-        midi_free_event(&event);
-        event = MidiEvent{};
+int MidiVideoOutput::GetPreRollFrameCount() const {
+    // 鍵盤の押下状態はシークで再現できるので、空回しはブリップとアニメーションが落ち着く分だけでよい
+    double settle_seconds = 0.0;
+    for (const PianoKeyboard* keyboard : piano_keyboards_) {
+        settle_seconds = std::max(settle_seconds, keyboard->GetAnimationSettleSeconds());
     }
-
-    state.has_event = false;
-    return false;
+    return static_cast<int>(std::ceil(settle_seconds / frame_time_)) + 1;
 }
 
-void MidiVideoOutput::ProcessNoteEvent(const MidiEvent& event, double event_time, size_t track_index) {
-    if (!piano_keyboard_) {
+void MidiVideoOutput::ProcessNoteEvent(const DecodedMidiEvent& event) {
+    if (piano_keyboards_.empty()) {
         return;
     }
-    (void)event_time;
+
+    // 鍵盤が複数ある場合はチャンネル/トラックで振り分ける
+    const size_t keyboard_index = GetKeyboardIndex(event.channel, event.global_track_index);
+    PianoKeyboard* keyboard = piano_keyboards_[keyboard_index];
     
-    if (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 > 0) {
+    if (event.IsNoteOn()) {
         // ノートオン
         int note = event.data1;
         if (note >= 0 && note < 128) {
-            piano_keyboard_->SetKeyPressed(note, true);
-            active_notes_[note] = true;
-            note_press_times_[note] = std::chrono::steady_clock::now();
+            const size_t slot = keyboard_index * 128 + static_cast<size_t>(note);
+            keyboard->SetKeyPressed(note, true);
+            active_notes_[slot] = true;
+            note_press_times_[slot] = event.time_seconds;
             
             // 選択されたカラーモードに基づいたブリップエフェクトを追加
-            const Color blip_color = DetermineBlipColor(event.channel, track_index);
-            piano_keyboard_->AddKeyBlip(note, blip_color);
+            const int color_offset = event.source_index < sources_.size() ? sources_[event.source_index].color_offset : 0;
+            const uint32_t blip_color = DetermineBlipColor(event.channel, event.track_index, color_offset);
+            keyboard->AddKeyBlip(note, blip_color);
         }
-    } else if (event.eventType == MIDI_EVENT_NOTE_OFF || 
-               (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 == 0)) {
+    } else if (event.IsNoteOff()) {
         // ノートオフ
         int note = event.data1;
         if (note >= 0 && note < 128) {
-            piano_keyboard_->SetKeyPressed(note, false);
-            active_notes_[note] = false;
+            keyboard->SetKeyPressed(note, false);
+            active_notes_[keyboard_index * 128 + static_cast<size_t>(note)] = false;
         }
     }
 }
 
 void MidiVideoOutput::UpdateActiveNotes(double current_time) {
-    if (!piano_keyboard_) {
+    if (piano_keyboards_.empty()) {
         return;
     }
     
-    // キー押下継続時間による自動リリース
-    auto now = std::chrono::steady_clock::now();
-    for (int note = 0; note < 128; note++) {
-        if (active_notes_[note]) {
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - note_press_times_[note]).count();
-            if (elapsed > video_settings_.key_press_duration * 1000) {
-                piano_keyboard_->SetKeyPressed(note, false);
-                active_notes_[note] = false;
+    // キー押下継続時間による自動リリース（再生位置で判定するので描画速度に依存しない）
+    for (size_t slot = 0; slot < active_notes_.size(); slot++) {
+        if (active_notes_[slot]) {
+            if (current_time - note_press_times_[slot] > video_settings_.key_press_duration) {
+                piano_keyboards_[slot / 128]->SetKeyPressed(static_cast<int>(slot % 128), false);
+                active_notes_[slot] = false;
             }
         }
     }
 }
 
-double MidiVideoOutput::CalculateTotalDuration() {
-    if (!midi_file_ || total_event_count_ == 0) {
+double MidiVideoOutput::CalculateTotalDuration(const std::vector<LoadedMidiSource>& sources) {
+    const bool has_events = std::any_of(sources.begin(), sources.end(),
+                                        [](const LoadedMidiSource& source) { return source.event_count > 0; });
+    if (!has_events) {
         return 0.0;
     }
 
-    double duration = CalculateElapsedTimeFromTick(last_event_tick_);
+    double duration = 0.0;
+    for (const auto& source : sources) {
+        if (source.has_note_events) {
+            duration = std::max(duration, source.time_offset_seconds + source.tempo_map.TickToSeconds(source.last_event_tick));
+        }
+    }
     return duration + 2.0;
 }
 
-void MidiVideoOutput::BuildTempoMapAndStats() {
-    if (!midi_file_) {
-        return;
+std::vector<MidiDecodeSource> MidiVideoOutput::MakeDecodeSources(const std::vector<LoadedMidiSource>& sources) {
+    // デコーダー・統計・シンセ共通の入力（ファイルとテンポマップは sources が持ち続ける）
+    std::vector<MidiDecodeSource> decode_sources;
+    decode_sources.reserve(sources.size());
+    for (const auto& source : sources) {
+        decode_sources.push_back({source.file.get(), &source.tempo_map, source.time_offset_seconds});
     }
+    return decode_sources;
+}
 
-    tempo_changes_.clear();
-    total_note_count_ = 0;
-    total_event_count_ = 0;
-    processed_event_count_ = 0;
-    last_event_tick_ = 0;
-
-    current_tempo_ = 500000; // 120 BPM
-    tempo_changes_.push_back({0, current_tempo_});
-
-    for (int track_index = 0; track_index < midi_file_->header.numberOfTracks; ++track_index) {
-        MidiTrack track_copy = midi_file_->tracks[track_index];
-        MidiEvent event{};
-
-        while (midi_read_next_event(&track_copy, &event)) {
-            uint32_t absolute_tick = track_copy.currentTick;
+void MidiVideoOutput::BuildTempoMapAndStats(LoadedMidiSource& source) {
+    if (!source.file) {
+        return;
+    }
 
-            if (event.eventType == MIDI_EVENT_META && event.metaType == MIDI_META_SET_TEMPO && event.metaLength == 3) {
-                uint32_t tempo = (event.metaData[0] << 16) | (event.metaData[1] << 8) | event.metaData[2];
-                tempo_changes_.push_back({absolute_tick, tempo});
-            }
+    // トラックごとの走査結果（トラック単位で並列に走査し、トラック順に結合する）
+    struct TrackScan {
+        std::vector<TempoChange> tempo_changes;
+        std::vector<TimeSignatureChange> time_signatures;
+        size_t event_count = 0;
+        size_t note_count = 0;
+        uint64_t last_event_tick = 0;
+    };
+
+    const MidiFile* midi_file = source.file.get();
+    std::vector<TrackScan> scans(midi_file->header.numberOfTracks);
+    TaskSystem::Instance().ParallelFor(0, scans.size(), 1, [&](size_t first_track, size_t last_track) {
+        for (size_t track_index = first_track; track_index < last_track; ++track_index) {
+            TrackScan& scan = scans[track_index];
+            for (const MidiTrackEvent& event :
+                 ReadTrackEvents<MidiEventKind::Notes | MidiEventKind::Tempo | MidiEventKind::Meta>(
+                     midi_file->tracks[track_index])) {
+                if (event.kind == MidiEventKind::Tempo) {
+                    scan.tempo_changes.push_back({event.tick, event.tempo});
+                    continue;
+                }
+                if (event.kind == MidiEventKind::Meta) {
+                    if (event.meta_type == MIDI_META_TIME_SIGNATURE && event.payload_length >= 2) {
+                        scan.time_signatures.push_back({event.tick, event.payload[0], event.payload[1]});
+                    }
+                    continue;
+                }
 
-            if ((event.eventType == MIDI_EVENT_NOTE_ON && event.data2 > 0) ||
-                event.eventType == MIDI_EVENT_NOTE_OFF ||
-                (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 == 0)) {
-                total_event_count_++;
-                if (event.eventType == MIDI_EVENT_NOTE_ON && event.data2 > 0) {
-                    total_note_count_++;
+                scan.event_count++;
+                if (event.IsNoteOn()) {
+                    scan.note_count++;
                 }
-                if (absolute_tick > last_event_tick_) {
-                    last_event_tick_ = absolute_tick;
+                if (event.tick > scan.last_event_tick) {
+                    scan.last_event_tick = event.tick;
                 }
             }
-
-            midi_free_event(&event);
-            event = MidiEvent{};
-        }
-    }
-
-    std::sort(tempo_changes_.begin(), tempo_changes_.end(),
-              [](const TempoChange& a, const TempoChange& b) {
-                  return a.tick < b.tick;
-              });
-
-    if (!tempo_changes_.empty()) {
-        current_tempo_ = tempo_changes_.front().tempo;
-    }
-}
-
-// midiplayer-baseを参考にした改良時間計算
-double MidiVideoOutput::CalculateElapsedTimeFromTick(uint32_t targetTick) const {
-    if (!midi_file_ || midi_file_->header.timeDivision <= 0) {
-        return 0.0;
-    }
-    
-    double totalSeconds = 0.0;
-    uint32_t currentTick = 0;
-    uint32_t currentTempo = current_tempo_; // デフォルトテンポ
-    
-    // テンポマップが空の場合はデフォルトテンポで計算
-    if (tempo_changes_.empty()) {
-        return TicksToSeconds(targetTick, midi_file_->header.timeDivision, currentTempo);
-    }
-    
-    // 最初のテンポ変更が0ティックでない場合の初期区間
-    if (!tempo_changes_.empty() && tempo_changes_[0].tick > 0) {
-        uint32_t initialTicks = std::min(targetTick, tempo_changes_[0].tick);
-        totalSeconds += TicksToSeconds(initialTicks, midi_file_->header.timeDivision, currentTempo);
-        currentTick = initialTicks;
-        
-        if (targetTick <= tempo_changes_[0].tick) {
-            return totalSeconds;
         }
-    }
-    
-    // テンポマップを使って区間ごとに計算
-    for (size_t i = 0; i < tempo_changes_.size(); i++) {
-        const auto& tempoChange = tempo_changes_[i];
-        
-        // 現在のテンポを更新
-        currentTempo = tempoChange.tempo;
-        
-        // 次の区間の終点を決定
-        uint32_t nextTick = (i < tempo_changes_.size() - 1) ? 
-                           tempo_changes_[i + 1].tick : 
-                           targetTick;
-        
-        // 区間の開始位置を調整
-        uint32_t segmentStart = std::max(currentTick, tempoChange.tick);
-        uint32_t segmentEnd = std::min(targetTick, nextTick);
-        
-        if (segmentStart < segmentEnd) {
-            uint32_t segmentTicks = segmentEnd - segmentStart;
-            totalSeconds += TicksToSeconds(segmentTicks, midi_file_->header.timeDivision, currentTempo);
-            currentTick = segmentEnd;
-        }
-        
-        // 目標ティックに達した場合は終了
-        if (targetTick <= nextTick) {
-            break;
-        }
-    }
-    
-    return totalSeconds;
-}
+    });
 
-double MidiVideoOutput::TicksToSeconds(uint32_t ticks, uint32_t division, uint32_t tempo) const {
-    if (division & 0x8000) {
-        // SMPTE時間（現在は簡易実装）
-        return static_cast<double>(ticks) / 1000.0;
-    } else {
-        // 音楽時間
-        // tempo = マイクロ秒 per quarter note
-        // division = ticks per quarter note
-        double quarter_notes = static_cast<double>(ticks) / division;
-        double seconds_per_quarter = tempo / 1000000.0;  // マイクロ秒を秒に変換
-        return quarter_notes * seconds_per_quarter;
-    }
+    std::vector<TempoChange> tempo_changes;
+    tempo_changes.push_back({0, MidiTempoMap::kDefaultTempo});
+    source.last_event_tick = 0;
+    source.event_count = 0;
+    source.note_count = 0;
+    source.time_signatures.clear();
+    for (const TrackScan& scan : scans) {
+        tempo_changes.insert(tempo_changes.end(), scan.tempo_changes.begin(), scan.tempo_changes.end());
+        source.time_signatures.insert(source.time_signatures.end(), scan.time_signatures.begin(), scan.time_signatures.end());
+        source.event_count += scan.event_count;
+        source.note_count += scan.note_count;
+        source.last_event_tick = std::max(source.last_event_tick, scan.last_event_tick);
+    }
+    source.has_note_events = source.event_count > 0;
+    std::stable_sort(source.time_signatures.begin(), source.time_signatures.end(),
+                     [](const TimeSignatureChange& lhs, const TimeSignatureChange& rhs) { return lhs.tick < rhs.tick; });
+
+    source.tempo_map.Build(std::move(tempo_changes), midi_file->header.timeDivision);
 }
 
 bool MidiVideoOutput::SaveFrameToFile(const std::string& filepath) {
@@ -983,6 +1307,21 @@ std::vector<uint8_t> MidiVideoOutput::CaptureFramebuffer() {
     }
 }
 
+bool MidiVideoOutput::CaptureFramebufferInto(uint8_t* destination) {
+    if (!renderer_) {
+        return false;
+    }
+    
+    int width = video_settings_.width;
+    int height = video_settings_.height;
+    
+    if (video_settings_.use_gpu_optimized_capture) {
+        return renderer_->ReadFramebufferPBOInto(width, height, destination);
+    } else {
+        return renderer_->ReadFramebufferInto(width, height, destination);
+    }
+}
+
 void MidiVideoOutput::CreateOutputDirectory() {
     CreateDirectoryRecursive(output_directory_);
 }
@@ -1029,7 +1368,7 @@ void MidiVideoOutput::RenderMidiControls() {
             // 再生情報
             ImGui::Text("Duration: %.1f seconds", total_duration_);
             ImGui::Text("Events: %zu", total_event_count_);
-            ImGui::Text("Notes: %d", total_note_count_);
+            ImGui::Text("Notes: %zu", total_note_count_);
             
             // 再生制御
             if (ImGui::Button("Play")) Play();
@@ -1100,6 +1439,7 @@ void MidiVideoOutput::RenderVideoOutputUI() {
         
         ImGui::Checkbox("Rainbow Effects", &video_settings_.show_rainbow_effects);
         ImGui::Checkbox("Key Blips", &video_settings_.show_key_blips);
+        ImGui::Checkbox("Note Stats Overlay", &video_settings_.show_note_stats);
         ImGui::Checkbox("GPU Optimized Capture", &video_settings_.use_gpu_optimized_capture);
         if (ImGui::IsItemHovered()) {
             ImGui::SetTooltip("Use PBO (Pixel Buffer Objects) for faster GPU-to-CPU data transfer");
@@ -1242,26 +1582,41 @@ std::vector<std::string> MidiVideoOutput::GetCodecSpecificSettings(const std::st
     return settings;
 }
 
-    Color MidiVideoOutput::DetermineBlipColor(uint8_t channel, size_t track_index) const {
-        const Color channel_color = MidiChannelColors::GetChannelColor(channel);
-        const Color track_color = MidiTrackColors::GetTrackColor(track_index);
-
-        switch (video_settings_.color_mode) {
-            case VideoOutputSettings::ColorMode::Track:
-                return track_color;
-            case VideoOutputSettings::ColorMode::Both: {
-                Color blended;
-                blended.r = std::clamp((channel_color.r + track_color.r) * 0.5f, 0.0f, 1.0f);
-                blended.g = std::clamp((channel_color.g + track_color.g) * 0.5f, 0.0f, 1.0f);
-                blended.b = std::clamp((channel_color.b + track_color.b) * 0.5f, 0.0f, 1.0f);
-                blended.a = std::clamp((channel_color.a + track_color.a) * 0.5f, 0.0f, 1.0f);
-                return blended;
+void MidiVideoOutput::RebuildBlipPalette() {
+    // カラーモードが変わったときだけ全組み合わせを計算し直す（ノートオンごとの分岐・ブレンドを避ける）
+    for (size_t track = 0; track < kBlipPaletteSize; ++track) {
+        const Color track_color = MidiTrackColors::GetTrackColor(track);
+        for (size_t channel = 0; channel < kBlipPaletteSize; ++channel) {
+            const Color channel_color = MidiChannelColors::GetChannelColor(static_cast<uint8_t>(channel));
+
+            Color color;
+            switch (video_settings_.color_mode) {
+                case VideoOutputSettings::ColorMode::Track:
+                    color = track_color;
+                    break;
+                case VideoOutputSettings::ColorMode::Both:
+                    color.r = std::clamp((channel_color.r + track_color.r) * 0.5f, 0.0f, 1.0f);
+                    color.g = std::clamp((channel_color.g + track_color.g) * 0.5f, 0.0f, 1.0f);
+                    color.b = std::clamp((channel_color.b + track_color.b) * 0.5f, 0.0f, 1.0f);
+                    color.a = std::clamp((channel_color.a + track_color.a) * 0.5f, 0.0f, 1.0f);
+                    break;
+                case VideoOutputSettings::ColorMode::Channel:
+                default:
+                    color = channel_color;
+                    break;
             }
-            case VideoOutputSettings::ColorMode::Channel:
-            default:
-                return channel_color;
+            blip_palette_[track * kBlipPaletteSize + channel] = color.ToPackedRGBA();
         }
     }
+}
+
+uint32_t MidiVideoOutput::DetermineBlipColor(uint8_t channel, size_t track_index, int color_offset) const {
+    // 複数ファイルのマージ時はファイルごとのオフセットだけパレットをずらす
+    const size_t offset = static_cast<size_t>(std::max(0, color_offset));
+    const size_t track = (track_index + offset) % kBlipPaletteSize;
+    const size_t channel_index = (channel + offset) % kBlipPaletteSize;
+    return blip_palette_[track * kBlipPaletteSize + channel_index];
+}
 
 // FFmpeg関連のメソッド実装
 bool MidiVideoOutput::InitializeFFmpeg() {
@@ -1285,7 +1640,13 @@ bool MidiVideoOutput::InitializeFFmpeg() {
     cmd << " -framerate " << video_settings_.fps; // フレームレート
     cmd << " -i pipe:0"; // 標準入力から読み取り
     if (video_settings_.include_audio) {
-        cmd << " -i \"" << video_settings_.audio_file_path << "\""; // 外部オーディオ入力
+        if (synth_pipe_.IsCreated()) {
+            // 内蔵シンセ: 範囲の開始位置から合成した16bitステレオPCM
+            cmd << " -f s16le -ar " << GetSynthSettings().sample_rate << " -ac 2";
+        } else if (video_settings_.start_frame > 0) {
+            cmd << " -ss " << video_settings_.start_frame * frame_time_; // 外部オーディオは範囲の開始位置から使う
+        }
+        cmd << " -i \"" << video_settings_.audio_file_path << "\""; // 音声入力
     }
     cmd << " -c:v " << video_settings_.video_codec; // ビデオコーデック: コマンドライン引数から設定
     
@@ -1319,7 +1680,11 @@ bool MidiVideoOutput::InitializeFFmpeg() {
 #ifdef _WIN32
     ffmpeg_process_ = _popen(command.c_str(), "wb");
 #else
-    ffmpeg_process_ = popen(command.c_str(), "w");
+    {
+        // 子プロセスは起動したスレッドのCPU集合を引き継ぐ（FFmpegのスレッド数もこの集合から決まる）
+        ScopedThreadAffinity encoder_affinity(video_settings_.encoder_cpus);
+        ffmpeg_process_ = popen(command.c_str(), "w");
+    }
 #endif
     
     if (!ffmpeg_process_) {
@@ -1344,6 +1709,8 @@ void MidiVideoOutput::FinalizeFFmpeg() {
         int result = pclose(ffmpeg_process_);
 #endif
         ffmpeg_process_ = nullptr;
+        last_encoder_exit_code_ = result;
+        StopAudioSynthesis();
         
         std::cout << "FFmpeg process closed with result: " << result << std::endl;
         
@@ -1355,25 +1722,25 @@ void MidiVideoOutput::FinalizeFFmpeg() {
     }
 }
 
-bool MidiVideoOutput::WriteFrameToFFmpeg(const std::vector<uint8_t>& frame_data) {
-    if (!ffmpeg_process_ || frame_data.empty()) {
+bool MidiVideoOutput::WriteFrameToFFmpeg(const uint8_t* frame_data, size_t frame_size) {
+    if (!ffmpeg_process_ || !frame_data || frame_size == 0) {
         std::cerr << "WriteFrameToFFmpeg failed: ffmpeg_process_=" << (ffmpeg_process_ ? "valid" : "null") 
-                  << ", frame_data.empty()=" << frame_data.empty() << std::endl;
+                  << ", frame_size=" << frame_size << std::endl;
         return false;
     }
     
-    size_t expected_size = video_settings_.width * video_settings_.height * 4; // RGBA
-    if (frame_data.size() != expected_size) {
+    size_t expected_size = static_cast<size_t>(video_settings_.width) * video_settings_.height * 4; // RGBA
+    if (frame_size != expected_size) {
         std::cerr << "Frame data size mismatch. Expected: " << expected_size 
-                  << ", Got: " << frame_data.size() << std::endl;
+                  << ", Got: " << frame_size << std::endl;
         return false;
     }
     
     // フレームデータをFFmpegプロセスに書き込み
-    size_t written = fwrite(frame_data.data(), 1, frame_data.size(), ffmpeg_process_);
-    if (written != frame_data.size()) {
+    size_t written = fwrite(frame_data, 1, frame_size, ffmpeg_process_);
+    if (written != frame_size) {
         std::cerr << "Failed to write frame data to FFmpeg. Written: " << written 
-                  << ", Expected: " << frame_data.size() << ", ferror: " << ferror(ffmpeg_process_) << std::endl;
+                  << ", Expected: " << frame_size << ", ferror: " << ferror(ffmpeg_process_) << std::endl;
         return false;
     }
     
@@ -1411,113 +1778,142 @@ void MidiVideoOutput::UpdateDebugInfo() {
 }
 
 // デバッグオーバーレイの描画
+// 毎フレームの処理は整数キーの比較と、値が変わった行の snprintf だけ
 void MidiVideoOutput::RenderDebugOverlay() {
     if (!video_settings_.show_debug_info || !renderer_) {
         return;
     }
     
-    // 現在時刻の文字列を生成
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&time_t);
+    DebugOverlayCache& cache = debug_overlay_;
+    
+    // パネルと各行の位置は動画サイズが変わったときだけ計算
+    if (!cache.layout_ready || cache.layout_height != video_settings_.height) {
+        const float padding = 10.0f;
+        const float line_height = 24.0f;
+        const float panel_width = 380.0f;  // デバッグ情報用のパネル幅
+        const float panel_height = DebugOverlayCache::LineCount * line_height + padding * 2;
+        
+        // 左下の位置（少し余白を取る）
+        cache.panel_position = Vec2(15.0f, video_settings_.height - panel_height - 15.0f);
+        cache.panel_size = Vec2(panel_width, panel_height);
+        for (int i = 0; i < DebugOverlayCache::LineCount; ++i) {
+            cache.line_positions[i] = Vec2(cache.panel_position.x + padding,
+                                           cache.panel_position.y + padding + line_height * i);
+        }
+        cache.layout_height = video_settings_.height;
+        cache.layout_ready = true;
+        cache.keys.fill(DebugOverlayCache::kInvalidKey);  // 行の位置が変わったので頂点も作り直す
+    }
+    
+    // key が前回と異なる行だけ再フォーマットし、文字列が実際に変わった行だけグリフ頂点を作り直す
+    auto update_line = [this, &cache](int line, int64_t key, auto&& format) {
+        if (cache.keys[line] == key) {
+            return;
+        }
+        const bool first_build = cache.keys[line] == DebugOverlayCache::kInvalidKey;
+        cache.keys[line] = key;
+        format(cache.buffers[line], sizeof(cache.buffers[line]));
+        if (!first_build && cache.lines[line] == cache.buffers[line]) {
+            return;
+        }
+        cache.lines[line].assign(cache.buffers[line]);
+        renderer_->BuildTextMesh(cache.lines[line], cache.line_positions[line], 2.0f, cache.meshes[line]);  // フォントサイズを2倍に
+    };
+    
+    // 日時・期間を "[Nd/]H:MM:SS" 形式にする
+    auto format_duration = [](char* out, size_t size, const char* label, int64_t total_seconds) {
+        int64_t days = total_seconds / 86400;
+        int hours = static_cast<int>((total_seconds % 86400) / 3600);
+        int minutes = static_cast<int>((total_seconds % 3600) / 60);
+        int seconds = static_cast<int>(total_seconds % 60);
+        if (days > 0) {
+            std::snprintf(out, size, "%s%lldd/%d:%02d:%02d", label, static_cast<long long>(days), hours, minutes, seconds);
+        } else {
+            std::snprintf(out, size, "%s%d:%02d:%02d", label, hours, minutes, seconds);
+        }
+    };
+    
+    // 現在時刻（秒が変わったときだけ localtime/strftime）
+    const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    update_line(DebugOverlayCache::RealTime, static_cast<int64_t>(now), [now](char* out, size_t size) {
+        auto tm = *std::localtime(&now);
+        char real_time_str[32];
+        std::strftime(real_time_str, sizeof(real_time_str), "%Y/%m/%d %H:%M:%S", &tm);
+        std::snprintf(out, size, "RealTime: %s", real_time_str);
+    });
     
-    char real_time_str[64];
-    std::strftime(real_time_str, sizeof(real_time_str), "%Y/%m/%d %H:%M:%S", &tm);
+    update_line(DebugOverlayCache::Renderer, 0, [this](char* out, size_t size) {
+        std::snprintf(out, size, "Renderer: %s", renderer_->GetName());
+    });
     
-    // 経過時間の計算
-    int elapsed_days = static_cast<int>(debug_info_.elapsed_seconds) / 86400;
-    int elapsed_hours = (static_cast<int>(debug_info_.elapsed_seconds) % 86400) / 3600;
-    int elapsed_minutes = (static_cast<int>(debug_info_.elapsed_seconds) % 3600) / 60;
-    int elapsed_seconds = static_cast<int>(debug_info_.elapsed_seconds) % 60;
+    // 経過時間と ETA（推定残り時間）
+    const int64_t elapsed_seconds = static_cast<int64_t>(debug_info_.elapsed_seconds);
+    update_line(DebugOverlayCache::Elapsed, elapsed_seconds, [&](char* out, size_t size) {
+        format_duration(out, size, "Elapsed: ", elapsed_seconds);
+    });
     
-    // ETA（推定残り時間）の計算
     double remaining_seconds = debug_info_.estimated_total_duration - debug_info_.elapsed_seconds;
     if (remaining_seconds < 0) remaining_seconds = 0;
+    const int64_t eta_seconds = static_cast<int64_t>(remaining_seconds);
+    update_line(DebugOverlayCache::Eta, eta_seconds, [&](char* out, size_t size) {
+        format_duration(out, size, "ETA: ", eta_seconds);
+    });
+    
+    const int64_t frame_count = debug_info_.current_frame_count;
+    update_line(DebugOverlayCache::FrameCount, frame_count, [frame_count](char* out, size_t size) {
+        std::snprintf(out, size, "FrameCount: %lld", static_cast<long long>(frame_count));
+    });
     
-    int eta_days = static_cast<int>(remaining_seconds) / 86400;
-    int eta_hours = (static_cast<int>(remaining_seconds) % 86400) / 3600;
-    int eta_minutes = (static_cast<int>(remaining_seconds) % 3600) / 60;
-    int eta_secs = static_cast<int>(remaining_seconds) % 60;
+    const int64_t draw_calls = renderer_->GetDrawCallCount();
+    update_line(DebugOverlayCache::DrawCalls, draw_calls, [draw_calls](char* out, size_t size) {
+        std::snprintf(out, size, "DrawCalls: %lld", static_cast<long long>(draw_calls));
+    });
     
-    // デバッグ情報の文字列を構築
-    std::ostringstream debug_text;
-    debug_text << "RealTime: " << real_time_str << "\n";
-    debug_text << "Renderer: " << renderer_->GetName() << "\n";
+    // FPS と Speed の計算（60FPSを基準として速度倍率を算出、表示精度の0.1単位で比較）
+    const double target_fps = 60.0; // 標準フレームレート
+    const double current_fps = debug_info_.current_fps;
+    update_line(DebugOverlayCache::FpsSpeed, std::llround(current_fps * 10.0), [&](char* out, size_t size) {
+        std::snprintf(out, size, "FPS/Speed: %.1f/%.1fx", current_fps, current_fps / target_fps);
+    });
     
-    if (elapsed_days > 0) {
-        debug_text << "Elapsed: " << elapsed_days << "d/" << elapsed_hours << ":" 
-                   << std::setfill('0') << std::setw(2) << elapsed_minutes << ":" 
-                   << std::setfill('0') << std::setw(2) << elapsed_seconds << "\n";
-    } else {
-        debug_text << "Elapsed: " << elapsed_hours << ":" 
-                   << std::setfill('0') << std::setw(2) << elapsed_minutes << ":" 
-                   << std::setfill('0') << std::setw(2) << elapsed_seconds << "\n";
-    }
+    // 背景パネルとフレーム（半透明の黒 + 明るいグレー）
+    renderer_->DrawRectWithBorder(cache.panel_position, cache.panel_size,
+                                  Color(0.0f, 0.0f, 0.0f, 0.7f), Color(0.8f, 0.8f, 0.8f, 1.0f), 2.0f);
     
-    if (eta_days > 0) {
-        debug_text << "ETA: " << eta_days << "d/" << eta_hours << ":" 
-                   << std::setfill('0') << std::setw(2) << eta_minutes << ":" 
-                   << std::setfill('0') << std::setw(2) << eta_secs << "\n";
-    } else {
-        debug_text << "ETA: " << eta_hours << ":" 
-                   << std::setfill('0') << std::setw(2) << eta_minutes << ":" 
-                   << std::setfill('0') << std::setw(2) << eta_secs << "\n";
-    }
-    
-    debug_text << "FrameCount: " << debug_info_.current_frame_count << "\n";
-    debug_text << "DrawCalls: " << renderer_->GetDrawCallCount() << "\n";
-    
-    // FPS と Speed の計算（60FPSを基準として速度倍率を算出）
-    double target_fps = 60.0; // 標準フレームレート
-    double speed_multiplier = debug_info_.current_fps / target_fps;
-    
-    debug_text << "FPS/Speed: " << std::fixed << std::setprecision(1) << debug_info_.current_fps 
-               << "/" << std::setprecision(1) << speed_multiplier << "x";
-    
-    // デバッグ情報のレイアウト計算
-    std::istringstream stream(debug_text.str());
-    std::string line;
-    std::vector<std::string> lines;
-    while (std::getline(stream, line)) {
-        lines.push_back(line);
-    }
-    
-    // パネルの寸法計算
-    float padding = 10.0f;
-    float line_height = 24.0f;
-    float panel_width = 380.0f;  // デバッグ情報用のパネル幅
-    float panel_height = lines.size() * line_height + padding * 2;
-    
-    // 左下の位置（少し余白を取る）
-    Vec2 panel_position(15.0f, video_settings_.height - panel_height - 15.0f);
-    
-    // 背景パネルを描画（半透明の黒）
-    Color panel_bg_color(0.0f, 0.0f, 0.0f, 0.7f); // 半透明の黒
-    renderer_->DrawRect(panel_position, Vec2(panel_width, panel_height), panel_bg_color);
-    
-    // フレームを描画（明るいグレー）
-    Color frame_color(0.8f, 0.8f, 0.8f, 1.0f); // 明るいグレー
-    float frame_thickness = 2.0f;
-    
-    // 上辺
-    renderer_->DrawRect(Vec2(panel_position.x, panel_position.y), 
-                       Vec2(panel_width, frame_thickness), frame_color);
-    // 下辺
-    renderer_->DrawRect(Vec2(panel_position.x, panel_position.y + panel_height - frame_thickness), 
-                       Vec2(panel_width, frame_thickness), frame_color);
-    // 左辺
-    renderer_->DrawRect(Vec2(panel_position.x, panel_position.y), 
-                       Vec2(frame_thickness, panel_height), frame_color);
-    // 右辺
-    renderer_->DrawRect(Vec2(panel_position.x + panel_width - frame_thickness, panel_position.y), 
-                       Vec2(frame_thickness, panel_height), frame_color);
-    
-    // テキストを描画（背景パネルの中に）
-    Color debug_color(1.0f, 1.0f, 1.0f, 1.0f); // 白色
-    Vec2 text_position(panel_position.x + padding, panel_position.y + padding);
-    
-    for (size_t i = 0; i < lines.size(); i++) {
-        Vec2 line_position(text_position.x, text_position.y + line_height * i);
-        renderer_->DrawText(lines[i], line_position, debug_color, 2.0f); // フォントサイズを2倍に
+    // テキストを描画（背景パネルの中に、キャッシュした頂点をそのまま送る）
+    const Color debug_color(1.0f, 1.0f, 1.0f, 1.0f); // 白色
+    for (int i = 0; i < DebugOverlayCache::LineCount; ++i) {
+        renderer_->DrawTextMesh(cache.meshes[i], debug_color);
     }
+}
+
+// ノート数 / NPS / 同時発音数オーバーレイの描画
+void MidiVideoOutput::RenderNoteStatsOverlay() {
+    // タイムラインはロード時（または SetVideoSettings）に作ってあるので、ここでは参照するだけ
+    if (!video_settings_.show_note_stats || !renderer_ || !note_stats_.IsBuilt()) {
+        return;
+    }
+
+    // フレームごとの値はすべて累積和からのO(1)参照
+    const uint64_t notes_played = std::min<uint64_t>(note_stats_.GetNotesPlayed(current_time_), total_note_count_);
+    const uint64_t notes_per_second = note_stats_.GetNotesPerSecond(current_time_);
+    const uint32_t polyphony = note_stats_.GetPolyphony(current_time_);
+
+    char text[160];
+    std::snprintf(text, sizeof(text), "Notes: %llu / %llu\nNPS: %llu\nPolyphony: %u",
+                  static_cast<unsigned long long>(notes_played),
+                  static_cast<unsigned long long>(total_note_count_),
+                  static_cast<unsigned long long>(notes_per_second),
+                  polyphony);
+
+    const float scale = 2.0f;
+    const float padding = 10.0f;
+    Vec2 text_size = renderer_->GetTextSize(text, scale);
+    Vec2 panel_position(15.0f, 15.0f);
+    Vec2 panel_size(text_size.x + padding * 2, text_size.y + padding * 2);
+
+    // 背景1枚 + 文字列1回のDrawTextで描画（バックエンド側でまとめて描画される）
+    renderer_->DrawRect(panel_position, panel_size, Color(0.0f, 0.0f, 0.0f, 0.6f));
+    renderer_->DrawText(text, Vec2(panel_position.x + padding, panel_position.y + padding),
+                        Color(1.0f, 1.0f, 1.0f, 1.0f), scale);
 }
\ No newline at end of file
@@ -7,9 +7,16 @@
 #include <functional>
 #include <fstream>
 #include <queue>
+#include <mutex>
+#include <array>
+#include <thread>
 #include "midi_parser.h"
+#include "midi_event_decoder.h"
+#include "midi_audio_synth.h"
 #include "piano_keyboard.h"
 #include "renderer.h"
+#include "frame_buffer_pool.h"
+#include "audio_pipe.h"
 
 #if defined(_MSC_VER)
 #pragma execution_character_set("utf-8")
@@ -73,10 +80,25 @@ struct VideoOutputSettings {
     };
 
     ColorMode color_mode = ColorMode::Channel;
+
+    // 複数鍵盤表示時のノート振り分け（鍵盤i にはチャンネル/トラック番号 % 鍵盤数 == i のノート）
+    enum class KeyboardSplit {
+        Channel,
+        Track
+    };
+
+    KeyboardSplit keyboard_split = KeyboardSplit::Channel;
     
     // 再生設定
     float playback_speed = 1.0f;    // 再生速度倍率
     float key_press_duration = 0.1f; // キー押下継続時間（秒）
+    double decode_ahead_seconds = 2.0; // デコードスレッドが再生位置より先読みする秒数
+    std::vector<int> encoder_cpus;     // FFmpegを固定するCPU（空 = 制限なし）
+    int temporal_samples = 1;          // 1フレームあたりのサブフレーム数（1 = 時間方向スーパーサンプリングなし）
+    // 出力するフレーム範囲 [start_frame, end_frame)（--start / --end、分散レンダリングのセグメント用。
+    // end_frame = -1 で最後まで）。フレーム番号は全体をレンダリングした場合の動画内の番号と一致する
+    int start_frame = 0;
+    int end_frame = -1;
     
     // 視覚効果設定
     bool show_rainbow_effects = true;  // カラーブリップエフェクト（MIDIチャンネル色）
@@ -85,53 +107,53 @@ struct VideoOutputSettings {
     
     // GPU最適化設定
     bool use_gpu_optimized_capture = true;  // PBO使用でGPU最適化フレームキャプチャ
+    bool use_huge_pages = true;             // フレームバッファをラージページで確保
     
     // デバッグ情報設定
     bool show_debug_info = false;  // 動画内にデバッグ情報を表示
+    bool show_note_stats = false;  // ノート数 / NPS / 同時発音数のオーバーレイを表示
     
     // オーディオ設定（将来の拡張用）
     bool include_audio = false;
     std::string audio_file_path;
     int audio_bitrate = 192000; // 192 kbps
+    bool synthesize_audio = false;      // 内蔵シンセでノートから音声を生成（include_audio が無効な場合のみ）
+    int synth_max_voices = 131072;      // 内蔵シンセの同時発音数上限
     
     // FFmpeg executable path (empty = use default "ffmpeg" from PATH)
     std::string ffmpeg_executable_path;
 };
 
-// MIDIイベントとタイミング情報
-struct TimedMidiEvent {
-    MidiEvent event;
-    double time_seconds;     // 絶対時間（秒）
-    uint32_t tick;          // MIDI ティック
-    bool processed;         // このイベントが処理されたか
-};
-
-struct TempoChange {
-    uint32_t tick;          // 変更が発生するティック
-    uint32_t tempo;         // マイクロ秒/四分音符
+// マージ再生する入力MIDIの指定（リミックス用に複数ファイルを1つの鍵盤に重ねる）
+struct MidiInputSource {
+    std::string path;
+    double time_offset_seconds = 0.0;  // 再生開始からのオフセット（秒）
+    int color_offset = 0;              // カラーパレットのインデックスオフセット
 };
 
-struct StreamingTrackState {
-    MidiTrack track_state{};
-    MidiEvent current_event{};
-    bool has_event{false};
-    uint32_t event_tick{0};
-    double event_time{0.0};
+// 拍子変更（Time Signature メタイベント）
+struct TimeSignatureChange {
+    uint64_t tick;
+    uint8_t numerator;           // 1小節の拍数
+    uint8_t denominator_power;   // 拍の音価（2 の累乗: 2 = 四分音符）
 };
 
-struct PendingEvent {
-    size_t track_index{0};
-    double time_seconds{0.0};
-    uint32_t tick{0};
-};
+// 読み込み済みの入力MIDI
+struct LoadedMidiSource {
+    struct FileDeleter {
+        void operator()(MidiFile* file) const { midi_free_file(file); }
+    };
 
-struct PendingEventCompare {
-    bool operator()(const PendingEvent& lhs, const PendingEvent& rhs) const {
-        if (lhs.time_seconds == rhs.time_seconds) {
-            return lhs.tick > rhs.tick;
-        }
-        return lhs.time_seconds > rhs.time_seconds;
-    }
+    std::unique_ptr<MidiFile, FileDeleter> file;
+    std::string path;
+    MidiTempoMap tempo_map;            // ファイルごとのテンポマップ
+    double time_offset_seconds = 0.0;
+    int color_offset = 0;
+    uint64_t last_event_tick = 0;
+    bool has_note_events = false;
+    size_t event_count = 0;            // ノートイベント数（オン + オフ）
+    size_t note_count = 0;             // ノートオン数
+    std::vector<TimeSignatureChange> time_signatures;  // 拍子変更（小節番号 → ティックの変換用）
 };
 
 // デバッグ情報構造体
@@ -147,6 +169,40 @@ struct DebugInfo {
                   current_frame_count(0), current_fps(0.0) {}
 };
 
+// デバッグオーバーレイの表示キャッシュ
+// 行のレイアウトは1回だけ計算し、各行の文字列は値が変わったときだけ再フォーマットする
+struct DebugOverlayCache {
+    enum Line {
+        RealTime,
+        Renderer,
+        Elapsed,
+        Eta,
+        FrameCount,
+        DrawCalls,
+        FpsSpeed,
+        LineCount
+    };
+
+    static constexpr int64_t kInvalidKey = INT64_MIN;
+
+    std::array<char[64], LineCount> buffers{};      // snprintf の出力先（固定長）
+    std::array<std::string, LineCount> lines;       // 表示中の文字列（容量は再利用される）
+    std::array<TextMesh, LineCount> meshes;         // 行ごとのグリフ頂点（文字列が変わったときだけ作り直す）
+    std::array<int64_t, LineCount> keys{};          // 前回フォーマットした値
+    std::array<Vec2, LineCount> line_positions{};
+    Vec2 panel_position;
+    Vec2 panel_size;
+    int layout_height = 0;                          // レイアウト計算時の動画高さ
+    bool layout_ready = false;
+
+    DebugOverlayCache() { Invalidate(); }
+
+    void Invalidate() {
+        keys.fill(kInvalidKey);
+        layout_ready = false;
+    }
+};
+
 // MIDI動画出力クラス
 class MidiVideoOutput {
 public:
@@ -155,10 +211,13 @@ public:
 
     // 初期化
     bool Initialize(PianoKeyboard* piano_keyboard, RendererBackend* renderer);
+    // 鍵盤を複数並べる場合に全鍵盤を登録する（ノートは video_settings_.keyboard_split で振り分け）
+    bool SetKeyboards(const std::vector<PianoKeyboard*>& keyboards);
     void Cleanup();
 
     // MIDIファイル操作
     bool LoadMidiFile(const std::string& filepath);
+    bool LoadMidiFiles(const std::vector<MidiInputSource>& inputs);  // 複数ファイルをマージして読み込み
     void UnloadMidiFile();
     bool IsMidiLoaded() const;
     
@@ -187,44 +246,90 @@ public:
     
     // 更新とレンダリング
     void Update(double delta_time);
+    // 時間方向スーパーサンプリング: サブフレーム sample_index の時刻までイベントを進める
+    // （Update は最初のサブフレームまでしか進めないので、描画ループが残りを順に呼ぶ）
+    void AdvanceSubFrame(int sample_index);
+    // リアルタイム再生: 外部の定常クロックで決めた時刻まで再生位置を進める（Update の代わりに使う）
+    // 描画が遅れた分のフレームは描かずに飛ばし、間のイベントはまとめて処理する
+    void UpdateToTime(double time_seconds);
+    // ライブ入力（--live-midi）: 受信したノートをファイルのイベントと同じ経路で鍵盤とブリップに反映し、
+    // 押下継続時間を過ぎたキーを離す。time_seconds は UpdateToTime と同じ時間軸での到着時刻
+    // （ファイルを読み込まずに使ってもよい）
+    void ProcessLiveEvents(const std::vector<DecodedMidiEvent>& events, double current_time);
     bool CaptureFrame(); // 現在のフレームをキャプチャ
     
     // 状態取得
     MidiPlaybackState GetPlaybackState() const;
     double GetCurrentTime() const;
     double GetTotalDuration() const;
+    int GetTotalFrameCount() const;     // 全体をレンダリングした場合の動画のフレーム数
+    int GetFrameAtTime(double time_seconds) const;  // その時刻を表示する動画内のフレーム番号
+    // プライマリファイルのティック / 小節番号（1始まり）の再生開始からの時刻
+    double GetTickTime(uint64_t tick) const;
+    double GetBarStartTime(int bar) const;
+    // 範囲の途中から録画する場合の、最初のフレームより手前の空回し中か（描画は省略してよい）
+    bool IsPreRolling() const;
+    int GetCapturedFrameCount() const { return frame_count_; }
+    int GetLastEncoderExitCode() const { return last_encoder_exit_code_; }  // 直前の録画のFFmpeg終了コード
     float GetProgress() const; // 0.0 - 1.0
     
+    // 内蔵シンセでフレーム範囲の音声を WAV に書き出す（分散レンダリングの連結用。録画中はパイプで流す）
+    bool SynthesizeAudio(const std::string& wav_path) const;
+    
     // 設定
     VideoOutputSettings& GetVideoSettings();
     const VideoOutputSettings& GetVideoSettings() const;
     void SetVideoSettings(const VideoOutputSettings& settings);
     
     // MIDI情報取得
-    const MidiFile* GetMidiFile() const;
-    std::vector<TimedMidiEvent> GetEventsInRange(double start_time, double end_time) const;
-    int GetTotalNoteCount() const;
+    const MidiFile* GetMidiFile(size_t source_index = 0) const;
+    size_t GetMidiSourceCount() const;
+    // [start_time, end_time] のノートイベント（時間順のビュー、次のロード/アンロードまで有効）
+    DecodedEventRange GetEventsInRange(double start_time, double end_time) const;
+    size_t GetTotalNoteCount() const;
     int GetActiveNoteCount() const;
     
     // ImGui UI
     void RenderMidiControls();
     void RenderVideoOutputUI();
     void RenderDebugOverlay();  // デバッグ情報の描画（公開メソッド）
+    void RenderNoteStatsOverlay();  // ノート数 / NPS / 同時発音数の描画
     
     // コールバック設定
     void SetProgressCallback(std::function<void(float)> callback);
     void SetFrameCapturedCallback(std::function<void(int)> callback);
 
 private:
-    using PendingEventQueue = std::priority_queue<PendingEvent, std::vector<PendingEvent>, PendingEventCompare>;
     static constexpr double kTimeEpsilon = 1e-6;
 
     // 内部状態
     MidiPlaybackState playback_state_;
-    std::unique_ptr<MidiFile> midi_file_;
-    // ストリーミング再生用のトラック状態と次イベント待機キュー
-    std::vector<StreamingTrackState> streaming_tracks_;
-    PendingEventQueue pending_events_;
+    std::vector<LoadedMidiSource> sources_;  // 読み込み済みの入力MIDI（先頭がプライマリ）
+    // ストリーミング再生用の先読みデコーダー（別スレッドでブロック単位にデコード）
+    MidiEventDecoder event_decoder_;
+    // 時間方向スーパーサンプリング: 2番目以降のサブフレームのイベント（Update で先に取り出し、AdvanceSubFrame で処理）
+    std::vector<DecodedMidiEvent> sub_frame_events_;
+    size_t sub_frame_event_index_ = 0;
+    // 範囲問い合わせ用のイベントストア（初回の GetEventsInRange で構築）
+    mutable MidiEventStore event_store_;
+    mutable std::mutex event_store_mutex_;
+    // ノート統計オーバーレイ用のフレーム単位累積和（ロード時または SetVideoSettings で構築）
+    MidiNoteStatsTimeline note_stats_;
+    // シーク用チェックポイント: 一定間隔ごとのマージ状態と押下中の鍵盤（ロード時、鍵盤の構成が変わったときに構築）
+    // シークは目標時刻より前で最後のチェックポイントから再開し、0秒からイベントを消費し直さない
+    struct HeldKey {
+        uint32_t slot;        // 鍵盤番号 × 128 + ノート
+        double press_time;
+    };
+    struct SeekCheckpoint {
+        double time_seconds = 0.0;   // この時刻より前のイベントはすべて消費済み
+        size_t event_count = 0;
+        MidiEventMerger merger;
+        std::vector<HeldKey> held_keys;
+    };
+    static constexpr double kSeekCheckpointInterval = 5.0;
+    static constexpr size_t kSeekCheckpointBudgetBytes = 64u << 20;  // 全チェックポイントのマージ状態の合計の上限
+    std::vector<SeekCheckpoint> seek_checkpoints_;
     
     // タイミング管理
     double current_time_;
@@ -246,14 +351,24 @@ private:
     // FFmpeg関連
     FILE* ffmpeg_process_;
     std::string output_video_path_;
+    // リードバック先のフレームバッファ（録画開始時に確保）
+    // キャプチャとパイプ書き込みは同じスレッドで順に行うので、使用中のフレームは常に1枚
+    static constexpr size_t kFramesInFlight = 1;
+    FrameBufferPool frame_pool_;
+    // キャプチャした内容は PBO 読み出しで最大2フレーム遅れるので、途中から録画する場合はその分だけ手前から回して捨てる
+    static constexpr int kCaptureLatencyFrames = 2;
+    int last_encoder_exit_code_ = -1;
+    // 内蔵シンセの音声は録画中に別スレッドで合成し、パイプで FFmpeg の2つ目の入力に流す
+    AudioPipe synth_pipe_;
+    std::thread synth_thread_;
     
-    // 外部参照
-    PianoKeyboard* piano_keyboard_;
+    // 外部参照（鍵盤は1つ以上。先頭がメインの鍵盤）
+    std::vector<PianoKeyboard*> piano_keyboards_;
     RendererBackend* renderer_;
     
     // アクティブノート管理
-    std::vector<bool> active_notes_; // 128要素、各MIDIノートの状態
-    std::vector<std::chrono::steady_clock::time_point> note_press_times_; // ノート押下時刻
+    std::vector<bool> active_notes_; // 鍵盤数 × 128要素、各鍵盤・各MIDIノートの状態
+    std::vector<double> note_press_times_; // ノート押下時刻（再生位置の秒数、active_notes_ と同じ並び）
     
     // コールバック
     std::function<void(float)> progress_callback_;
@@ -267,36 +382,54 @@ private:
     
     // 内部メソッド
     void ProcessMidiEvents(double current_time);
-    void ProcessNoteEvent(const MidiEvent& event, double event_time, size_t track_index);
+    double GetSubFrameTime(int sample_index) const;
+    void CollectSubFrameEvents();
+    void ProcessNoteEvent(const DecodedMidiEvent& event);
+    void SetKeyboardAnimationTime(double time_seconds);
+    int GetPreRollFrameCount() const;
+    size_t GetKeyboardIndex(uint8_t channel, size_t global_track_index) const;
+    void ApplyNoteState(const DecodedMidiEvent& event, std::vector<bool>& note_state,
+                        std::vector<double>& note_on_times) const;
+    void ReleaseAllKeys();
     void UpdateActiveNotes(double current_time);
     void ResetStreamingState();
     void ClearStreamingResources();
-    bool LoadNextTrackEvent(size_t track_index);
-    double CalculateTotalDuration();
-    void BuildTempoMapAndStats();
-    double TicksToSeconds(uint32_t ticks, uint32_t division, uint32_t tempo) const;
-    double CalculateElapsedTimeFromTick(uint32_t targetTick) const;  // midiplayer-base式改良計算
+    AudioSynthSettings GetSynthSettings() const;
+    void GetSynthRange(double& start_seconds, double& end_seconds) const;
+    void StartAudioSynthesis();
+    void StopAudioSynthesis();
+    static double CalculateTotalDuration(const std::vector<LoadedMidiSource>& sources);
+    static std::vector<MidiDecodeSource> MakeDecodeSources(const std::vector<LoadedMidiSource>& sources);
+    void BuildNoteStats(const std::vector<LoadedMidiSource>& sources, double duration_seconds);
+    void BuildSeekCheckpoints(const std::vector<LoadedMidiSource>& sources, double duration_seconds);
+    void BuildTempoMapAndStats(LoadedMidiSource& source);
     bool SaveFrameToFile(const std::string& filepath);
     std::vector<uint8_t> CaptureFramebuffer();
+    bool CaptureFramebufferInto(uint8_t* destination);
     void CreateOutputDirectory();
     
     // FFmpeg関連メソッド
     bool InitializeFFmpeg();
     void FinalizeFFmpeg();
-    bool WriteFrameToFFmpeg(const std::vector<uint8_t>& frame_data);
+    bool WriteFrameToFFmpeg(const uint8_t* frame_data, size_t frame_size);
     std::vector<std::string> GetCodecSpecificSettings(const std::string& codec, bool use_cbr) const;
-    Color DetermineBlipColor(uint8_t channel, size_t track_index) const;
+    void RebuildBlipPalette();
+    uint32_t DetermineBlipColor(uint8_t channel, size_t track_index, int color_offset) const;
     
+    // ブリップ色テーブル（トラック16色 × チャンネル16色、パック済みRGBA8）
+    // チャンネル・トラックのパレットはどちらも16周期なので、カラーモードごとに256色で全組み合わせを網羅できる
+    static constexpr size_t kBlipPaletteSize = 16;
+    std::array<uint32_t, kBlipPaletteSize * kBlipPaletteSize> blip_palette_;
+
     // テンポ管理
-    uint32_t current_tempo_; // マイクロ秒/四分音符
-    std::vector<TempoChange> tempo_changes_; // テンポ変更のリスト
+    uint32_t current_tempo_; // マイクロ秒/四分音符（プライマリファイルの初期テンポ）
     
     // デバッグ・統計
-    int total_note_count_;
-    int processed_event_count_;
+    size_t total_note_count_;
+    size_t processed_event_count_;
     size_t total_event_count_;
-    uint32_t last_event_tick_;
     DebugInfo debug_info_;  // デバッグ情報
+    DebugOverlayCache debug_overlay_;  // デバッグオーバーレイの表示キャッシュ
     
     // ヘルパー関数
     static std::string GetTimestampString();
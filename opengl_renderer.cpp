@@ -1,16 +1,30 @@
 #include <glad/glad.h>
 #include "opengl_renderer.h"
 #include "simple_bitmap_font.h"
+#include "task_system.h"
 #include <iostream>
 #include <cmath>
 #include <vector>
 #include <cstring>
+#include <algorithm>
+#include <cstddef>
+
+// Rows per task when flipping read-back frames (about 0.5 MB per task at 1080p)
+static constexpr size_t kFlipRowsPerTask = 64;
 
 OpenGLRenderer::OpenGLRenderer() 
         : window_width_(800), window_height_(600), 
             draw_call_count_(0),
             framebuffer_(0), color_texture_(0), depth_renderbuffer_(0), offscreen_initialized_(false),
-      current_pbo_index_(0), pbo_initialized_(false) {
+      current_pbo_index_(0), pbo_initialized_(false),
+      accumulation_framebuffer_(0), accumulation_texture_(0),
+      static_layer_framebuffer_(0), static_layer_texture_(0),
+      output_framebuffer_(0), output_texture_(0), output_width_(0), output_height_(0),
+      keyboard_pipeline_state_(KeyboardPipelineState::Uninitialized),
+      keyboard_program_(0), keyboard_vao_(0), keyboard_quad_vbo_(0), keyboard_instance_vbo_(0),
+      keyboard_instance_capacity_(0),
+      keyboard_uniform_viewport_(-1), keyboard_uniform_press_(-1), keyboard_uniform_shape_(-1),
+      keyboard_uniform_top_(-1), keyboard_uniform_bottom_(-1), keyboard_uniform_border_(-1) {
     pbo_[0] = 0;
     pbo_[1] = 0;
 }
@@ -25,6 +39,33 @@ OpenGLRenderer::~OpenGLRenderer() {
         if (color_texture_) glDeleteTextures(1, &color_texture_);
         if (depth_renderbuffer_) glDeleteRenderbuffers(1, &depth_renderbuffer_);
     }
+
+    DestroyKeyboardPipeline();
+
+    if (accumulation_framebuffer_) {
+        glDeleteFramebuffers(1, &accumulation_framebuffer_);
+    }
+    if (accumulation_texture_) {
+        glDeleteTextures(1, &accumulation_texture_);
+    }
+    if (static_layer_framebuffer_) {
+        glDeleteFramebuffers(1, &static_layer_framebuffer_);
+    }
+    if (static_layer_texture_) {
+        glDeleteTextures(1, &static_layer_texture_);
+    }
+    if (output_framebuffer_) {
+        glDeleteFramebuffers(1, &output_framebuffer_);
+    }
+    if (output_texture_) {
+        glDeleteTextures(1, &output_texture_);
+    }
+
+    // Cleanup cached background textures
+    for (auto& entry : background_images_) {
+        if (entry.second.texture_id) glDeleteTextures(1, &entry.second.texture_id);
+    }
+    if (gradient_texture_.texture_id) glDeleteTextures(1, &gradient_texture_.texture_id);
 }
 
 void OpenGLRenderer::Initialize(int window_width, int window_height) {
@@ -72,11 +113,13 @@ bool OpenGLRenderer::LoadFont(float font_size) {
 }
 
 void OpenGLRenderer::ClearWithImage(const std::string& image_path, float opacity, int scale_mode) {
-    (void)image_path;
-    (void)opacity;
-    (void)scale_mode;
-    // Image background rendering is not implemented; fall back to solid clear.
     Clear(Color(0.0f, 0.0f, 0.0f, 1.0f));
+
+    // The image stays black until the worker thread has finished decoding it
+    BackgroundImage& image = background_images_[image_path];
+    if (LoadImageTexture(image_path, image)) {
+        DrawImageBackground(image, opacity, scale_mode);
+    }
 }
 
 void OpenGLRenderer::ClearWithRadialGradient(const Color& center_color, const Color& edge_color) {
@@ -84,30 +127,25 @@ void OpenGLRenderer::ClearWithRadialGradient(const Color& center_color, const Co
     glClearColor(edge_color.r, edge_color.g, edge_color.b, edge_color.a);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Draw radial gradient using triangle fan (elliptical to match window aspect ratio)
-    const int segments = 100; // Number of segments for smooth ellipse
-    const float center_x = window_width_ * 0.5f;
-    const float center_y = window_height_ * 0.5f;
-    const float radius_x = window_width_ * 0.7f;  // Horizontal radius
-    const float radius_y = window_height_ * 0.7f; // Vertical radius
+    // Rasterize the gradient only when the resolution or colors change, then draw one textured quad
+    auto same_color = [](const Color& a, const Color& b) {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    };
+    if (!gradient_texture_.loaded ||
+        gradient_texture_.width != window_width_ || gradient_texture_.height != window_height_ ||
+        !same_color(gradient_center_color_, center_color) || !same_color(gradient_edge_color_, edge_color)) {
+        UploadTexture(gradient_texture_,
+                      BackgroundImageCache::RasterizeRadialGradient(window_width_, window_height_,
+                                                                    center_color, edge_color));
+        gradient_center_color_ = center_color;
+        gradient_edge_color_ = edge_color;
+    }
 
-    IncrementDrawCallCount();
-    glBegin(GL_TRIANGLE_FAN);
-    
-    // Center vertex
-    glColor4f(center_color.r, center_color.g, center_color.b, center_color.a);
-    glVertex2f(center_x, center_y);
-    
-    // Edge vertices
-    glColor4f(edge_color.r, edge_color.g, edge_color.b, edge_color.a);
-    for (int i = 0; i <= segments; i++) {
-        float angle = 2.0f * 3.14159265359f * i / segments;
-        float x = center_x + radius_x * cos(angle);
-        float y = center_y + radius_y * sin(angle);
-        glVertex2f(x, y);
+    if (gradient_texture_.loaded) {
+        DrawTexturedQuad(gradient_texture_.texture_id, Vec2(0.0f, 0.0f),
+                         Vec2(static_cast<float>(window_width_), static_cast<float>(window_height_)),
+                         Color(1.0f, 1.0f, 1.0f, 1.0f));
     }
-    
-    glEnd();
 }
 
 void OpenGLRenderer::DrawRect(const Vec2& position, const Vec2& size, const Color& color) {
@@ -358,6 +396,214 @@ void OpenGLRenderer::DrawRectWithRoundedBorder(const Vec2& position, const Vec2&
     glDisable(GL_LINE_SMOOTH);
 }
 
+namespace {
+
+// Keys are drawn as instanced quads. The vertex shader applies the press animation to the
+// rest rectangle (same math as the CPU path) and the fragment shader evaluates the rounded
+// gradient fill and the centered rounded border from a signed distance.
+const char* kKeyboardVertexShader = R"(#version 330 core
+layout(location = 0) in vec2 a_corner;
+layout(location = 1) in vec4 a_rect;
+layout(location = 2) in float a_progress;
+
+uniform vec2 u_viewport;
+uniform vec2 u_press;   // x = press scale, y = press y offset
+uniform vec2 u_shape;   // x = corner radius, y = border width
+
+out vec2 v_local;
+out vec2 v_size;
+
+void main() {
+    float scale = 1.0 - (1.0 - u_press.x) * a_progress;
+    vec2 size = a_rect.zw * scale;
+    vec2 position = a_rect.xy + (a_rect.zw - size) * 0.5 + vec2(0.0, u_press.y * a_progress);
+
+    // Grow the quad so the outer half of the border and its anti-aliasing fit
+    float pad = u_shape.y * 0.5 + 1.0;
+    vec2 local = a_corner * (size + 2.0 * pad) - pad;
+    vec2 pixel = position + local;
+
+    v_local = local;
+    v_size = size;
+    gl_Position = vec4(pixel.x / u_viewport.x * 2.0 - 1.0, 1.0 - pixel.y / u_viewport.y * 2.0, 0.0, 1.0);
+}
+)";
+
+const char* kKeyboardFragmentShader = R"(#version 330 core
+in vec2 v_local;
+in vec2 v_size;
+
+uniform vec2 u_shape;
+uniform vec4 u_top;
+uniform vec4 u_bottom;
+uniform vec4 u_border;
+
+out vec4 frag_color;
+
+float RoundedRectDistance(vec2 p, vec2 half_size, float radius) {
+    vec2 q = abs(p) - half_size + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main() {
+    vec2 half_size = v_size * 0.5;
+    float radius = min(u_shape.x, min(half_size.x, half_size.y));
+    float distance = RoundedRectDistance(v_local - half_size, half_size, radius);
+
+    vec4 fill = mix(u_top, u_bottom, clamp(v_local.y / v_size.y, 0.0, 1.0));
+    float fill_alpha = fill.a * clamp(0.5 - distance, 0.0, 1.0);
+    float border_alpha = u_border.a * clamp(u_shape.y * 0.5 + 0.5 - abs(distance), 0.0, 1.0);
+
+    // Border over fill
+    float alpha = border_alpha + fill_alpha * (1.0 - border_alpha);
+    if (alpha <= 0.0) {
+        discard;
+    }
+    vec3 color = (u_border.rgb * border_alpha + fill.rgb * fill_alpha * (1.0 - border_alpha)) / alpha;
+    frag_color = vec4(color, alpha);
+}
+)";
+
+GLuint CompileKeyboardShader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        std::cerr << "Keyboard shader compile failed: " << log << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+} // namespace
+
+bool OpenGLRenderer::InitializeKeyboardPipeline() {
+    GLuint vertex_shader = CompileKeyboardShader(GL_VERTEX_SHADER, kKeyboardVertexShader);
+    GLuint fragment_shader = CompileKeyboardShader(GL_FRAGMENT_SHADER, kKeyboardFragmentShader);
+    if (!vertex_shader || !fragment_shader) {
+        if (vertex_shader) glDeleteShader(vertex_shader);
+        if (fragment_shader) glDeleteShader(fragment_shader);
+        return false;
+    }
+
+    keyboard_program_ = glCreateProgram();
+    glAttachShader(keyboard_program_, vertex_shader);
+    glAttachShader(keyboard_program_, fragment_shader);
+    glLinkProgram(keyboard_program_);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(keyboard_program_, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        char log[1024];
+        glGetProgramInfoLog(keyboard_program_, sizeof(log), nullptr, log);
+        std::cerr << "Keyboard shader link failed: " << log << std::endl;
+        glDeleteProgram(keyboard_program_);
+        keyboard_program_ = 0;
+        return false;
+    }
+
+    keyboard_uniform_viewport_ = glGetUniformLocation(keyboard_program_, "u_viewport");
+    keyboard_uniform_press_ = glGetUniformLocation(keyboard_program_, "u_press");
+    keyboard_uniform_shape_ = glGetUniformLocation(keyboard_program_, "u_shape");
+    keyboard_uniform_top_ = glGetUniformLocation(keyboard_program_, "u_top");
+    keyboard_uniform_bottom_ = glGetUniformLocation(keyboard_program_, "u_bottom");
+    keyboard_uniform_border_ = glGetUniformLocation(keyboard_program_, "u_border");
+
+    // Static unit quad shared by every key (triangle strip)
+    const float quad[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+
+    glGenVertexArrays(1, &keyboard_vao_);
+    glBindVertexArray(keyboard_vao_);
+
+    glGenBuffers(1, &keyboard_quad_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, keyboard_quad_vbo_);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+    // Per-key instance data, re-uploaded every frame
+    glGenBuffers(1, &keyboard_instance_vbo_);
+    glBindBuffer(GL_ARRAY_BUFFER, keyboard_instance_vbo_);
+    keyboard_instance_capacity_ = 128;
+    glBufferData(GL_ARRAY_BUFFER, keyboard_instance_capacity_ * sizeof(KeyboardKeyInstance), nullptr, GL_STREAM_DRAW);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(KeyboardKeyInstance),
+                          reinterpret_cast<const void*>(offsetof(KeyboardKeyInstance, x)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(KeyboardKeyInstance),
+                          reinterpret_cast<const void*>(offsetof(KeyboardKeyInstance, press_progress)));
+    glVertexAttribDivisor(2, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return true;
+}
+
+void OpenGLRenderer::DestroyKeyboardPipeline() {
+    if (keyboard_instance_vbo_) glDeleteBuffers(1, &keyboard_instance_vbo_);
+    if (keyboard_quad_vbo_) glDeleteBuffers(1, &keyboard_quad_vbo_);
+    if (keyboard_vao_) glDeleteVertexArrays(1, &keyboard_vao_);
+    if (keyboard_program_) glDeleteProgram(keyboard_program_);
+    keyboard_instance_vbo_ = 0;
+    keyboard_quad_vbo_ = 0;
+    keyboard_vao_ = 0;
+    keyboard_program_ = 0;
+    keyboard_instance_capacity_ = 0;
+}
+
+void OpenGLRenderer::DrawKeyboardLayer(const KeyboardKeyInstance* keys, std::size_t key_count,
+                                       const KeyboardLayerStyle& style) {
+    if (key_count == 0) {
+        return;
+    }
+
+    if (keyboard_pipeline_state_ == KeyboardPipelineState::Uninitialized) {
+        keyboard_pipeline_state_ = InitializeKeyboardPipeline() ? KeyboardPipelineState::Ready
+                                                                 : KeyboardPipelineState::Failed;
+        if (keyboard_pipeline_state_ == KeyboardPipelineState::Failed) {
+            DestroyKeyboardPipeline();
+            std::cerr << "GPU keyboard path unavailable, drawing keys on the CPU" << std::endl;
+        }
+    }
+    if (keyboard_pipeline_state_ != KeyboardPipelineState::Ready) {
+        RendererBackend::DrawKeyboardLayer(keys, key_count, style);
+        return;
+    }
+
+    // The only per-frame data is the compact instance buffer (20 bytes per key)
+    glBindBuffer(GL_ARRAY_BUFFER, keyboard_instance_vbo_);
+    if (key_count > keyboard_instance_capacity_) {
+        keyboard_instance_capacity_ = key_count;
+        glBufferData(GL_ARRAY_BUFFER, key_count * sizeof(KeyboardKeyInstance), keys, GL_STREAM_DRAW);
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, key_count * sizeof(KeyboardKeyInstance), keys);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(keyboard_program_);
+    glUniform2f(keyboard_uniform_viewport_, static_cast<float>(window_width_), static_cast<float>(window_height_));
+    glUniform2f(keyboard_uniform_press_, style.press_scale, style.press_y_offset);
+    glUniform2f(keyboard_uniform_shape_, style.corner_radius, style.border_width);
+    glUniform4f(keyboard_uniform_top_, style.top_color.r, style.top_color.g, style.top_color.b, style.top_color.a);
+    glUniform4f(keyboard_uniform_bottom_, style.bottom_color.r, style.bottom_color.g, style.bottom_color.b, style.bottom_color.a);
+    glUniform4f(keyboard_uniform_border_, style.border_color.r, style.border_color.g, style.border_color.b, style.border_color.a);
+
+    IncrementDrawCallCount();
+    glBindVertexArray(keyboard_vao_);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(key_count));
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
+
 void OpenGLRenderer::BeginBatch() {
     batch_rects_.clear();
 }
@@ -382,13 +628,205 @@ void OpenGLRenderer::SetupProjection() {
     glLoadIdentity();
 }
 
-// Stub functions for compatibility
+void OpenGLRenderer::UploadTexture(BackgroundImage& image, const DecodedImage& pixels) {
+    if (!pixels.IsValid()) {
+        return;
+    }
+
+    if (!image.texture_id) {
+        glGenTextures(1, &image.texture_id);
+    }
+    glBindTexture(GL_TEXTURE_2D, image.texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (image.loaded && image.width == pixels.width && image.height == pixels.height) {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, pixels.width, pixels.height,
+                        GL_RGBA, GL_UNSIGNED_BYTE, pixels.pixels.data());
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, pixels.width, pixels.height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, pixels.pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    image.width = pixels.width;
+    image.height = pixels.height;
+    image.loaded = true;
+}
+
 bool OpenGLRenderer::LoadImageTexture(const std::string& path, BackgroundImage& image) {
-    return false;
+    if (image.loaded) {
+        return true;
+    }
+
+    // Decoding happens on a worker thread; upload as soon as it is ready
+    BackgroundImageCache& cache = BackgroundImageCache::Instance();
+    cache.Request(path);
+    std::shared_ptr<const DecodedImage> decoded = cache.TryGet(path);
+    if (!decoded) {
+        return false;
+    }
+
+    image.path = path;
+    UploadTexture(image, *decoded);
+    return image.loaded;
 }
 
 void OpenGLRenderer::DrawImageBackground(const BackgroundImage& image, float opacity, int scale_mode) {
-    // Not implemented
+    Vec2 position;
+    Vec2 size;
+    BackgroundImageCache::ComputePlacement(image.width, image.height, window_width_, window_height_,
+                                           static_cast<BackgroundScaleMode>(scale_mode), position, size);
+    DrawTexturedQuad(image.texture_id, position, size, Color(1.0f, 1.0f, 1.0f, opacity));
+}
+
+void OpenGLRenderer::DrawTexturedQuad(unsigned int texture_id, const Vec2& position, const Vec2& size,
+                                      const Color& tint) {
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glColor4f(tint.r, tint.g, tint.b, tint.a);
+
+    IncrementDrawCallCount();
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(position.x, position.y);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(position.x + size.x, position.y);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(position.x + size.x, position.y + size.y);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(position.x, position.y + size.y);
+    glEnd();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
+
+void OpenGLRenderer::DrawFramebufferTexture(unsigned int texture_id, const Color& tint) {
+    // Render target textures are stored bottom-up, so flip V to keep the image upright
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glColor4f(tint.r, tint.g, tint.b, tint.a);
+
+    const float width = static_cast<float>(window_width_);
+    const float height = static_cast<float>(window_height_);
+    IncrementDrawCallCount();
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 1.0f); glVertex2f(0.0f, 0.0f);
+    glTexCoord2f(1.0f, 1.0f); glVertex2f(width, 0.0f);
+    glTexCoord2f(1.0f, 0.0f); glVertex2f(width, height);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, height);
+    glEnd();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+}
+
+void OpenGLRenderer::BeginFrameAccumulation() {
+    if (!offscreen_initialized_) {
+        return;
+    }
+
+    if (!accumulation_framebuffer_) {
+        // Half floats so K sub-frames of weight 1/K sum without 8-bit banding
+        glGenTextures(1, &accumulation_texture_);
+        glBindTexture(GL_TEXTURE_2D, accumulation_texture_);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, window_width_, window_height_, 0, GL_RGBA, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &accumulation_framebuffer_);
+        glBindFramebuffer(GL_FRAMEBUFFER, accumulation_framebuffer_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accumulation_texture_, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Failed to create accumulation framebuffer" << std::endl;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, accumulation_framebuffer_);
+    glViewport(0, 0, window_width_, window_height_);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void OpenGLRenderer::AccumulateFrame(float weight) {
+    if (!accumulation_framebuffer_) {
+        return;
+    }
+
+    // Add the sub-frame just rendered to the accumulation target, scaled by weight
+    glBindFramebuffer(GL_FRAMEBUFFER, accumulation_framebuffer_);
+    glBlendFunc(GL_ONE, GL_ONE);
+    DrawFramebufferTexture(color_texture_, Color(weight, weight, weight, weight));
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void OpenGLRenderer::ResolveAccumulatedFrame() {
+    if (!accumulation_framebuffer_) {
+        return;
+    }
+
+    // Replace the offscreen frame with the average; overlays drawn afterwards stay sharp
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glDisable(GL_BLEND);
+    DrawFramebufferTexture(accumulation_texture_, Color(1.0f, 1.0f, 1.0f, 1.0f));
+    glEnable(GL_BLEND);
+}
+
+void OpenGLRenderer::CaptureStaticLayer() {
+    if (!offscreen_initialized_) {
+        return;
+    }
+
+    if (!static_layer_framebuffer_) {
+        // Same format as the offscreen frame so the round trip is an exact copy
+        glGenTextures(1, &static_layer_texture_);
+        glBindTexture(GL_TEXTURE_2D, static_layer_texture_);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, window_width_, window_height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &static_layer_framebuffer_);
+        glBindFramebuffer(GL_FRAMEBUFFER, static_layer_framebuffer_);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, static_layer_texture_, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Failed to create static layer framebuffer" << std::endl;
+        }
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_layer_framebuffer_);
+    glBlitFramebuffer(0, 0, window_width_, window_height_, 0, 0, window_width_, window_height_,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void OpenGLRenderer::RestoreStaticLayer() {
+    if (!static_layer_framebuffer_) {
+        return;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_layer_framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer_);
+    glBlitFramebuffer(0, 0, window_width_, window_height_, 0, 0, window_width_, window_height_,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
+void OpenGLRenderer::SetClipRect(const Vec2& position, const Vec2& size) {
+    // Scissor coordinates start at the bottom left; ours start at the top left
+    const int left = static_cast<int>(std::floor(position.x));
+    const int top = static_cast<int>(std::floor(position.y));
+    const int right = static_cast<int>(std::ceil(position.x + size.x));
+    const int bottom = static_cast<int>(std::ceil(position.y + size.y));
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(left, window_height_ - bottom, std::max(0, right - left), std::max(0, bottom - top));
+}
+
+void OpenGLRenderer::ClearClipRect() {
+    glDisable(GL_SCISSOR_TEST);
 }
 
 void OpenGLRenderer::LoadFontTexture() {
@@ -396,6 +834,26 @@ void OpenGLRenderer::LoadFontTexture() {
 }
 
 void OpenGLRenderer::DrawText(const std::string& text, const Vec2& position, const Color& color, float scale) {
+    if (text.empty()) {
+        return;
+    }
+    
+    text_vertices_.clear();
+    AppendTextVertices(text, position, scale, text_vertices_);
+    DrawTextVertices(text_vertices_, color);
+}
+
+void OpenGLRenderer::BuildTextMesh(const std::string& text, const Vec2& position, float scale, TextMesh& mesh) {
+    RendererBackend::BuildTextMesh(text, position, scale, mesh);
+    AppendTextVertices(text, position, scale, mesh.vertices);
+}
+
+void OpenGLRenderer::DrawTextMesh(const TextMesh& mesh, const Color& color) {
+    DrawTextVertices(mesh.vertices, color);
+}
+
+void OpenGLRenderer::AppendTextVertices(const std::string& text, const Vec2& position, float scale,
+                                        std::vector<float>& vertices) {
     float char_width = (simple_font::kGlyphWidth + 1) * scale;
     float char_height = simple_font::kGlyphHeight * scale;
     float pixel_size = 1.0f * scale;
@@ -420,10 +878,12 @@ void OpenGLRenderer::DrawText(const std::string& text, const Vec2& position, con
             for (int row = 0; row < simple_font::kGlyphHeight; row++) {
                 for (int col = 0; col < simple_font::kGlyphWidth; col++) {
                     if (bitmap[row] & (1 << (4 - col))) {
-                        Vec2 pixel_pos(current_x + col * pixel_size, 
-                                     current_y + row * pixel_size);
-                        Vec2 pixel_size_vec(pixel_size, pixel_size);
-                        DrawRect(pixel_pos, pixel_size_vec, color);
+                        float x = current_x + col * pixel_size;
+                        float y = current_y + row * pixel_size;
+                        vertices.insert(vertices.end(), {x, y,
+                                                         x + pixel_size, y,
+                                                         x + pixel_size, y + pixel_size,
+                                                         x, y + pixel_size});
                     }
                 }
             }
@@ -433,6 +893,20 @@ void OpenGLRenderer::DrawText(const std::string& text, const Vec2& position, con
     }
 }
 
+void OpenGLRenderer::DrawTextVertices(const std::vector<float>& vertices, const Color& color) {
+    if (vertices.empty()) {
+        return;
+    }
+    
+    // Every glyph pixel of the string goes out in a single draw from client memory
+    glColor4f(color.r, color.g, color.b, color.a);
+    IncrementDrawCallCount();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, vertices.data());
+    glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(vertices.size() / 2));
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
 Vec2 OpenGLRenderer::GetTextSize(const std::string& text, float scale) {
     float char_width = (simple_font::kGlyphWidth + 1) * scale;
     float line_spacing = 2.0f * scale;
@@ -520,33 +994,99 @@ void OpenGLRenderer::BindOffscreenFramebuffer() {
     }
 }
 
+void OpenGLRenderer::BindReadbackFramebuffer() {
+    if (output_framebuffer_) {
+        glBindFramebuffer(GL_FRAMEBUFFER, output_framebuffer_);
+        glViewport(0, 0, output_width_, output_height_);
+    } else {
+        BindOffscreenFramebuffer();
+    }
+}
+
+void OpenGLRenderer::SetOutputSize(int width, int height) {
+    if (output_framebuffer_) {
+        glDeleteFramebuffers(1, &output_framebuffer_);
+        glDeleteTextures(1, &output_texture_);
+        output_framebuffer_ = 0;
+        output_texture_ = 0;
+    }
+    output_width_ = width;
+    output_height_ = height;
+
+    // Same size as the offscreen framebuffer: read it directly
+    if (width == window_width_ && height == window_height_) {
+        return;
+    }
+
+    glGenTextures(1, &output_texture_);
+    glBindTexture(GL_TEXTURE_2D, output_texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &output_framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, output_framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, output_texture_, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Failed to create output framebuffer, reading back at render resolution" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &output_framebuffer_);
+        glDeleteTextures(1, &output_texture_);
+        output_framebuffer_ = 0;
+        output_texture_ = 0;
+        return;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    std::cout << "Rendering at " << window_width_ << "x" << window_height_
+              << ", resampled to " << width << "x" << height << " before readback" << std::endl;
+}
+
+void OpenGLRenderer::ResolveOutputFrame() {
+    if (!output_framebuffer_) {
+        return;
+    }
+
+    // Integer upscales keep hard pixel edges (sharp draft output); everything else, including
+    // the 2x supersampled case where bilinear is an exact 2x2 box filter, is filtered linearly
+    const bool integer_upscale = output_width_ % window_width_ == 0 && output_height_ % window_height_ == 0 &&
+                                 output_width_ / window_width_ == output_height_ / window_height_;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, output_framebuffer_);
+    glBlitFramebuffer(0, 0, window_width_, window_height_, 0, 0, output_width_, output_height_,
+                      GL_COLOR_BUFFER_BIT, integer_upscale ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+}
+
 void OpenGLRenderer::UnbindOffscreenFramebuffer() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 std::vector<uint8_t> OpenGLRenderer::ReadFramebuffer(int width, int height) {
-    std::vector<uint8_t> pixels(width * height * 4); // RGBA
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4); // RGBA
+    ReadFramebufferInto(width, height, pixels.data());
+    return pixels;
+}
+
+bool OpenGLRenderer::ReadFramebufferInto(int width, int height, uint8_t* destination) {
+    // Bind the framebuffer holding the output-sized frame to read from it
+    BindReadbackFramebuffer();
     
-    // Bind the offscreen framebuffer to read from it
-    BindOffscreenFramebuffer();
+    // Read pixels straight into the destination
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, destination);
     
-    // Read pixels from the framebuffer
-    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
-    
-    // Flip the image vertically (OpenGL has origin at bottom-left)
-    std::vector<uint8_t> flipped_pixels(width * height * 4);
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int src_idx = ((height - 1 - y) * width + x) * 4;
-            int dst_idx = (y * width + x) * 4;
-            flipped_pixels[dst_idx + 0] = pixels[src_idx + 0]; // R
-            flipped_pixels[dst_idx + 1] = pixels[src_idx + 1]; // G
-            flipped_pixels[dst_idx + 2] = pixels[src_idx + 2]; // B
-            flipped_pixels[dst_idx + 3] = pixels[src_idx + 3]; // A
+    // Flip the image vertically in place (OpenGL has origin at bottom-left) by swapping row pairs
+    const size_t row_size = static_cast<size_t>(width) * 4;
+    TaskSystem::Instance().ParallelFor(0, static_cast<size_t>(height / 2), kFlipRowsPerTask, [&](size_t first, size_t last) {
+        for (size_t y = first; y < last; y++) {
+            uint8_t* top_row = destination + (y * row_size);
+            uint8_t* bottom_row = destination + ((height - 1 - y) * row_size);
+            std::swap_ranges(top_row, top_row + row_size, bottom_row);
         }
-    }
+    });
     
-    return flipped_pixels;
+    return true;
 }
 
 // GPU-optimized frame capture using PBO (Pixel Buffer Objects)
@@ -586,11 +1126,19 @@ void OpenGLRenderer::CleanupPBO() {
 
 // Asynchronous GPU-optimized readback with double-buffered PBO
 std::vector<uint8_t> OpenGLRenderer::ReadFramebufferPBO(int width, int height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4); // RGBA
+    if (!ReadFramebufferPBOInto(width, height, pixels.data())) {
+        return {};
+    }
+    return pixels;
+}
+
+bool OpenGLRenderer::ReadFramebufferPBOInto(int width, int height, uint8_t* destination) {
     if (!pbo_initialized_) {
         InitializePBO(width, height);
     }
     
-    BindOffscreenFramebuffer();
+    BindReadbackFramebuffer();
     
     // Use double buffering: read from previous frame's PBO while writing to current PBO
     int read_pbo = current_pbo_index_;
@@ -604,30 +1152,28 @@ std::vector<uint8_t> OpenGLRenderer::ReadFramebufferPBO(int width, int height) {
     glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[read_pbo]);
     void* mapped_buffer = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
     
-    std::vector<uint8_t> result;
     if (mapped_buffer) {
-        size_t buffer_size = width * height * 4;
-        result.resize(buffer_size);
-        
         // Fast GPU-assisted vertical flip using pointer arithmetic
         uint8_t* src = static_cast<uint8_t*>(mapped_buffer);
-        uint8_t* dst = result.data();
+        uint8_t* dst = destination;
         
         size_t row_size = width * 4; // RGBA
         
-        // Flip vertically (OpenGL origin is bottom-left, we need top-left)
-        for (int y = 0; y < height; y++) {
-            uint8_t* src_row = src + ((height - 1 - y) * row_size);
-            uint8_t* dst_row = dst + (y * row_size);
-            std::memcpy(dst_row, src_row, row_size);
-        }
+        // Flip vertically (OpenGL origin is bottom-left, we need top-left), rows split across the task system
+        TaskSystem::Instance().ParallelFor(0, static_cast<size_t>(height), kFlipRowsPerTask, [&](size_t first, size_t last) {
+            for (size_t y = first; y < last; y++) {
+                uint8_t* src_row = src + ((height - 1 - y) * row_size);
+                uint8_t* dst_row = dst + (y * row_size);
+                std::memcpy(dst_row, src_row, row_size);
+            }
+        });
         
         glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
     } else {
         // Fallback to synchronous read if mapping fails
         std::cerr << "PBO mapping failed, falling back to synchronous read" << std::endl;
         glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-        return ReadFramebuffer(width, height);
+        return ReadFramebufferInto(width, height, destination);
     }
     
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
@@ -635,7 +1181,7 @@ std::vector<uint8_t> OpenGLRenderer::ReadFramebufferPBO(int width, int height) {
     // Swap PBO indices for next frame
     current_pbo_index_ = write_pbo;
     
-    return result;
+    return true;
 }
 
 // For even more advanced async operation
@@ -644,7 +1190,7 @@ void OpenGLRenderer::StartAsyncReadback(int width, int height) {
         InitializePBO(width, height);
     }
     
-    BindOffscreenFramebuffer();
+    BindReadbackFramebuffer();
     
     // Start async readback
     glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_[current_pbo_index_]);
@@ -670,11 +1216,13 @@ std::vector<uint8_t> OpenGLRenderer::GetAsyncReadbackResult(int width, int heigh
         uint8_t* dst = result.data();
         size_t row_size = width * 4;
         
-        for (int y = 0; y < height; y++) {
-            std::memcpy(dst + (y * row_size), 
-                       src + ((height - 1 - y) * row_size), 
-                       row_size);
-        }
+        TaskSystem::Instance().ParallelFor(0, static_cast<size_t>(height), kFlipRowsPerTask, [&](size_t first, size_t last) {
+            for (size_t y = first; y < last; y++) {
+                std::memcpy(dst + (y * row_size),
+                           src + ((height - 1 - y) * row_size),
+                           row_size);
+            }
+        });
         
         glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
     }
@@ -5,10 +5,12 @@
 #endif
 
 #include <GL/gl.h>
+#include <map>
 #include <vector>
 #include <string>
 
 #include "renderer.h"
+#include "background_image_cache.h"
 
 // Font atlas for text rendering
 struct FontAtlas {
@@ -53,6 +55,8 @@ public:
     bool LoadFont(float font_size = 16.0f) override;
     void DrawText(const std::string& text, const Vec2& position, const Color& color, float scale = 1.0f) override;
     Vec2 GetTextSize(const std::string& text, float scale = 1.0f) override;
+    void BuildTextMesh(const std::string& text, const Vec2& position, float scale, TextMesh& mesh) override;
+    void DrawTextMesh(const TextMesh& mesh, const Color& color) override;
 
     // Draw a filled rectangle
     void DrawRect(const Vec2& position, const Vec2& size, const Color& color) override;
@@ -76,6 +80,10 @@ public:
                                   const Color& fill_color, const Color& border_color,
                                   float border_width = 1.0f, float corner_radius = 5.0f) override;
     
+    // Instanced keyboard layer (geometry and press animation computed in shaders)
+    void DrawKeyboardLayer(const KeyboardKeyInstance* keys, std::size_t key_count,
+                           const KeyboardLayerStyle& style) override;
+
     // Batch drawing for better performance
     void BeginBatch() override;
     void EndBatch() override;
@@ -94,9 +102,27 @@ public:
     bool InitializePBO(int width, int height) override;
     void CleanupPBO() override;
     std::vector<uint8_t> ReadFramebufferPBO(int width, int height) override;
+    bool ReadFramebufferInto(int width, int height, uint8_t* destination) override;
+    bool ReadFramebufferPBOInto(int width, int height, uint8_t* destination) override;
     void StartAsyncReadback(int width, int height) override;
     std::vector<uint8_t> GetAsyncReadbackResult(int width, int height) override;
 
+    // Temporal supersampling (RGBA16F accumulation target, additive blending)
+    bool SupportsFrameAccumulation() const override { return true; }
+    void BeginFrameAccumulation() override;
+    void AccumulateFrame(float weight) override;
+    void ResolveAccumulatedFrame() override;
+    bool SupportsStaticLayer() const override { return true; }
+    void CaptureStaticLayer() override;
+    void RestoreStaticLayer() override;
+    void SetClipRect(const Vec2& position, const Vec2& size) override;
+    void ClearClipRect() override;
+
+    // Render scaling (draft renders below, supersampled renders above the output resolution)
+    bool SupportsRenderScale() const override { return true; }
+    void SetOutputSize(int width, int height) override;
+    void ResolveOutputFrame() override;
+
     // Preview rendering
     void RenderOffscreenTextureToScreen(int screen_width, int screen_height) override;
     void RenderPreviewOverlay(int screen_width, int screen_height,
@@ -117,6 +143,7 @@ private:
     int window_width_;
     int window_height_;
     std::vector<Rect> batch_rects_;
+    std::vector<float> text_vertices_;  // Scratch glyph quads for DrawText (capacity reused)
 
     unsigned int draw_call_count_;
 
@@ -131,7 +158,20 @@ private:
     int current_pbo_index_;
     bool pbo_initialized_;
 
-    // Background image cache
+    // Accumulation target for temporal supersampling (created on first use)
+    unsigned int accumulation_framebuffer_;
+    unsigned int accumulation_texture_;
+    // Copy of the part of a frame shared by all its sub-frames (created on first use)
+    unsigned int static_layer_framebuffer_;
+    unsigned int static_layer_texture_;
+
+    // Output-sized target when the offscreen framebuffer is rendered at a different resolution
+    unsigned int output_framebuffer_;
+    unsigned int output_texture_;
+    int output_width_;
+    int output_height_;
+
+    // Background image cache (decoded on a worker thread, uploaded once per path)
     struct BackgroundImage {
         unsigned int texture_id;
         int width;
@@ -141,14 +181,42 @@ private:
 
         BackgroundImage() : texture_id(0), width(0), height(0), loaded(false) {}
     };
-    BackgroundImage background_image_;
+    std::map<std::string, BackgroundImage> background_images_;
+
+    // Radial gradient rasterized once per resolution and color pair
+    BackgroundImage gradient_texture_;
+    Color gradient_center_color_;
+    Color gradient_edge_color_;
+
+    // GPU keyboard pipeline (created on first use; falls back to the CPU path if unavailable)
+    enum class KeyboardPipelineState { Uninitialized, Ready, Failed };
+    KeyboardPipelineState keyboard_pipeline_state_;
+    unsigned int keyboard_program_;
+    unsigned int keyboard_vao_;
+    unsigned int keyboard_quad_vbo_;
+    unsigned int keyboard_instance_vbo_;
+    std::size_t keyboard_instance_capacity_;
+    int keyboard_uniform_viewport_;
+    int keyboard_uniform_press_;
+    int keyboard_uniform_shape_;
+    int keyboard_uniform_top_;
+    int keyboard_uniform_bottom_;
+    int keyboard_uniform_border_;
 
     // Helper functions
     void SetupProjection();
+    void BindReadbackFramebuffer();
+    bool InitializeKeyboardPipeline();
+    void DestroyKeyboardPipeline();
     bool LoadImageTexture(const std::string& path, BackgroundImage& image);
     void DrawImageBackground(const BackgroundImage& image, float opacity, int scale_mode);
+    void DrawTexturedQuad(unsigned int texture_id, const Vec2& position, const Vec2& size, const Color& tint);
+    void DrawFramebufferTexture(unsigned int texture_id, const Color& tint);
+    void UploadTexture(BackgroundImage& image, const DecodedImage& pixels);
     void LoadFontTexture();
     void RenderText(const std::string& text, float x, float y, float size, const Color& color);
+    static void AppendTextVertices(const std::string& text, const Vec2& position, float scale, std::vector<float>& vertices);
+    void DrawTextVertices(const std::vector<float>& vertices, const Color& color);
 
     void IncrementDrawCallCount();
 };
@@ -16,6 +16,13 @@ constexpr float REFERENCE_VIDEO_WIDTH = 1920.0f;
 constexpr float REFERENCE_WHITE_KEY_HEIGHT = 260.0f;
 constexpr float REFERENCE_BLACK_KEY_HEIGHT = 140.0f;
 
+// Heat blip tuning: the decay time constant is a quarter of the stacked fade duration so a
+// single note fades out over roughly the same time as a stacked blip
+constexpr float HEAT_DECAY_FRACTION = 0.25f;
+constexpr float HEAT_MAX_INTENSITY = 64.0f;     // Cap so a long burst still fades in reasonable time
+constexpr float HEAT_VISIBLE_THRESHOLD = 0.01f;
+constexpr float HEAT_HEIGHT_SATURATION = 4.0f;  // Intensity at which the bar reaches ~63% of the key height
+
 PianoKeyboard::PianoKeyboard()
     : keyboard_position_(50.0f, 80.0f)
     , keyboard_size_(1200.0f, 200.0f)
@@ -26,6 +33,8 @@ PianoKeyboard::PianoKeyboard()
     , keyboard_margin_(50.0f)
     , current_window_width_(1280)
     , current_window_height_(720)
+    , layout_region_top_(0.0f)
+    , layout_region_height_(0.0f)
     , white_key_color_(Color::FromRGB(255, 255, 255))
     , black_key_color_(Color::FromRGB(30, 30, 30))
     , key_border_color_(Color::FromRGB(10, 10, 10))
@@ -45,6 +54,8 @@ PianoKeyboard::PianoKeyboard()
     , key_press_scale_factor_(0.95f)             // Scale to 95% when pressed
     , key_press_y_offset_(2.0f)                  // Move 2px down when pressed
     , options_()
+    , use_animation_time_(false)
+    , animation_time_()
 {
 }
 
@@ -65,10 +76,12 @@ void PianoKeyboard::Initialize() {
 
         // Initialize animation properties
         key.was_pressed = false;
-        key.press_time = std::chrono::steady_clock::now();
-        key.release_time = std::chrono::steady_clock::now();
+        key.press_time = GetAnimationNow();
+        key.release_time = GetAnimationNow();
         key.animation_progress = 0.0f;
         key.is_animating = false;
+        key.changes_this_frame = false;
+        key.moves_this_frame = false;
 
         keys_.push_back(key);
     }
@@ -91,17 +104,130 @@ void PianoKeyboard::Update() {
 }
 
 void PianoKeyboard::Render(RendererBackend& renderer) {
+    PianoKeyboard* self = this;
+    RenderKeyboards(renderer, &self, 1);
+}
+
+void PianoKeyboard::RenderKeyboards(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+
     // Layer 1: Render white keys (background)
-    RenderWhiteKeys(renderer);
+    RenderWhiteKeyLayer(renderer, keyboards, count);
+    // Layers 2-4: white key blips, black keys, black key blips
+    RenderUpperLayers(renderer, keyboards, count);
+}
+
+void PianoKeyboard::RenderStaticLayer(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    // A white key moves during the frame when it is animating now, is pressed later in the frame,
+    // or was pressed at the first sub-frame (its animation only starts on the next Update)
+    for (std::size_t i = 0; i < count; ++i) {
+        for (auto& key : keyboards[i]->keys_) {
+            key.moves_this_frame = !key.is_black &&
+                                   (key.is_animating || key.changes_this_frame || (key.is_pressed && !key.was_pressed));
+        }
+    }
+    RenderWhiteKeyLayer(renderer, keyboards, count);
+}
+
+void PianoKeyboard::RenderDynamicLayer(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count,
+                                       const std::function<void()>& draw_background) {
+    if (count == 0) {
+        return;
+    }
+
+    if (draw_background) {
+        // Redraw only around the moving white keys. Neighbouring keys share their borders, so the
+        // clipped area gets the background and every white key touching it again, in the original
+        // order, which makes it match a full redraw exactly.
+        PianoKeyboard& primary = *keyboards[0];
+        const KeyboardLayerStyle style = primary.GetKeyLayerStyle(false);
+        const float pad = style.border_width * 0.5f + 1.0f;  // Border and anti-aliasing outside the key
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& keys = keyboards[i]->keys_;
+            for (std::size_t first = 0; first < keys.size(); ++first) {
+                if (!keys[first].moves_this_frame) {
+                    continue;
+                }
+                // One clip rectangle per run of neighbouring moving keys
+                float left = keys[first].position.x;
+                float right = left + keys[first].size.x;
+                float top = keys[first].position.y;
+                float bottom = top + keys[first].size.y;
+                std::size_t last = first;
+                for (std::size_t next = first + 1; next < keys.size(); ++next) {
+                    if (keys[next].is_black) {
+                        continue;
+                    }
+                    if (!keys[next].moves_this_frame) {
+                        break;
+                    }
+                    right = keys[next].position.x + keys[next].size.x;
+                    bottom = std::max(bottom, keys[next].position.y + keys[next].size.y);
+                    last = next;
+                }
+                // Whole pixels, so the keys picked below are exactly the ones that reach into the clip
+                const Vec2 clip_position(std::floor(left - pad), std::floor(top - pad));
+                const Vec2 clip_size(std::ceil(right + pad) - clip_position.x,
+                                     std::ceil(bottom + pad + style.press_y_offset) - clip_position.y);
+
+                primary.white_key_instances_.clear();
+                for (const auto& key : keys) {
+                    if (!key.is_black && key.position.x - pad < clip_position.x + clip_size.x &&
+                        key.position.x + key.size.x + pad > clip_position.x) {
+                        primary.white_key_instances_.push_back({key.position.x, key.position.y, key.size.x, key.size.y,
+                                                                key.is_animating ? key.animation_progress : 0.0f});
+                    }
+                }
+                renderer.SetClipRect(clip_position, clip_size);
+                draw_background();
+                renderer.DrawKeyboardLayer(primary.white_key_instances_.data(), primary.white_key_instances_.size(),
+                                           style);
+                first = last;
+            }
+        }
+        renderer.ClearClipRect();
+    }
+
+    RenderUpperLayers(renderer, keyboards, count);
+}
+
+void PianoKeyboard::RenderWhiteKeyLayer(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count) {
+    // The first keyboard's buffers hold the merged per-frame key instances
+    PianoKeyboard& primary = *keyboards[0];
+    primary.white_key_instances_.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        keyboards[i]->AppendKeyInstances(false, primary.white_key_instances_);
+    }
+    renderer.DrawKeyboardLayer(primary.white_key_instances_.data(), primary.white_key_instances_.size(),
+                               primary.GetKeyLayerStyle(false));
+}
+
+void PianoKeyboard::RenderUpperLayers(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count) {
+    PianoKeyboard& primary = *keyboards[0];
 
     // Layer 2: Render white key blips
-    RenderWhiteKeyBlips(renderer);
+    for (std::size_t i = 0; i < count; ++i) {
+        keyboards[i]->RenderWhiteKeyBlips(renderer);
+    }
 
     // Layer 3: Render black keys
-    RenderBlackKeys(renderer);
+    primary.black_key_instances_.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        keyboards[i]->AppendKeyInstances(true, primary.black_key_instances_);
+    }
+    renderer.DrawKeyboardLayer(primary.black_key_instances_.data(), primary.black_key_instances_.size(),
+                               primary.GetKeyLayerStyle(true));
 
     // Layer 4: Render black key blips (top layer)
-    RenderBlackKeyBlips(renderer);
+    for (std::size_t i = 0; i < count; ++i) {
+        keyboards[i]->RenderBlackKeyBlips(renderer);
+    }
 }
 
 void PianoKeyboard::HandleInput(double mouse_x, double mouse_y, bool mouse_is_down) {
@@ -168,6 +294,14 @@ void PianoKeyboard::SetAutoLayout(bool enabled) {
     }
 }
 
+void PianoKeyboard::SetLayoutRegion(float top, float height) {
+    layout_region_top_ = top;
+    layout_region_height_ = height;
+    if (auto_layout_enabled_) {
+        CalculateAutoLayout(current_window_width_, current_window_height_);
+    }
+}
+
 void PianoKeyboard::SetKeyboardMargin(float margin) {
     keyboard_margin_ = margin;
     if (auto_layout_enabled_) {
@@ -194,6 +328,18 @@ std::vector<int> PianoKeyboard::GetPressedKeys() const {
 }
 
 int PianoKeyboard::GetTotalBlipCount() const {
+    if (options_.blip_mode == BlipMode::Heat) {
+        // One aggregated blip per key that is still visible
+        auto now = GetAnimationNow();
+        int active_keys = 0;
+        for (const auto& key : keys_) {
+            if (GetDecayedHeat(key.heat, now) > HEAT_VISIBLE_THRESHOLD) {
+                active_keys++;
+            }
+        }
+        return active_keys;
+    }
+
     int total_blips = 0;
     for (const auto& key : keys_) {
         total_blips += static_cast<int>(key.blips.size());
@@ -245,90 +391,47 @@ void PianoKeyboard::CalculateKeyPositions() {
     }
 }
 
-void PianoKeyboard::RenderWhiteKeys(RendererBackend& renderer) {
+void PianoKeyboard::AppendKeyInstances(bool black_keys, std::vector<KeyboardKeyInstance>& instances) const {
     static bool debug_printed = false;
     static int keys_rendered = 0;
-    
+
+    // Build the compact per-frame key buffer; the backend applies the press animation
     for (const auto& key : keys_) {
-        if (!key.is_black) {
-            keys_rendered++;
-            
-            // Debug output (only for first few keys)
-            if (!debug_printed || keys_rendered <= 5) {
-                std::cout << "Rendering white key " << keys_rendered << " - Position: (" << key.position.x << ", " << key.position.y 
-                         << "), Size: (" << key.size.x << ", " << key.size.y << ")" << std::endl;
-                if (keys_rendered == 5) debug_printed = true;
-            }
-            
-            // Calculate animated position and size
-            Vec2 animated_position = key.position;
-            Vec2 animated_size = key.size;
-
-            if (key.is_animating && key.animation_progress > 0.0f) {
-                // Apply scale animation
-                float scale = 1.0f - (1.0f - key_press_scale_factor_) * key.animation_progress;
-                animated_size.x *= scale;
-                animated_size.y *= scale;
-
-                // Center the scaled key
-                animated_position.x += (key.size.x - animated_size.x) * 0.5f;
-                animated_position.y += (key.size.y - animated_size.y) * 0.5f;
-
-                // Apply vertical offset
-                animated_position.y += key_press_y_offset_ * key.animation_progress;
-            }
+        if (key.is_black != black_keys) {
+            continue;
+        }
 
-            // Render the white key with gradient (fixed colors)
-            Color white_top_color = Color::FromRGB(255, 255, 255);    // Pure white
-            Color white_bottom_color = Color::FromRGB(240, 240, 240); // Light gray
-            
-            // No color animation - always use fixed colors
-            
-            renderer.DrawRectGradientRounded(animated_position, animated_size,
-                                    white_top_color, white_bottom_color, 6.0f);
-
-            // Draw border
-            renderer.DrawRectWithRoundedBorder(animated_position, animated_size,
-                                      Color(0, 0, 0, 0), key_border_color_, 2.5f, 6.0f);
+        // Debug output (only for first few white keys)
+        if (!black_keys && (!debug_printed || keys_rendered < 5)) {
+            keys_rendered++;
+            std::cout << "Rendering white key " << keys_rendered << " - Position: (" << key.position.x << ", " << key.position.y
+                     << "), Size: (" << key.size.x << ", " << key.size.y << ")" << std::endl;
+            if (keys_rendered == 5) debug_printed = true;
         }
+
+        instances.push_back({key.position.x, key.position.y, key.size.x, key.size.y,
+                             key.is_animating ? key.animation_progress : 0.0f});
     }
 }
 
-void PianoKeyboard::RenderBlackKeys(RendererBackend& renderer) {
-    for (const auto& key : keys_) {
-        if (key.is_black) {
-            // Calculate animated position and size
-            Vec2 animated_position = key.position;
-            Vec2 animated_size = key.size;
-
-            if (key.is_animating && key.animation_progress > 0.0f) {
-                // Apply scale animation
-                float scale = 1.0f - (1.0f - key_press_scale_factor_) * key.animation_progress;
-                animated_size.x *= scale;
-                animated_size.y *= scale;
-
-                // Center the scaled key
-                animated_position.x += (key.size.x - animated_size.x) * 0.5f;
-                animated_position.y += (key.size.y - animated_size.y) * 0.5f;
-
-                // Apply vertical offset
-                animated_position.y += key_press_y_offset_ * key.animation_progress;
-            }
-
-            // Render the black key with gradient (fixed colors)
-            Color black_top_color = Color::FromRGB(0, 0, 0);       // Pure black
-            Color black_bottom_color = Color::FromRGB(68, 68, 68); // Dark gray
-            
-            // No color animation - always use fixed colors
-            
-            renderer.DrawRectGradientRounded(animated_position, animated_size,
-                                    black_top_color, black_bottom_color, 6.0f);
-
-            // Draw border
-            renderer.DrawRectWithRoundedBorder(animated_position, animated_size,
-                                      Color(0, 0, 0, 0), key_border_color_, 1.5f, 6.0f);
-        }
+KeyboardLayerStyle PianoKeyboard::GetKeyLayerStyle(bool black_keys) const {
+    KeyboardLayerStyle style;
+    if (black_keys) {
+        // Fixed colors: black to dark gray gradient
+        style.top_color = Color::FromRGB(0, 0, 0);
+        style.bottom_color = Color::FromRGB(68, 68, 68);
+        style.border_width = 1.5f;
+    } else {
+        // Fixed colors: white to light gray gradient
+        style.top_color = Color::FromRGB(255, 255, 255);
+        style.bottom_color = Color::FromRGB(240, 240, 240);
+        style.border_width = 2.5f;
     }
+    style.border_color = key_border_color_;
+    style.corner_radius = 6.0f;
+    style.press_scale = key_press_scale_factor_;
+    style.press_y_offset = key_press_y_offset_;
+    return style;
 }
 
 int PianoKeyboard::GetKeyAtPosition(const Vec2& pos) const {
@@ -384,6 +487,16 @@ void PianoKeyboard::CalculateAutoLayout(int window_width, int window_height) {
     const float MIN_SCALE = 0.3f;
     const float MAX_SCALE = 4.0f;
     scale = std::max(MIN_SCALE, std::min(MAX_SCALE, scale));
+
+    // Keep the keys inside the layout band when keyboards are stacked
+    float region_top = 0.0f;
+    float region_height = static_cast<float>(window_height);
+    if (layout_region_height_ > 0.0f) {
+        region_top = layout_region_top_;
+        region_height = layout_region_height_;
+        const float BAND_FILL = 0.9f;
+        scale = std::min(scale, region_height * BAND_FILL / REFERENCE_WHITE_KEY_HEIGHT);
+    }
     layout_scale_ = scale;
 
     float white_key_width = reference_white_key_width * scale;
@@ -400,8 +513,8 @@ void PianoKeyboard::CalculateAutoLayout(int window_width, int window_height) {
     // Center the keyboard horizontally
     float keyboard_x = (window_width - total_keyboard_width) * 0.5f;
 
-    // Position keyboard in the center vertically
-    float keyboard_y = (window_height - white_key_height) * 0.5f;
+    // Position keyboard in the center of its band vertically
+    float keyboard_y = region_top + (region_height - white_key_height) * 0.5f;
 
     keyboard_position_ = Vec2(keyboard_x, keyboard_y);
     keyboard_size_ = Vec2(total_keyboard_width, white_key_height);
@@ -431,11 +544,50 @@ int PianoKeyboard::GetTotalWhiteKeys() const {
     return count;
 }
 
+void PianoKeyboard::SetBlipMode(BlipMode mode) {
+    if (options_.blip_mode == mode) {
+        return;
+    }
+    options_.blip_mode = mode;
+
+    // Drop the state of the other model so switching modes starts clean
+    for (auto& key : keys_) {
+        key.blips.clear();
+        key.heat = KeyHeat();
+    }
+}
+
+float PianoKeyboard::GetDecayedHeat(const KeyHeat& heat, std::chrono::steady_clock::time_point now) const {
+    if (heat.intensity <= 0.0f) {
+        return 0.0f;
+    }
+    float elapsed_ms = std::chrono::duration<float, std::milli>(now - heat.last_update).count();
+    float tau_ms = blip_fade_duration_ms_ * HEAT_DECAY_FRACTION;
+    return heat.intensity * std::exp(-std::max(0.0f, elapsed_ms) / tau_ms);
+}
+
 void PianoKeyboard::AddKeyBlip(int note, const Color& color) {
+    AddKeyBlip(note, color.ToPackedRGBA());
+}
+
+void PianoKeyboard::AddKeyBlip(int note, std::uint32_t packed_color) {
     // Find the key in our 128-key range
     if (note >= PIANO_START_NOTE && note <= PIANO_END_NOTE) {
         int index = note - PIANO_START_NOTE;
-        if (index >= 0 && index < static_cast<int>(keys_.size())) {
+        if (index >= 0 && index < static_cast<int>(keys_.size()) && options_.blip_mode == BlipMode::Heat) {
+            // O(1): decay the accumulator to now, then blend in the new note
+            PianoKey& key = keys_[index];
+            auto now = GetAnimationNow();
+            float intensity = GetDecayedHeat(key.heat, now);
+            float weight = 1.0f / (intensity + 1.0f);
+            Color color = Color::FromPackedRGBA(packed_color);
+            key.heat.color.r += (color.r - key.heat.color.r) * weight;
+            key.heat.color.g += (color.g - key.heat.color.g) * weight;
+            key.heat.color.b += (color.b - key.heat.color.b) * weight;
+            key.heat.intensity = std::min(HEAT_MAX_INTENSITY, intensity + 1.0f);
+            key.heat.last_update = now;
+            key.time_played = now;
+        } else if (index >= 0 && index < static_cast<int>(keys_.size())) {
             // Calculate maximum blips based on keyboard height and blip spacing
             float key_height = keys_[index].is_black ? black_key_size_.y : white_key_size_.y;
             float base_blip_height = keys_[index].is_black ? black_blip_height_ : white_blip_height_;
@@ -456,8 +608,8 @@ void PianoKeyboard::AddKeyBlip(int note, const Color& color) {
             }
 
             KeyBlip blip;
-            blip.time = std::chrono::steady_clock::now();
-            blip.color = color;
+            blip.time = GetAnimationNow();
+            blip.color = packed_color;
             blip.y_offset = 0.0f; // Not used in the new implementation, but kept for compatibility
 
             keys_[index].blips.push_back(blip);
@@ -467,7 +619,12 @@ void PianoKeyboard::AddKeyBlip(int note, const Color& color) {
 }
 
 void PianoKeyboard::UpdateBlips() {
-    auto now = std::chrono::steady_clock::now();
+    // Heat blips decay analytically at render time; nothing to update per frame
+    if (options_.blip_mode == BlipMode::Heat) {
+        return;
+    }
+
+    auto now = GetAnimationNow();
 
     for (auto& key : keys_) {
         if (key.blips.empty()) continue;
@@ -499,8 +656,44 @@ void PianoKeyboard::UpdateBlips() {
     }
 }
 
+void PianoKeyboard::RenderHeatBlips(RendererBackend& renderer, bool black_keys) {
+    auto now = GetAnimationNow();
+
+    // Same margins and base height as the stacked blips
+    const float margin = (black_keys ? 3.0f : 4.0f) * layout_scale_;
+    const float min_height = (black_keys ? black_blip_height_ : white_blip_height_) * layout_scale_;
+    const float piano_top = keyboard_position_.y;
+
+    for (const auto& key : keys_) {
+        if (key.is_black != black_keys) continue;
+
+        float intensity = GetDecayedHeat(key.heat, now);
+        if (intensity <= HEAT_VISIBLE_THRESHOLD) continue;
+
+        // One bar per key: its height grows with accumulated density and its alpha with recency
+        float bottom = key.position.y + key.size.y - margin;
+        float max_height = std::max(min_height, bottom - piano_top);
+        float fill = 1.0f - std::exp(-intensity / HEAT_HEIGHT_SATURATION);
+        float height = std::min(max_height, min_height + (max_height - min_height) * fill);
+
+        Color bottom_color = key.heat.color;
+        bottom_color.a = std::min(1.0f, intensity);
+        Color top_color = bottom_color;
+        top_color.a = bottom_color.a * 0.25f;
+
+        renderer.DrawRectGradient(Vec2(key.position.x + margin, bottom - height),
+                                  Vec2(key.size.x - margin * 2.0f, height),
+                                  top_color, bottom_color);
+    }
+}
+
 void PianoKeyboard::RenderWhiteKeyBlips(RendererBackend& renderer) {
-    auto now = std::chrono::steady_clock::now();
+    if (options_.blip_mode == BlipMode::Heat) {
+        RenderHeatBlips(renderer, false);
+        return;
+    }
+
+    auto now = GetAnimationNow();
 
     for (const auto& key : keys_) {
         // Only render blips for white keys
@@ -541,7 +734,7 @@ void PianoKeyboard::RenderWhiteKeyBlips(RendererBackend& renderer) {
             }
 
             // Create color with alpha
-            Color blip_color = blip.color;
+            Color blip_color = Color::FromPackedRGBA(blip.color);
             blip_color.a = std::max(0.0f, std::min(1.0f, alpha));
 
             // Calculate position - newer blips appear higher up
@@ -571,7 +764,12 @@ void PianoKeyboard::RenderWhiteKeyBlips(RendererBackend& renderer) {
 }
 
 void PianoKeyboard::RenderBlackKeyBlips(RendererBackend& renderer) {
-    auto now = std::chrono::steady_clock::now();
+    if (options_.blip_mode == BlipMode::Heat) {
+        RenderHeatBlips(renderer, true);
+        return;
+    }
+
+    auto now = GetAnimationNow();
 
     for (const auto& key : keys_) {
         // Only render blips for black keys
@@ -612,7 +810,7 @@ void PianoKeyboard::RenderBlackKeyBlips(RendererBackend& renderer) {
             }
 
             // Create color with alpha
-            Color blip_color = blip.color;
+            Color blip_color = Color::FromPackedRGBA(blip.color);
             blip_color.a = std::max(0.0f, std::min(1.0f, alpha));
 
             // Calculate position - newer blips appear higher up
@@ -642,7 +840,7 @@ void PianoKeyboard::RenderBlackKeyBlips(RendererBackend& renderer) {
 }
 
 void PianoKeyboard::UpdateKeyAnimations() {
-    auto now = std::chrono::steady_clock::now();
+    auto now = GetAnimationNow();
 
     for (auto& key : keys_) {
         bool currently_pressed = key.is_pressed;
@@ -676,3 +874,54 @@ void PianoKeyboard::UpdateKeyAnimations() {
     }
 }
 
+
+void PianoKeyboard::MarkKeyChangesThisFrame(int note) {
+    if (note >= PIANO_START_NOTE && note <= PIANO_END_NOTE) {
+        int index = note - PIANO_START_NOTE;
+        if (index >= 0 && index < static_cast<int>(keys_.size())) {
+            keys_[index].changes_this_frame = true;
+        }
+    }
+}
+
+void PianoKeyboard::ClearFrameChanges() {
+    for (auto& key : keys_) {
+        key.changes_this_frame = false;
+    }
+}
+
+void PianoKeyboard::ClearEffects() {
+    for (auto& key : keys_) {
+        key.blips.clear();
+        key.heat = KeyHeat();
+        key.was_pressed = false;
+        key.is_animating = false;
+        key.animation_progress = 0.0f;
+    }
+}
+
+void PianoKeyboard::SetAnimationTime(double seconds) {
+    use_animation_time_ = true;
+    animation_time_ = std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+void PianoKeyboard::UseWallClock() {
+    use_animation_time_ = false;
+}
+
+double PianoKeyboard::GetAnimationSettleSeconds() const {
+    // Stacked blips are removed once they are older than the fade duration; heat blips decay
+    // exponentially, so wait until even a saturated key has dropped below the visible threshold
+    float settle_ms = blip_fade_duration_ms_;
+    if (options_.blip_mode == BlipMode::Heat) {
+        const float tau_ms = blip_fade_duration_ms_ * HEAT_DECAY_FRACTION;
+        settle_ms = tau_ms * std::log(HEAT_MAX_INTENSITY / HEAT_VISIBLE_THRESHOLD);
+    }
+    settle_ms = std::max(settle_ms, key_press_animation_duration_ms_);
+    return settle_ms / 1000.0;
+}
+
+std::chrono::steady_clock::time_point PianoKeyboard::GetAnimationNow() const {
+    return use_animation_time_ ? animation_time_ : std::chrono::steady_clock::now();
+}
\ No newline at end of file
@@ -2,9 +2,16 @@
 
 #include <vector>
 #include <chrono>
+#include <functional>
 
 #include "renderer.h"
 
+// How note-on blips are visualized
+enum class BlipMode {
+    Stacked,  // One timestamped rect per note, stacked upward (up to 50 per key)
+    Heat      // One decaying intensity/color accumulator per key, drawn as a single gradient
+};
+
 // Options structure for video output settings
 struct PianoOptions {
     // All visual colors are now fixed:
@@ -18,16 +25,27 @@ struct PianoOptions {
     float key_press_scale = 0.95f;
     float key_press_y_offset = 2.0f;
     
+    // Blip settings
+    BlipMode blip_mode = BlipMode::Stacked;
+
     // UI settings (for debugging only)
     bool show_debug_info = false;
 };
 
 struct KeyBlip {
     std::chrono::steady_clock::time_point time;  // When the blip was created
-    Color color;                                 // Color of the blip
+    std::uint32_t color;                         // Color of the blip (packed RGBA8, see Color::ToPackedRGBA)
     float y_offset;                             // Vertical offset from key position
 };
 
+// Heat blip accumulator. The stored values are valid at last_update and are decayed
+// analytically (exp(-dt / tau)) whenever they are read or bumped, so no per-frame update is needed.
+struct KeyHeat {
+    float intensity = 0.0f;     // Accumulated note energy (1.0 per note-on)
+    Color color{0.0f, 0.0f, 0.0f, 1.0f};  // Intensity-weighted average of the blip colors
+    std::chrono::steady_clock::time_point last_update{};
+};
+
 struct PianoKey {
     int note;           // MIDI note number (0-127)
     bool is_black;      // true if black key, false if white key
@@ -35,7 +53,8 @@ struct PianoKey {
     Vec2 position;      // Position on screen
     Vec2 size;          // Size of the key
     Color color;        // Current color of the key
-    std::vector<KeyBlip> blips;  // Visual effect blips for this key
+    std::vector<KeyBlip> blips;  // Visual effect blips for this key (BlipMode::Stacked)
+    KeyHeat heat;                // Aggregated blip state for this key (BlipMode::Heat)
     std::chrono::steady_clock::time_point time_played;  // Last time this key was played
 
     // Animation properties
@@ -44,6 +63,11 @@ struct PianoKey {
     std::chrono::steady_clock::time_point release_time;  // When key was released
     float animation_progress; // 0.0 to 1.0, animation progress
     bool is_animating;  // true if currently animating
+
+    // Temporal supersampling: pressed later in the current output frame / looks different in
+    // some sub-frame of it (set by RenderStaticLayer)
+    bool changes_this_frame;
+    bool moves_this_frame;
 };
 
 class PianoKeyboard {
@@ -60,6 +84,21 @@ public:
     // Render the keyboard using OpenGL
     void Render(RendererBackend& renderer);
 
+    // Render several keyboards into the same frame. Key layers of all keyboards are merged so
+    // the key draw count does not grow with the number of keyboards.
+    static void RenderKeyboards(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count);
+
+    // Temporal supersampling splits RenderKeyboards in two. The static layer is the white key
+    // layer of the first sub-frame, drawn once per output frame over the background and kept by
+    // the renderer. RenderDynamicLayer draws the rest of each sub-frame; for the later sub-frames
+    // pass draw_background, and it first redraws (clipped) the white keys that move in this frame.
+    // Keys pressed after the first sub-frame must be marked with MarkKeyChangesThisFrame first.
+    static void RenderStaticLayer(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count);
+    static void RenderDynamicLayer(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count,
+                                   const std::function<void()>& draw_background = nullptr);
+    void MarkKeyChangesThisFrame(int note);
+    void ClearFrameChanges();
+
     // Handle mouse input
     void HandleInput(double mouse_x, double mouse_y, bool mouse_is_down);
     
@@ -77,6 +116,9 @@ public:
     void UpdateLayout(int window_width, int window_height);
     void SetAutoLayout(bool enabled);
     void SetKeyboardMargin(float margin);
+    // Restrict the auto layout to a horizontal band of the window (height <= 0 uses the whole
+    // window). Used to stack several keyboards in one frame.
+    void SetLayoutRegion(float top, float height);
     
     // Get keyboard info
     int GetPressedKeyCount() const;
@@ -84,12 +126,28 @@ public:
     int GetTotalBlipCount() const;
 
     // Visual effects
+    void SetBlipMode(BlipMode mode);
+    BlipMode GetBlipMode() const { return options_.blip_mode; }
     void AddKeyBlip(int note, const Color& color);
+    void AddKeyBlip(int note, std::uint32_t packed_color);  // Packed RGBA8, avoids float conversion per note
     void UpdateBlips();
     void UpdateKeyAnimations();
+    // Drop blips and running key animations (pressed keys stay pressed)
+    void ClearEffects();
+
+    // Animation clock. Blips and key animations follow the wall clock by default; video output
+    // drives them from the video timeline instead, so a frame looks the same however long it
+    // took to render and wherever the render started.
+    void SetAnimationTime(double seconds);
+    void UseWallClock();
+    // How long a note keeps affecting the picture (blip fade-out, press animation). Rendering
+    // from a later start only has to replay this much of the timeline to match a full render.
+    double GetAnimationSettleSeconds() const;
 
 private:
     std::vector<PianoKey> keys_;
+    std::vector<KeyboardKeyInstance> white_key_instances_;  // Per-frame key buffers handed to the renderer
+    std::vector<KeyboardKeyInstance> black_key_instances_;
     Vec2 keyboard_position_;
     Vec2 keyboard_size_;
     Vec2 white_key_size_;
@@ -101,6 +159,8 @@ private:
     float keyboard_margin_;
     int current_window_width_;
     int current_window_height_;
+    float layout_region_top_;
+    float layout_region_height_;
 
     // Colors
     Color white_key_color_;
@@ -130,16 +190,25 @@ private:
 
     // Options
     PianoOptions options_;
+
+    // Animation clock (see SetAnimationTime)
+    bool use_animation_time_;
+    std::chrono::steady_clock::time_point animation_time_;
     
     // Helper functions
     bool IsBlackKey(int note) const;
     void CalculateKeyPositions();
     int GetWhiteKeyIndex(int note) const;
-    void RenderWhiteKeys(RendererBackend& renderer);
-    void RenderBlackKeys(RendererBackend& renderer);
+    void AppendKeyInstances(bool black_keys, std::vector<KeyboardKeyInstance>& instances) const;
+    static void RenderWhiteKeyLayer(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count);
+    static void RenderUpperLayers(RendererBackend& renderer, PianoKeyboard* const* keyboards, std::size_t count);
+    KeyboardLayerStyle GetKeyLayerStyle(bool black_keys) const;
     void RenderWhiteKeyBlips(RendererBackend& renderer);
     void RenderBlackKeyBlips(RendererBackend& renderer);
+    void RenderHeatBlips(RendererBackend& renderer, bool black_keys);
+    float GetDecayedHeat(const KeyHeat& heat, std::chrono::steady_clock::time_point now) const;
     int GetKeyAtPosition(const Vec2& pos) const;
+    std::chrono::steady_clock::time_point GetAnimationNow() const;
 
     // Layout calculation helpers
     void CalculateAutoLayout(int window_width, int window_height);
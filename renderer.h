@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -70,6 +71,21 @@ struct Color {
         const std::uint32_t b8 = clamp_channel(b);
         return (r8 << 16) | (g8 << 8) | b8;
     }
+
+    // Packed RGBA8 (0xRRGGBBAA), used where colors are stored per event or per instance
+    std::uint32_t ToPackedRGBA() const {
+        auto clamp_channel = [](float value) {
+            value = std::max(0.0f, std::min(1.0f, value));
+            return static_cast<std::uint32_t>(value * 255.0f + 0.5f);
+        };
+
+        return (clamp_channel(r) << 24) | (clamp_channel(g) << 16) | (clamp_channel(b) << 8) | clamp_channel(a);
+    }
+
+    static Color FromPackedRGBA(std::uint32_t rgba) {
+        return FromRGB(static_cast<int>((rgba >> 24) & 0xFFu), static_cast<int>((rgba >> 16) & 0xFFu),
+                       static_cast<int>((rgba >> 8) & 0xFFu), static_cast<int>(rgba & 0xFFu));
+    }
 };
 
 struct Rect {
@@ -84,6 +100,36 @@ struct Rect {
         : position(pos), size(sz), color(col), border_width(1.0f) {}
 };
 
+// One piano key as uploaded per frame for DrawKeyboardLayer: the rest rectangle plus the
+// press animation progress. Kept to 5 floats so a full 128-key layer is ~2.5 KB.
+struct KeyboardKeyInstance {
+    float x;
+    float y;
+    float width;
+    float height;
+    float press_progress;  // 0.0 = at rest, 1.0 = fully pressed
+};
+
+// Text laid out once and replayed every frame (overlay lines that rarely change). Backends that
+// generate glyph geometry on the CPU fill vertices; the others keep the string and draw it normally.
+struct TextMesh {
+    std::string text;
+    Vec2 position;
+    float scale = 1.0f;
+    std::vector<float> vertices;  // x, y pairs, four corners per glyph pixel
+};
+
+// Shared appearance of every key in a layer (white keys or black keys)
+struct KeyboardLayerStyle {
+    Color top_color;
+    Color bottom_color;
+    Color border_color;
+    float corner_radius = 6.0f;
+    float border_width = 2.5f;
+    float press_scale = 0.95f;     // Size multiplier at press_progress == 1
+    float press_y_offset = 2.0f;   // Downward offset at press_progress == 1
+};
+
 class RendererBackend {
 public:
     virtual ~RendererBackend() = default;
@@ -101,6 +147,18 @@ public:
     virtual void DrawText(const std::string& text, const Vec2& position, const Color& color, float scale = 1.0f) = 0;
     virtual Vec2 GetTextSize(const std::string& text, float scale = 1.0f) = 0;
 
+    // BuildTextMesh does the per-glyph work once; DrawTextMesh submits the cached result until
+    // the caller rebuilds it for new text.
+    virtual void BuildTextMesh(const std::string& text, const Vec2& position, float scale, TextMesh& mesh) {
+        mesh.text = text;
+        mesh.position = position;
+        mesh.scale = scale;
+        mesh.vertices.clear();
+    }
+    virtual void DrawTextMesh(const TextMesh& mesh, const Color& color) {
+        DrawText(mesh.text, mesh.position, color, mesh.scale);
+    }
+
     virtual void DrawRect(const Vec2& position, const Vec2& size, const Color& color) = 0;
     virtual void DrawRectGradient(const Vec2& position, const Vec2& size,
                                   const Color& top_color, const Color& bottom_color) = 0;
@@ -114,6 +172,23 @@ public:
                                            const Color& fill_color, const Color& border_color,
                                            float border_width = 1.0f, float corner_radius = 5.0f) = 0;
 
+    // Draws one layer of keys with the press animation applied. Backends with a shader path
+    // override this to draw the whole layer in a single instanced draw; the default expands
+    // each key into a rounded gradient plus a rounded border on the CPU.
+    virtual void DrawKeyboardLayer(const KeyboardKeyInstance* keys, std::size_t key_count,
+                                   const KeyboardLayerStyle& style) {
+        for (std::size_t i = 0; i < key_count; ++i) {
+            const KeyboardKeyInstance& key = keys[i];
+            const float scale = 1.0f - (1.0f - style.press_scale) * key.press_progress;
+            const Vec2 size(key.width * scale, key.height * scale);
+            const Vec2 position(key.x + (key.width - size.x) * 0.5f,
+                                key.y + (key.height - size.y) * 0.5f + style.press_y_offset * key.press_progress);
+            DrawRectGradientRounded(position, size, style.top_color, style.bottom_color, style.corner_radius);
+            DrawRectWithRoundedBorder(position, size, Color(0, 0, 0, 0), style.border_color,
+                                      style.border_width, style.corner_radius);
+        }
+    }
+
     virtual void BeginBatch() = 0;
     virtual void EndBatch() = 0;
 
@@ -132,6 +207,38 @@ public:
     virtual void StartAsyncReadback(int width, int height) = 0;
     virtual std::vector<std::uint8_t> GetAsyncReadbackResult(int width, int height) = 0;
 
+    // Readback into caller-owned memory of width * height * 4 bytes (top-down RGBA), so the
+    // recording path can reuse pooled frame buffers instead of allocating a frame every call.
+    // The defaults copy out of the vector-returning versions; backends override them to skip that.
+    virtual bool ReadFramebufferInto(int width, int height, std::uint8_t* destination) {
+        return CopyFrame(ReadFramebuffer(width, height), width, height, destination);
+    }
+    virtual bool ReadFramebufferPBOInto(int width, int height, std::uint8_t* destination) {
+        return CopyFrame(ReadFramebufferPBO(width, height), width, height, destination);
+    }
+
+    // Temporal supersampling: the offscreen frame is rendered several times at sub-frame times,
+    // each render is added to an accumulation target with the given weight, and the resolve
+    // writes the average back into the offscreen framebuffer before readback.
+    virtual bool SupportsFrameAccumulation() const { return false; }
+    virtual void BeginFrameAccumulation() {}
+    virtual void AccumulateFrame(float /*weight*/) {}
+    virtual void ResolveAccumulatedFrame() {}
+    // Parts of the frame that look the same in every sub-frame are drawn once: CaptureStaticLayer
+    // keeps a copy of the offscreen frame drawn so far and RestoreStaticLayer puts it back before
+    // each later sub-frame. The clip rectangle limits the redraw of the parts that did change.
+    virtual bool SupportsStaticLayer() const { return false; }
+    virtual void CaptureStaticLayer() {}
+    virtual void RestoreStaticLayer() {}
+    virtual void SetClipRect(const Vec2& /*position*/, const Vec2& /*size*/) {}
+    virtual void ClearClipRect() {}
+
+    // Render scaling: the offscreen framebuffer is drawn at its own resolution and resampled to
+    // the video output size by ResolveOutputFrame; readback then returns output-sized frames.
+    virtual bool SupportsRenderScale() const { return false; }
+    virtual void SetOutputSize(int /*width*/, int /*height*/) {}
+    virtual void ResolveOutputFrame() {}
+
     virtual void RenderOffscreenTextureToScreen(int screen_width, int screen_height) = 0;
     virtual void RenderPreviewOverlay(int screen_width, int screen_height,
                                       const std::vector<std::string>& info_lines,
@@ -145,6 +252,16 @@ public:
 
     virtual bool SupportsPreview() const { return true; }
     virtual bool SupportsAsyncReadback() const { return true; }
+
+protected:
+    static bool CopyFrame(const std::vector<std::uint8_t>& frame, int width, int height, std::uint8_t* destination) {
+        const std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4;
+        if (frame.size() != size) {
+            return false;
+        }
+        std::memcpy(destination, frame.data(), size);
+        return true;
+    }
 };
 
 #if defined(_WIN32)
@@ -0,0 +1,193 @@
+#include "task_system.h"
+#include "thread_affinity.h"
+
+#include <chrono>
+#include <string>
+
+namespace {
+
+// 現在のスレッドが属する TaskSystem とそのワーカー番号（ワーカー以外は nullptr）
+thread_local TaskSystem* tls_owner = nullptr;
+thread_local size_t tls_worker_index = 0;
+
+unsigned int g_configured_thread_count = 0;
+
+} // namespace
+
+void TaskLatch::CountDown() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        cv_.notify_all();
+    }
+}
+
+void TaskSystem::Configure(unsigned int thread_count) {
+    g_configured_thread_count = thread_count;
+}
+
+TaskSystem& TaskSystem::Instance() {
+    static TaskSystem instance(g_configured_thread_count);
+    return instance;
+}
+
+TaskSystem::TaskSystem(unsigned int thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t worker_count = thread_count - 1;
+
+    for (size_t i = 0; i <= worker_count; ++i) {
+        queues_.push_back(std::make_unique<TaskQueue>());
+    }
+    workers_.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&TaskSystem::WorkerLoop, this, i);
+    }
+}
+
+TaskSystem::~TaskSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void TaskSystem::Submit(Task task) {
+    if (workers_.empty()) {
+        task();
+        return;
+    }
+    Push(std::move(task));
+}
+
+void TaskSystem::Push(Task task) {
+    // ワーカーからの投入は自分のキューへ（キャッシュに残っているうちに自分で処理しやすい）
+    TaskQueue& queue = (tls_owner == this) ? *queues_[tls_worker_index] : *queues_.back();
+    // 取り出し側の減算より先に数える（カウンターが一時的にでも負にならないように）
+    queued_tasks_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    sleep_cv_.notify_one();
+}
+
+bool TaskSystem::TryRunOne() {
+    if (queued_tasks_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    Task task;
+    // 自分のキューの末尾（最も新しいタスク）
+    if (tls_owner == this) {
+        TaskQueue& own = *queues_[tls_worker_index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    // 共有キューと他のワーカーのキューの先頭（最も古いタスク）から盗む
+    if (!task) {
+        const size_t queue_count = queues_.size();
+        const size_t start = steal_cursor_.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < queue_count && !task; ++i) {
+            TaskQueue& victim = *queues_[(start + i) % queue_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+    }
+    if (!task) {
+        return false;
+    }
+
+    queued_tasks_.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void TaskSystem::Wait(TaskLatch& latch) {
+    while (true) {
+        if (!latch.IsDone() && TryRunOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(latch.mutex_);
+        // ロック下で 0 を確認してから戻る（CountDown が latch に触れ終わっていることを保証する）
+        if (latch.IsDone()) {
+            return;
+        }
+        // 残りは他のスレッドで実行中。入れ子のタスクが増えた場合に備えて定期的に手伝いへ戻る
+        latch.cv_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
+
+void TaskSystem::WorkerLoop(size_t index) {
+    tls_owner = this;
+    tls_worker_index = index;
+    EnterBackgroundThread(("task-worker-" + std::to_string(index)).c_str());
+
+    while (true) {
+        if (TryRunOne()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleep_cv_.wait(lock, [this]() {
+            return stop_ || queued_tasks_.load(std::memory_order_acquire) > 0;
+        });
+        if (stop_ && queued_tasks_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+TaskGraph::NodeId TaskGraph::AddTask(std::function<void()> fn) {
+    nodes_.emplace_back();
+    nodes_.back().fn = std::move(fn);
+    return nodes_.size() - 1;
+}
+
+void TaskGraph::AddDependency(NodeId before, NodeId after) {
+    nodes_[before].successors.push_back(after);
+    nodes_[after].predecessor_count++;
+}
+
+void TaskGraph::Run(TaskSystem& system) {
+    if (nodes_.empty()) {
+        return;
+    }
+
+    for (Node& node : nodes_) {
+        node.pending_predecessors.store(node.predecessor_count, std::memory_order_relaxed);
+    }
+
+    TaskLatch latch(nodes_.size());
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+        if (nodes_[id].predecessor_count == 0) {
+            system.Submit([this, &system, &latch, id]() { Execute(system, latch, id); });
+        }
+    }
+    system.Wait(latch);
+}
+
+void TaskGraph::Execute(TaskSystem& system, TaskLatch& latch, NodeId id) {
+    Node& node = nodes_[id];
+    if (node.fn) {
+        node.fn();
+    }
+    for (NodeId successor : node.successors) {
+        if (nodes_[successor].pending_predecessors.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            system.Submit([this, &system, &latch, successor]() { Execute(system, latch, successor); });
+        }
+    }
+    latch.CountDown();
+}
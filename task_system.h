@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+class TaskSystem;
+
+// 残りタスク数のカウンター。TaskSystem::Wait は 0 になるまで他のタスクを手伝いながら待つ。
+class TaskLatch {
+public:
+    explicit TaskLatch(size_t count) : remaining_(count) {}
+
+    TaskLatch(const TaskLatch&) = delete;
+    TaskLatch& operator=(const TaskLatch&) = delete;
+
+    void CountDown();
+    bool IsDone() const { return remaining_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class TaskSystem;
+
+    std::atomic<size_t> remaining_;
+    std::mutex mutex_;               // 0 になった瞬間の通知と待機側の破棄を直列化する
+    std::condition_variable cv_;
+};
+
+// プロジェクト共通のワークスティーリング・スレッドプール
+// ワーカーごとに両端キューを持ち、自分のキューは末尾から（LIFO）、他のキューは先頭から盗む。
+// ワーカー以外のスレッドから投入されたタスクは共有キューに入る。
+// 待機中のスレッド（ParallelFor / TaskGraph::Run の呼び出し元を含む）はタスクを手伝うので、
+// タスクの中から入れ子で ParallelFor を呼んでもデッドロックしない。
+// 各サブシステムはスレッドを個別に立てず、ここに投入することでコア数以上に膨らまないようにする。
+class TaskSystem {
+public:
+    using Task = std::function<void()>;
+
+    // 最初の Instance() より前に呼ぶ。thread_count は呼び出し元スレッドを含む総数（0 = ハードウェアスレッド数）
+    static void Configure(unsigned int thread_count);
+    static TaskSystem& Instance();
+
+    explicit TaskSystem(unsigned int thread_count);
+    ~TaskSystem();
+
+    TaskSystem(const TaskSystem&) = delete;
+    TaskSystem& operator=(const TaskSystem&) = delete;
+
+    // ワーカー数 + 呼び出し元スレッド
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(workers_.size()) + 1; }
+
+    // 完了を待たないタスクを投入する（ワーカーがいない場合はその場で実行）
+    void Submit(Task task);
+
+    // latch が 0 になるまでタスクを手伝いながら待つ
+    void Wait(TaskLatch& latch);
+
+    // [begin, end) を grain 以上の区間に分けて fn(first, last) を並列に呼び、全区間が終わるまで戻らない。
+    // 呼び出し元スレッドも先頭の区間を処理する。
+    template <typename Fn>
+    void ParallelFor(size_t begin, size_t end, size_t grain, Fn&& fn) {
+        if (begin >= end) {
+            return;
+        }
+        const size_t count = end - begin;
+        grain = std::max<size_t>(1, grain);
+        // 偏りをスティールでならせるよう、スレッド数の数倍に分割する
+        const size_t max_chunks = static_cast<size_t>(GetThreadCount()) * 4;
+        const size_t chunks = std::min((count + grain - 1) / grain, max_chunks);
+        if (chunks <= 1 || workers_.empty()) {
+            fn(begin, end);
+            return;
+        }
+
+        const size_t chunk_size = (count + chunks - 1) / chunks;
+        TaskLatch latch(chunks - 1);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            const size_t first = std::min(end, begin + chunk * chunk_size);
+            const size_t last = std::min(end, first + chunk_size);
+            Push([&fn, &latch, first, last]() {
+                if (first < last) {
+                    fn(first, last);
+                }
+                latch.CountDown();
+            });
+        }
+        fn(begin, std::min(end, begin + chunk_size));
+        Wait(latch);
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void Push(Task task);
+    bool TryRunOne();
+    void WorkerLoop(size_t index);
+
+    // queues_[0..workers-1] はワーカー専用、末尾は外部スレッドからの共有キュー
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> queued_tasks_{0};
+    std::atomic<size_t> steal_cursor_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+};
+
+// 依存関係付きのタスクグラフ
+// AddDependency(a, b) で「a の完了後に b」を表す。Run() は全ノードが終わるまで戻らず、何度でも再実行できる。
+class TaskGraph {
+public:
+    using NodeId = size_t;
+
+    NodeId AddTask(std::function<void()> fn);
+    void AddDependency(NodeId before, NodeId after);
+
+    void Run(TaskSystem& system = TaskSystem::Instance());
+
+private:
+    struct Node {
+        std::function<void()> fn;
+        std::vector<NodeId> successors;
+        int predecessor_count = 0;
+        std::atomic<int> pending_predecessors{0};
+    };
+
+    void Execute(TaskSystem& system, TaskLatch& latch, NodeId id);
+
+    std::deque<Node> nodes_;  // Node はムーブできないので deque に置く
+};
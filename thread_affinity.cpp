@@ -0,0 +1,279 @@
+#include "thread_affinity.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#endif
+
+namespace {
+
+#if defined(_WIN32)
+constexpr int kMaxCpuIndex = 63;                // SetThreadAffinityMask は1プロセッサグループ（64CPU）まで
+#elif defined(__linux__)
+constexpr int kMaxCpuIndex = CPU_SETSIZE - 1;
+#else
+constexpr int kMaxCpuIndex = 1023;
+#endif
+
+// ConfigureThreadPlacement で決まるバックグラウンドスレッド用のCPU（スレッド生成前に1回だけ書き込む）
+CpuList g_background_cpus;
+// 同じく FFmpeg を起動するときのCPU
+CpuList g_encoder_cpus;
+
+bool Contains(const CpuList& cpus, int cpu) {
+    return std::binary_search(cpus.begin(), cpus.end(), cpu);
+}
+
+bool Overlaps(const CpuList& a, const CpuList& b) {
+    for (int cpu : a) {
+        if (Contains(b, cpu)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool ParseCpuList(const std::string& text, CpuList& cpus, std::string& error) {
+    cpus.clear();
+    std::stringstream stream(text);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        if (token.empty()) {
+            error = "empty entry";
+            return false;
+        }
+        int first = 0;
+        int last = 0;
+        try {
+            size_t dash = token.find('-');
+            size_t parsed = 0;
+            if (dash == std::string::npos) {
+                first = last = std::stoi(token, &parsed);
+                if (parsed != token.size()) {
+                    throw std::invalid_argument(token);
+                }
+            } else {
+                first = std::stoi(token.substr(0, dash), &parsed);
+                if (parsed != dash) {
+                    throw std::invalid_argument(token);
+                }
+                std::string tail = token.substr(dash + 1);
+                last = std::stoi(tail, &parsed);
+                if (parsed != tail.size()) {
+                    throw std::invalid_argument(token);
+                }
+            }
+        } catch (const std::exception&) {
+            error = "invalid entry '" + token + "'";
+            return false;
+        }
+        if (first < 0 || last < first || last > kMaxCpuIndex) {
+            error = "CPU range '" + token + "' must be within 0-" + std::to_string(kMaxCpuIndex);
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        error = "no CPUs given";
+        return false;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return true;
+}
+
+std::string FormatCpuList(const CpuList& cpus) {
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        if (i > 0) {
+            out << ',';
+        }
+        out << cpus[i];
+        if (j > i) {
+            out << '-' << cpus[j];
+        }
+        i = j + 1;
+    }
+    return out.str();
+}
+
+bool SetCurrentThreadAffinity(const CpuList& cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+#if defined(_WIN32)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+CpuList GetCurrentThreadAffinity() {
+    CpuList cpus;
+#if defined(_WIN32)
+    // スレッド単位の取得APIがないので、スレッドが取り得るプロセスのCPU集合を返す
+    DWORD_PTR process_mask = 0;
+    DWORD_PTR system_mask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) {
+        for (int cpu = 0; cpu <= kMaxCpuIndex; ++cpu) {
+            if (process_mask & (static_cast<DWORD_PTR>(1) << cpu)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu <= kMaxCpuIndex; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+void SetCurrentThreadName(const char* name) {
+#if defined(_WIN32)
+    // SetThreadDescription は Windows 10 1607 以降のみなので動的に取得する
+    using SetThreadDescriptionFn = HRESULT(WINAPI*)(HANDLE, PCWSTR);
+    static auto set_description = reinterpret_cast<SetThreadDescriptionFn>(
+        reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")));
+    if (set_description) {
+        std::string narrow(name);
+        std::wstring wide(narrow.begin(), narrow.end());
+        set_description(GetCurrentThread(), wide.c_str());
+    }
+#elif defined(__APPLE__)
+    pthread_setname_np(name);
+#else
+    // Linux のスレッド名は終端を含めて16バイトまで
+    char truncated[16] = {};
+    std::snprintf(truncated, sizeof(truncated), "%s", name);
+    pthread_setname_np(pthread_self(), truncated);
+#endif
+}
+
+void ConfigureThreadPlacement(const ThreadPlacement& placement) {
+    // 起動時のCPU集合（taskset などで外から制限されていればそれに従う）
+    const CpuList available = GetCurrentThreadAffinity();
+
+    CpuList background = placement.background_cpus;
+    if (background.empty()) {
+        for (int cpu : available) {
+            if (!Contains(placement.render_cpus, cpu) && !Contains(placement.encoder_cpus, cpu)) {
+                background.push_back(cpu);
+            }
+        }
+        if (background.empty()) {
+            background = available;
+        }
+    }
+    // メインスレッドを固定した後に作られるスレッドがレンダー用のCPUを引き継がないよう、常に明示する
+    g_background_cpus = background;
+
+    // FFmpeg は起動したスレッド（固定済みのレンダースレッド）のCPU集合を引き継ぐので、
+    // 指定がなければ起動時のCPUからレンダー用を除いた集合で起動する
+    CpuList encoder = placement.encoder_cpus;
+    if (encoder.empty() && !placement.render_cpus.empty()) {
+        for (int cpu : available) {
+            if (!Contains(placement.render_cpus, cpu)) {
+                encoder.push_back(cpu);
+            }
+        }
+        if (encoder.empty()) {
+            encoder = available;
+        }
+    }
+    g_encoder_cpus = encoder;
+
+    SetCurrentThreadName("render");
+    if (!placement.render_cpus.empty() && !SetCurrentThreadAffinity(placement.render_cpus)) {
+        std::cerr << "Warning: Failed to pin the render thread to CPUs " << FormatCpuList(placement.render_cpus) << std::endl;
+    }
+
+    const bool configured = !placement.render_cpus.empty() || !placement.background_cpus.empty() ||
+                            !placement.encoder_cpus.empty();
+    if (!configured) {
+        return;
+    }
+    std::cout << "Thread placement:" << std::endl;
+    std::cout << "  Render thread: " << (placement.render_cpus.empty() ? "any" : FormatCpuList(placement.render_cpus)) << std::endl;
+    std::cout << "  Worker threads: " << (background.empty() ? "any" : FormatCpuList(background)) << std::endl;
+    std::cout << "  Encoder: " << (encoder.empty() ? "any" : FormatCpuList(encoder))
+              << (placement.encoder_cpus.empty() && !encoder.empty() ? " (default)" : "")
+              << std::endl;
+    if (!placement.render_cpus.empty() && !encoder.empty() && Overlaps(placement.render_cpus, encoder)) {
+        std::cerr << "Warning: The render thread shares CPUs with the encoder" << std::endl;
+    }
+}
+
+const CpuList& GetBackgroundThreadCpus() {
+    return g_background_cpus;
+}
+
+const CpuList& GetEncoderCpus() {
+    return g_encoder_cpus;
+}
+
+void EnterBackgroundThread(const char* name) {
+    SetCurrentThreadName(name);
+    if (!g_background_cpus.empty()) {
+        SetCurrentThreadAffinity(g_background_cpus);
+    }
+}
+
+ScopedThreadAffinity::ScopedThreadAffinity(const CpuList& cpus)
+    : applied_(false) {
+    if (cpus.empty()) {
+        return;
+    }
+    previous_ = GetCurrentThreadAffinity();
+    applied_ = SetCurrentThreadAffinity(cpus);
+    if (!applied_) {
+        std::cerr << "Warning: Failed to apply CPU set " << FormatCpuList(cpus) << std::endl;
+    }
+}
+
+ScopedThreadAffinity::~ScopedThreadAffinity() {
+    if (applied_ && !previous_.empty()) {
+        SetCurrentThreadAffinity(previous_);
+    }
+}
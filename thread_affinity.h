@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#pragma execution_character_set("utf-8")
+#endif
+
+// CPU番号のリスト（昇順・重複なし）
+using CpuList = std::vector<int>;
+
+// "0-3,8,10-11" 形式のCPUリストを解析する。失敗時は error に理由を入れて false を返す。
+bool ParseCpuList(const std::string& text, CpuList& cpus, std::string& error);
+std::string FormatCpuList(const CpuList& cpus);
+
+// 呼び出し元スレッドを cpus に固定する（空なら何もしない）。非対応プラットフォームでは false。
+bool SetCurrentThreadAffinity(const CpuList& cpus);
+// 呼び出し元スレッドの現在のCPU集合（取得できない場合は空）
+CpuList GetCurrentThreadAffinity();
+
+// プロファイラー向けのスレッド名（Linux では15文字まで）
+void SetCurrentThreadName(const char* name);
+
+// スレッド配置（レンダースレッド / バックグラウンドスレッド / エンコーダー）
+// ConfigureThreadPlacement はスレッドを作る前にメインスレッドから1回だけ呼ぶ。
+// レンダースレッドと同じコアをエンコーダーが使わないように分割するのが目的。
+struct ThreadPlacement {
+    CpuList render_cpus;       // メイン（描画・リードバック）スレッド
+    CpuList background_cpus;   // タスクシステムのワーカーとMIDIデコーダー（空 = 残りのCPU）
+    CpuList encoder_cpus;      // FFmpeg（空 = レンダー用を除いたCPU。レンダーも未指定なら制限なし）
+};
+
+// render_cpus / encoder_cpus を除いた残りをバックグラウンドに割り当て、メインスレッドを固定する
+void ConfigureThreadPlacement(const ThreadPlacement& placement);
+
+// ConfigureThreadPlacement で決まったバックグラウンド用のCPU（未設定なら空）
+const CpuList& GetBackgroundThreadCpus();
+// ConfigureThreadPlacement で決まったFFmpeg用のCPU（制限しない場合は空）
+const CpuList& GetEncoderCpus();
+
+// バックグラウンドスレッドの開始時に呼ぶ（名前を付け、バックグラウンド用のCPUに固定する）
+void EnterBackgroundThread(const char* name);
+
+// スコープ内だけ呼び出し元スレッドを cpus に固定する。
+// 子プロセスは起動したスレッドのCPU集合を引き継ぐので、popen の前後で FFmpeg の配置に使う。
+class ScopedThreadAffinity {
+public:
+    explicit ScopedThreadAffinity(const CpuList& cpus);
+    ~ScopedThreadAffinity();
+
+    ScopedThreadAffinity(const ScopedThreadAffinity&) = delete;
+    ScopedThreadAffinity& operator=(const ScopedThreadAffinity&) = delete;
+
+private:
+    CpuList previous_;
+    bool applied_;
+};
@@ -325,6 +325,7 @@ void VulkanRenderer::CleanupVulkan() {
     vkDeviceWaitIdle(device_);
 
     DestroyFontResources();
+    DestroyBackgroundResources();
     DestroyPipelines();
     ReleaseFramebufferResources();
 
@@ -459,6 +460,11 @@ void VulkanRenderer::EnsureFramebufferResources(int width, int height) {
     render_pass_info.pSubpasses = &subpass;
     VK_CHECK(vkCreateRenderPass(device_, &render_pass_info, nullptr, &render_pass_));
 
+    // Compatible pass that draws over a background already copied into the color image
+    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    color_attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    VK_CHECK(vkCreateRenderPass(device_, &render_pass_info, nullptr, &render_pass_load_));
+
     VkFramebufferCreateInfo framebuffer_info{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
     framebuffer_info.renderPass = render_pass_;
     framebuffer_info.attachmentCount = 1;
@@ -489,6 +495,10 @@ void VulkanRenderer::ReleaseFramebufferResources() {
         vkDestroyRenderPass(device_, render_pass_, nullptr);
         render_pass_ = VK_NULL_HANDLE;
     }
+    if (render_pass_load_ != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(device_, render_pass_load_, nullptr);
+        render_pass_load_ = VK_NULL_HANDLE;
+    }
     if (color_image_view_ != VK_NULL_HANDLE) {
         vkDestroyImageView(device_, color_image_view_, nullptr);
         color_image_view_ = VK_NULL_HANDLE;
@@ -876,11 +886,99 @@ void VulkanRenderer::DestroyFontResources() {
     font_uploaded_ = false;
 }
 
+void VulkanRenderer::UploadBackgroundImage(const DecodedImage& image) {
+    DestroyBackgroundResources();
+
+    VulkanBuffer staging;
+    VkDeviceSize image_size = static_cast<VkDeviceSize>(image.pixels.size());
+    EnsureBufferCapacity(staging, image_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+    void* mapped = nullptr;
+    VK_CHECK(vkMapMemory(device_, staging.memory, 0, image_size, 0, &mapped));
+    std::memcpy(mapped, image.pixels.data(), static_cast<std::size_t>(image_size));
+    vkUnmapMemory(device_, staging.memory);
+
+    VkImageCreateInfo image_info{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.extent.width = static_cast<uint32_t>(image.width);
+    image_info.extent.height = static_cast<uint32_t>(image.height);
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.format = color_format_;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    VK_CHECK(vkCreateImage(device_, &image_info, nullptr, &background_image_));
+
+    VkMemoryRequirements mem_req;
+    vkGetImageMemoryRequirements(device_, background_image_, &mem_req);
+
+    VkMemoryAllocateInfo alloc_info{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    alloc_info.allocationSize = mem_req.size;
+    alloc_info.memoryTypeIndex = FindMemoryType(mem_req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    VK_CHECK(vkAllocateMemory(device_, &alloc_info, nullptr, &background_image_memory_));
+    VK_CHECK(vkBindImageMemory(device_, background_image_, background_image_memory_, 0));
+
+    TransitionImageLayout(background_image_, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkResetCommandBuffer(command_buffer_, 0);
+    VK_CHECK(vkBeginCommandBuffer(command_buffer_, &begin_info));
+
+    VkBufferImageCopy copy{};
+    copy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copy.imageSubresource.layerCount = 1;
+    copy.imageExtent = {static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height), 1};
+    vkCmdCopyBufferToImage(command_buffer_, staging.buffer, background_image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+    // The image is only ever used as a copy source from here on
+    VkImageMemoryBarrier to_source{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    to_source.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    to_source.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    to_source.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_source.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_source.image = background_image_;
+    to_source.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    to_source.subresourceRange.levelCount = 1;
+    to_source.subresourceRange.layerCount = 1;
+    to_source.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_source.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &to_source);
+    VK_CHECK(vkEndCommandBuffer(command_buffer_));
+
+    SubmitAndWait();
+
+    vkDestroyBuffer(device_, staging.buffer, nullptr);
+    vkFreeMemory(device_, staging.memory, nullptr);
+}
+
+void VulkanRenderer::DestroyBackgroundResources() {
+    if (device_ == VK_NULL_HANDLE) {
+        return;
+    }
+    if (background_image_ != VK_NULL_HANDLE) {
+        vkDestroyImage(device_, background_image_, nullptr);
+        background_image_ = VK_NULL_HANDLE;
+    }
+    if (background_image_memory_ != VK_NULL_HANDLE) {
+        vkFreeMemory(device_, background_image_memory_, nullptr);
+        background_image_memory_ = VK_NULL_HANDLE;
+    }
+    background_key_.clear();
+}
+
 void VulkanRenderer::ResetBatches() {
     shape_commands_.clear();
     text_commands_.clear();
     shape_vertices_.clear();
     text_vertices_.clear();
+    background_blit_pending_ = false;
     frame_dirty_ = false;
 }
 
@@ -915,10 +1013,29 @@ void VulkanRenderer::ClearWithRadialGradient(const Color& center_color, const Co
 }
 
 void VulkanRenderer::ClearWithImage(const std::string& image_path, float opacity, int scale_mode) {
-    (void)image_path;
-    (void)opacity;
-    (void)scale_mode;
-    Clear(Color(0.0f, 0.0f, 0.0f, 1.0f));
+    std::lock_guard<std::mutex> lock(render_mutex_);
+    ResetBatches();
+    clear_color_ = Color(0.0f, 0.0f, 0.0f, 1.0f);
+    has_pending_clear_ = true;
+    frame_dirty_ = true;
+
+    // Stays black until the worker thread has decoded the image
+    BackgroundImageCache& cache = BackgroundImageCache::Instance();
+    cache.Request(image_path);
+    std::shared_ptr<const DecodedImage> decoded = cache.TryGet(image_path);
+    if (!decoded || framebuffer_width_ <= 0 || framebuffer_height_ <= 0) {
+        return;
+    }
+
+    // Compose and upload only when the image, its placement or the framebuffer size changes
+    std::string key = image_path + "|" + std::to_string(opacity) + "|" + std::to_string(scale_mode) + "|" +
+                      std::to_string(framebuffer_width_) + "x" + std::to_string(framebuffer_height_);
+    if (background_image_ == VK_NULL_HANDLE || background_key_ != key) {
+        UploadBackgroundImage(BackgroundImageCache::Compose(*decoded, framebuffer_width_, framebuffer_height_,
+                                                            opacity, static_cast<BackgroundScaleMode>(scale_mode)));
+        background_key_ = key;
+    }
+    background_blit_pending_ = true;
 }
 
 void VulkanRenderer::PushShapeCommand(const ShapeCommand& command) {
@@ -1266,6 +1383,7 @@ void VulkanRenderer::Flush() {
 
     frame_dirty_ = false;
     has_pending_clear_ = false;
+    background_blit_pending_ = false;
 }
 
 bool VulkanRenderer::HasRenderableContent() const {
@@ -1277,6 +1395,45 @@ void VulkanRenderer::RecordCommandBuffer(VkDeviceSize readback_size) {
     VkCommandBufferBeginInfo begin_info{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
     VK_CHECK(vkBeginCommandBuffer(command_buffer_, &begin_info));
 
+    const bool blit_background = background_blit_pending_ && background_image_ != VK_NULL_HANDLE;
+    if (blit_background) {
+        // Copy the cached background into the color image instead of clearing it
+        VkImageMemoryBarrier to_dst{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        to_dst.oldLayout = color_image_layout_;
+        to_dst.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        to_dst.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_dst.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_dst.image = color_image_;
+        to_dst.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        to_dst.subresourceRange.levelCount = 1;
+        to_dst.subresourceRange.layerCount = 1;
+        to_dst.srcAccessMask = (color_image_layout_ == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) ? VK_ACCESS_TRANSFER_READ_BIT : 0;
+        to_dst.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &to_dst);
+
+        VkImageCopy region{};
+        region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.srcSubresource.layerCount = 1;
+        region.dstSubresource = region.srcSubresource;
+        region.extent = {static_cast<uint32_t>(framebuffer_width_), static_cast<uint32_t>(framebuffer_height_), 1};
+        vkCmdCopyImage(command_buffer_, background_image_, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                       color_image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+        VkImageMemoryBarrier to_color{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+        to_color.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        to_color.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        to_color.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_color.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_color.image = color_image_;
+        to_color.subresourceRange = to_dst.subresourceRange;
+        to_color.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        to_color.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        vkCmdPipelineBarrier(command_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &to_color);
+        color_image_layout_ = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    }
+
     if (color_image_layout_ != VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
         VkImageMemoryBarrier to_color{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
         to_color.oldLayout = color_image_layout_;
@@ -1376,7 +1533,7 @@ void VulkanRenderer::RecordCommandBuffer(VkDeviceSize readback_size) {
     clear_value.color.float32[3] = clear_color_.a;
 
     VkRenderPassBeginInfo render_begin{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
-    render_begin.renderPass = render_pass_;
+    render_begin.renderPass = blit_background ? render_pass_load_ : render_pass_;
     render_begin.framebuffer = framebuffer_;
     render_begin.renderArea.extent.width = static_cast<uint32_t>(framebuffer_width_);
     render_begin.renderArea.extent.height = static_cast<uint32_t>(framebuffer_height_);
@@ -1510,6 +1667,19 @@ std::vector<std::uint8_t> VulkanRenderer::ReadFramebufferPBO(int width, int heig
     return ReadFramebuffer(width, height);
 }
 
+bool VulkanRenderer::ReadFramebufferInto(int width, int height, std::uint8_t* destination) {
+    std::lock_guard<std::mutex> lock(render_mutex_);
+    if (width != framebuffer_width_ || height != framebuffer_height_ || !offscreen_initialized_) {
+        return false;
+    }
+    FlushIfNeeded();
+    return CopyFrame(readback_cache_, width, height, destination);
+}
+
+bool VulkanRenderer::ReadFramebufferPBOInto(int width, int height, std::uint8_t* destination) {
+    return ReadFramebufferInto(width, height, destination);
+}
+
 void VulkanRenderer::StartAsyncReadback(int width, int height) {
     std::lock_guard<std::mutex> lock(render_mutex_);
     if (width != framebuffer_width_ || height != framebuffer_height_) {
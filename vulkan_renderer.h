@@ -1,6 +1,7 @@
 #pragma once
 
 #include "renderer.h"
+#include "background_image_cache.h"
 
 #include <vulkan/vulkan.h>
 
@@ -60,6 +61,8 @@ public:
 
     std::vector<std::uint8_t> ReadFramebuffer(int width, int height) override;
     std::vector<std::uint8_t> ReadFramebufferPBO(int width, int height) override;
+    bool ReadFramebufferInto(int width, int height, std::uint8_t* destination) override;
+    bool ReadFramebufferPBOInto(int width, int height, std::uint8_t* destination) override;
     void StartAsyncReadback(int width, int height) override;
     std::vector<std::uint8_t> GetAsyncReadbackResult(int width, int height) override;
 
@@ -158,6 +161,9 @@ private:
     void EnsureFontResources(float font_size);
     void DestroyFontResources();
 
+    void UploadBackgroundImage(const DecodedImage& image);
+    void DestroyBackgroundResources();
+
     void FlushIfNeeded();
     void Flush();
     void RecordCommandBuffer(VkDeviceSize readback_size);
@@ -202,6 +208,7 @@ private:
     VkDeviceMemory color_image_memory_ = VK_NULL_HANDLE;
     VkImageView color_image_view_ = VK_NULL_HANDLE;
     VkRenderPass render_pass_ = VK_NULL_HANDLE;
+    VkRenderPass render_pass_load_ = VK_NULL_HANDLE;  // Same as render_pass_ but keeps the copied background
     VkFramebuffer framebuffer_ = VK_NULL_HANDLE;
     VkFormat color_format_ = VK_FORMAT_R8G8B8A8_UNORM;
     VkImageLayout color_image_layout_ = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -219,6 +226,12 @@ private:
     VkSampler font_sampler_ = VK_NULL_HANDLE;
     bool font_uploaded_ = false;
 
+    // Background image composed at framebuffer size, uploaded once and copied into color_image_ per frame
+    VkImage background_image_ = VK_NULL_HANDLE;
+    VkDeviceMemory background_image_memory_ = VK_NULL_HANDLE;
+    std::string background_key_;
+    bool background_blit_pending_ = false;
+
     // CPU-side state
     int window_width_ = 0;
     int window_height_ = 0;
@@ -27,7 +27,7 @@ target("MPP Video Renderer")
     add_rules("utils.bin2c", {extensions = {".ico", ".png"}})
 
     -- Add source files
-    add_files("main.cpp", "opengl_renderer.cpp", "directx12_renderer.cpp", "vulkan_renderer.cpp", "piano_keyboard.cpp", "midi_video_output.cpp", "resources/window_icon_loader.cpp")
+    add_files("main.cpp", "opengl_renderer.cpp", "directx12_renderer.cpp", "vulkan_renderer.cpp", "piano_keyboard.cpp", "midi_video_output.cpp", "midi_event_decoder.cpp", "midi_audio_synth.cpp", "background_image_cache.cpp", "task_system.cpp", "thread_affinity.cpp", "frame_buffer_pool.cpp", "audio_pipe.cpp", "distributed_render.cpp", "live_midi_input.cpp", "resources/window_icon_loader.cpp")
     add_files("resources/icon.png")
 
     -- Add header files
@@ -289,8 +289,11 @@ target("MPP Video Renderer Launcher")
     set_default(true)
     add_rules("utils.bin2c", {extensions = {".ico", ".png"}})
 
-    add_files("launcher/launcher_main.cpp", "resources/window_icon_loader.cpp", "resources/icon.png")
-    add_includedirs("launcher")
+    add_files("launcher/launcher_main.cpp", "launcher/midi_analysis.cpp", "resources/window_icon_loader.cpp", "resources/icon.png")
+    -- MIDI analysis reuses the renderer's parser and note statistics
+    add_files("midi_event_decoder.cpp")
+    add_includedirs("launcher", ".", "midi-parser")
+    add_deps("midi_parser")
     if is_plat("windows") then
         add_files("resources/icon.ico")
     end